@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
@@ -38,11 +40,24 @@ void DspInterface::EnableStretching(bool enable) {
     perform_time_stretching = enable;
 }
 
+void DspInterface::EnableAdaptiveBuffering(bool enable) {
+    adaptive_buffering = enable;
+}
+
+double DspInterface::GetOutputLatency() const {
+    return output_latency;
+}
+
+u64 DspInterface::GetAndResetUnderrunCount() {
+    return underrun_count.exchange(0);
+}
+
 void DspInterface::OutputFrame(StereoFrame16& frame) {
     if (!sink)
         return;
 
     fifo.Push(frame.data(), frame.size());
+    frames_pushed += frame.size();
 
     if (Core::System::GetInstance().VideoDumper().IsDumping()) {
         Core::System::GetInstance().VideoDumper().AddAudioFrame(frame);
@@ -54,15 +69,93 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
         return;
 
     fifo.Push(&sample, 1);
+    ++frames_pushed;
 
     if (Core::System::GetInstance().VideoDumper().IsDumping()) {
         Core::System::GetInstance().VideoDumper().AddAudioSample(sample);
     }
 }
 
+bool DspInterface::UpdateAdaptiveBuffering(std::size_t num_frames) {
+    // Number of consecutive underrunning callbacks before the stretcher is engaged, and number of
+    // consecutive filled callbacks before it is released again.
+    constexpr u32 SustainedUnderrunCallbacks = 8;
+    constexpr u32 RecoveredCallbacks = 64;
+    // Smoothing factor of the callback period and jitter estimates
+    constexpr double EstimateGain = 1.0 / 16.0;
+    // Multiple of the jitter we keep buffered on top of a callback's and a burst's worth of audio
+    constexpr double JitterHeadroom = 4.0;
+    // Rate at which the largest producer burst seen decays, per callback
+    constexpr double BurstDecay = 1.0 / 256.0;
+    // Number of consecutive callbacks the backlog must stay in excess before it is trimmed
+    constexpr u32 SustainedExcessCallbacks = 32;
+
+    const auto now = Clock::now();
+    if (last_callback_time != Clock::time_point{}) {
+        const double period = std::chrono::duration<double>(now - last_callback_time).count();
+        if (callback_period == 0.0) {
+            callback_period = period;
+        }
+        callback_jitter += EstimateGain * (std::abs(period - callback_period) - callback_jitter);
+        callback_period += EstimateGain * (period - callback_period);
+    }
+    last_callback_time = now;
+
+    // The DSP delivers its audio in bursts, e.g. a whole emulated frame's worth at once, so the
+    // backlog legitimately swings by up to a burst between two callbacks.
+    const double burst = static_cast<double>(frames_pushed.exchange(0));
+    producer_burst = std::max(burst, producer_burst * (1.0 - BurstDecay));
+
+    if (fifo.Size() < num_frames) {
+        consecutive_filled = 0;
+        if (++consecutive_underruns >= SustainedUnderrunCallbacks) {
+            adaptive_stretching_engaged = true;
+            consecutive_excess = 0;
+        }
+    } else {
+        consecutive_underruns = 0;
+        if (adaptive_stretching_engaged && ++consecutive_filled >= RecoveredCallbacks) {
+            adaptive_stretching_engaged = false;
+            flushing_time_stretcher = true;
+        }
+    }
+
+    if (!adaptive_stretching_engaged) {
+        // Trim the backlog when it stays well past what the bursts and observed jitter require
+        const std::size_t target_frames =
+            num_frames +
+            static_cast<std::size_t>(producer_burst +
+                                     JitterHeadroom * callback_jitter * native_sample_rate);
+        const std::size_t buffered = fifo.Size();
+        if (buffered <= 2 * target_frames) {
+            consecutive_excess = 0;
+        } else if (++consecutive_excess >= SustainedExcessCallbacks) {
+            consecutive_excess = 0;
+            std::array<s16, 2 * 256> discard;
+            std::size_t excess = buffered - target_frames;
+            while (excess > 0) {
+                const std::size_t popped =
+                    fifo.Pop(discard.data(), std::min(excess, discard.size() / 2));
+                if (popped == 0)
+                    break;
+                excess -= popped;
+            }
+        }
+    }
+
+    return adaptive_stretching_engaged && perform_time_stretching;
+}
+
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
+    const bool use_stretcher =
+        adaptive_buffering ? UpdateAdaptiveBuffering(num_frames) : perform_time_stretching.load();
+
+    // Latency seen by a frame pushed right now: everything still queued ahead of it, plus the
+    // callback buffer being filled.
+    output_latency = static_cast<double>(fifo.Size() + num_frames) / native_sample_rate;
+
     std::size_t frames_written;
-    if (perform_time_stretching) {
+    if (use_stretcher) {
         const std::vector<s16> in{fifo.Pop()};
         const std::size_t num_in{in.size() / 2};
         frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
@@ -75,6 +168,10 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
         frames_written = fifo.Pop(buffer, num_frames);
     }
 
+    if (frames_written < num_frames) {
+        ++underrun_count;
+    }
+
     if (frames_written > 0) {
         std::memcpy(&last_frame[0], buffer + 2 * (frames_written - 1), 2 * sizeof(s16));
     }
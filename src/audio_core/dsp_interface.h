@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <vector>
 #include "audio_core/audio_types.h"
@@ -98,21 +100,59 @@ public:
     Sink& GetSink();
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
+    /**
+     * Enable/Disable adaptive buffering. In this mode the amount of buffered audio follows the
+     * measured jitter of the sink callbacks, and audio stretching (if enabled) is only engaged
+     * while the output is persistently underrunning.
+     */
+    void EnableAdaptiveBuffering(bool enable);
+
+    /// Returns the most recently measured output latency, in seconds.
+    double GetOutputLatency() const;
+    /// Returns the number of sink callbacks that could not be filled since the last call.
+    u64 GetAndResetUnderrunCount();
 
 protected:
     void OutputFrame(StereoFrame16& frame);
     void OutputSample(std::array<s16, 2> sample);
 
 private:
+    using Clock = std::chrono::steady_clock;
+
     void FlushResidualStretcherAudio();
     void OutputCallback(s16* buffer, std::size_t num_frames);
+    /**
+     * Updates the burst and jitter estimates and decides whether the stretcher should be used for
+     * this callback. Excess buffered audio beyond the adaptive target is discarded.
+     * @returns true if the time stretcher should process this callback
+     */
+    bool UpdateAdaptiveBuffering(std::size_t num_frames);
 
     std::unique_ptr<Sink> sink;
     std::atomic<bool> perform_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
+    std::atomic<bool> adaptive_buffering = false;
     Common::RingBuffer<s16, 0x2000, 2> fifo;
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
+
+    // The following are only touched from the sink callback thread
+    Clock::time_point last_callback_time{};
+    /// Exponential moving averages of the callback period and its absolute deviation, in seconds
+    double callback_period = 0.0;
+    double callback_jitter = 0.0;
+    /// Largest number of frames pushed between two callbacks, decaying over time
+    double producer_burst = 0.0;
+    /// Number of consecutive callbacks that underran / were completely filled / had excess backlog
+    u32 consecutive_underruns = 0;
+    u32 consecutive_filled = 0;
+    u32 consecutive_excess = 0;
+    bool adaptive_stretching_engaged = false;
+
+    /// Number of frames pushed by the DSP since the last callback
+    std::atomic<std::size_t> frames_pushed = 0;
+    std::atomic<double> output_latency = 0.0;
+    std::atomic<u64> underrun_count = 0;
 };
 
 } // namespace AudioCore
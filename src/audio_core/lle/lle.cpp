@@ -3,14 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <teakra/teakra.h>
 #include "audio_core/lle/lle.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/swap.h"
-#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/lock.h"
@@ -141,44 +143,116 @@ struct DspLle::Impl final {
 
     const bool multithread;
     std::thread teakra_thread;
-    Common::Barrier teakra_slice_barrier{2};
     std::atomic<bool> stop_signal = false;
-    std::size_t stop_generation;
+
+    // In multithread mode the emulation thread and the Teakra thread communicate through a pair of
+    // monotonically increasing slice counters instead of a blocking barrier. The emulation thread
+    // bumps slice_request_count to hand out work, the Teakra thread publishes its progress in
+    // slice_complete_count. Neither side takes a lock on the hot path; the mutex and condition
+    // variable below are only used to park the Teakra thread when it has nothing to do.
+    std::atomic<u64> slice_request_count = 0;
+    std::atomic<u64> slice_complete_count = 0;
+    std::atomic<bool> teakra_thread_sleeping = false;
+    std::mutex teakra_thread_mutex;
+    std::condition_variable teakra_thread_cv;
 
     static constexpr u32 DspDataOffset = 0x40000;
     static constexpr u32 TeakraSlice = 20000;
 
+    /// Maximum number of pending slices the Teakra thread merges into a single Teakra::Run call.
+    static constexpr u64 MaxCoalescedSlices = 4;
+    /// Number of slices the Teakra thread may lag behind the scheduled slice event before the
+    /// emulation thread waits for it.
+    static constexpr u64 MaxSlicesInFlight = 2;
+    /// Number of polling iterations before a waiting thread starts yielding or sleeping.
+    static constexpr std::size_t SpinCount = 1000;
+
     void TeakraThread() {
+        u64 completed = slice_complete_count.load(std::memory_order_relaxed);
         while (true) {
-            teakra.Run(TeakraSlice);
-            teakra_slice_barrier.Sync();
-            if (stop_signal) {
-                if (stop_generation == teakra_slice_barrier.Generation())
+            const u64 requested = slice_request_count.load(std::memory_order_acquire);
+            if (requested == completed) {
+                if (stop_signal)
                     break;
+                WaitForSliceRequest(completed);
+                continue;
             }
+
+            // Coalesce every slice that was requested while we were busy into one run, so that a
+            // burst of requests only costs a single hand-off.
+            const u64 pending = std::min(requested - completed, MaxCoalescedSlices);
+            teakra.Run(static_cast<unsigned>(TeakraSlice * pending));
+            completed += pending;
+            slice_complete_count.store(completed, std::memory_order_release);
         }
         stop_signal = false;
     }
 
+    void WaitForSliceRequest(u64 completed) {
+        for (std::size_t i = 0; i < SpinCount; ++i) {
+            if (slice_request_count.load(std::memory_order_acquire) != completed || stop_signal)
+                return;
+        }
+
+        std::unique_lock lock{teakra_thread_mutex};
+        teakra_thread_sleeping = true;
+        teakra_thread_cv.wait(lock, [this, completed] {
+            return slice_request_count != completed || stop_signal;
+        });
+        teakra_thread_sleeping = false;
+    }
+
+    void WakeTeakraThread() {
+        if (teakra_thread_sleeping) {
+            std::lock_guard lock{teakra_thread_mutex};
+            teakra_thread_cv.notify_one();
+        }
+    }
+
+    /// Blocks until no more than max_in_flight requested slices are still pending.
+    void WaitForTeakraThread(u64 max_in_flight) const {
+        const u64 requested = slice_request_count.load(std::memory_order_relaxed);
+        if (requested <= max_in_flight)
+            return;
+        const u64 target = requested - max_in_flight;
+        std::size_t spin = 0;
+        while (slice_complete_count.load(std::memory_order_acquire) < target) {
+            if (++spin > SpinCount)
+                std::this_thread::yield();
+        }
+    }
+
     void StopTeakraThread() {
         if (teakra_thread.joinable()) {
-            stop_generation = teakra_slice_barrier.Generation() + 1;
             stop_signal = true;
-            teakra_slice_barrier.Sync();
+            WakeTeakraThread();
             teakra_thread.join();
         }
     }
 
+    void RequestTeakraSlice() {
+        ++slice_request_count;
+        WakeTeakraThread();
+    }
+
     void RunTeakraSlice() {
         if (multithread) {
-            teakra_slice_barrier.Sync();
+            RequestTeakraSlice();
+            WaitForTeakraThread(1);
         } else {
             teakra.Run(TeakraSlice);
         }
     }
 
     void TeakraSliceEvent(u64 late) {
-        RunTeakraSlice();
+        if (multithread) {
+            // The scheduled slice doesn't need to observe the DSP state, so let the Teakra thread
+            // fall behind by a few slices instead of handing off synchronously every time.
+            RequestTeakraSlice();
+            WaitForTeakraThread(MaxSlicesInFlight);
+        } else {
+            teakra.Run(TeakraSlice);
+        }
         u64 next = TeakraSlice * 2; // DSP runs at clock rate half of the CPU rate
         if (next < late)
             next = 0;
@@ -2,12 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <string>
 #include <thread>
+#include <vector>
+#include <fmt/format.h>
 
 // This needs to be included before getopt.h because the latter #defines symbols used by it
 #include "common/microprofile.h"
@@ -38,13 +43,18 @@
 #include "core/frontend/framebuffer_layout.h"
 #include "core/frontend/scope_acquire_context.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/kernel/call_profiler.h"
+#include "core/hle/kernel/kernel.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/cfg/cfg.h"
 #include "core/loader/loader.h"
+#include "core/loader/smdh.h"
 #include "core/movie.h"
 #include "core/settings.h"
+#include "core/title_scanner.h"
 #include "network/network.h"
 #include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
 
 #undef _UNICODE
 #include <getopt.h>
@@ -69,12 +79,56 @@ static void PrintHelp(const char* argv0) {
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
                  "-d, --dump-video=[file]    Dumps audio and video to the given video file\n"
+                 "-l, --list-titles=DIR      Lists the titles found in DIR and exits\n"
+                 "-c, --call-stats=FILE      Writes the SVC and service call counters to FILE on\n"
+                 "                           exit, as CSV if it ends with .csv and as JSON\n"
+                 "                           otherwise\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
                  "-x, --fullscreen-display-index     Default: 0\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
 }
 
+static void CollectTitleFiles(const std::string& dir_path, std::vector<std::string>& files) {
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, dir_path,
+        [&files](u64* /*num_entries_out*/, const std::string& directory,
+                 const std::string& virtual_name) {
+            const std::string physical_name = directory + DIR_SEP + virtual_name;
+            if (FileUtil::IsDirectory(physical_name)) {
+                CollectTitleFiles(physical_name, files);
+            } else if (const std::size_t dot = virtual_name.rfind('.');
+                       dot != std::string::npos &&
+                       Loader::GuessFromExtension(virtual_name.substr(dot)) !=
+                           Loader::FileType::Unknown) {
+                files.push_back(physical_name);
+            }
+            return true;
+        });
+}
+
+static void ListTitles(const std::string& dir_path) {
+    std::vector<std::string> files;
+    CollectTitleFiles(dir_path, files);
+
+    for (const Core::ScannedTitle& title : Core::TitleScanner::GetInstance().Scan(files)) {
+        if (!title.executable)
+            continue;
+
+        std::string name;
+        if (Loader::IsValidSMDH(title.smdh)) {
+            Loader::SMDH smdh;
+            std::memcpy(&smdh, title.smdh.data(), sizeof(Loader::SMDH));
+            const auto& short_title = smdh.GetShortTitle(Loader::SMDH::TitleLanguage::English);
+            auto title_end = std::find(short_title.begin(), short_title.end(), u'\0');
+            name = Common::UTF16ToUTF8(std::u16string{short_title.begin(), title_end});
+        }
+
+        std::cout << fmt::format("{:016X}  {:<6}  {}  {}\n", title.program_id,
+                                 Loader::GetFileTypeString(title.file_type), name, title.path);
+    }
+}
+
 static void PrintVersion() {
     std::cout << "Citra Valentin " << Version::major << "." << Version::minor << "."
               << Version::patch << std::endl;
@@ -197,6 +251,7 @@ int main(int argc, char** argv) {
     std::string movie_record;
     std::string movie_play;
     std::string dump_video;
+    std::string call_stats_path;
 
     InitializeLogging();
 
@@ -227,6 +282,8 @@ int main(int argc, char** argv) {
         {"movie-record", required_argument, 0, 'r'},
         {"movie-play", required_argument, 0, 'p'},
         {"dump-video", required_argument, 0, 'd'},
+        {"list-titles", required_argument, 0, 'l'},
+        {"call-stats", required_argument, 0, 'c'},
         {"fullscreen", no_argument, 0, 'f'},
         {"fullscreen-display-index", required_argument, 0, 'x'},
         {"help", no_argument, 0, 'h'},
@@ -235,7 +292,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:x:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:m:r:p:l:c:x:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -301,6 +358,12 @@ int main(int argc, char** argv) {
             case 'd':
                 dump_video = optarg;
                 break;
+            case 'l':
+                ListTitles(std::string(optarg));
+                return 0;
+            case 'c':
+                call_stats_path = optarg;
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -362,7 +425,8 @@ int main(int argc, char** argv) {
 
     std::unique_ptr<EmuWindow_SDL2> emu_window{
         std::make_unique<EmuWindow_SDL2>(fullscreen, fullscreen_display_index)};
-    Frontend::ScopeAcquireContext scope(*emu_window);
+    std::optional<Frontend::ScopeAcquireContext> scope;
+    scope.emplace(*emu_window);
     Core::System& system = Core::System::GetInstance();
 
     const Core::System::ResultStatus load_result = system.Load(*emu_window, filepath);
@@ -426,9 +490,14 @@ int main(int argc, char** argv) {
         system.VideoDumper().StartDumping(dump_video, "webm", layout);
     }
 
+    // With asynchronous GPU emulation, the GPU thread takes over the context
+    if (VideoCore::g_gpu_thread) {
+        scope.reset();
+    }
+
     std::thread render_thread([&emu_window] { emu_window->Present(); });
     std::atomic_bool stop_run;
-    Core::System::GetInstance().Renderer().Rasterizer()->LoadDiskResources(
+    VideoCore::LoadDiskResources(
         stop_run, [](VideoCore::LoadCallbackStage stage, std::size_t value, std::size_t total) {
             LOG_DEBUG(Frontend, "Loading stage {} progress {} {}", static_cast<u32>(stage), value,
                       total);
@@ -444,6 +513,10 @@ int main(int argc, char** argv) {
         system.VideoDumper().StopDumping();
     }
 
+    if (!call_stats_path.empty()) {
+        system.Kernel().GetCallProfiler().Dump(call_stats_path);
+    }
+
     system.Shutdown();
 
     detached_tasks.WaitForAllTasks();
@@ -91,6 +91,16 @@ udp_pad_index=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether to emulate the SysCore (Core1), and Core2 and Core3 with is_new_3ds, in addition to the
+# AppCore (Core0). Threads of cores that aren't emulated run in the AppCore.
+# 0 (default): AppCore only, 1: All cores
+use_multi_core =
+
+# Whether to skip ahead to the next event when a thread spins waiting for it, by yielding with
+# svcSleepThread(0) or executing WFE/WFI/YIELD, instead of emulating the loop
+# 0 (default): Emulate the loops, 1: Skip the loops
+skip_idle_loops =
+
 [Renderer]
 # Whether to use software or hardware rendering.
 # 0: Software, 1 (default): Hardware
@@ -108,15 +118,28 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to emulate the GPU on a thread of its own, in parallel with the CPU
+# 0 (default): Off, 1: On (faster, but the timing of GPU interrupts isn't deterministic anymore)
+use_asynchronous_gpu_emulation =
+
 # Reduce stuttering by storing and loading generated shaders to disk
 # 0: Off, 1 (default. On)
 use_disk_shader_cache =
 
+# Whether to build new shaders in the background, drawing with a generic shader in the meantime
+# 0: Off, 1 (default): On
+async_shader_compilation =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
 resolution_factor =
 
+# Memory in MiB that the cached textures and framebuffers should fit in, the least recently used
+# ones being dropped when exceeding it
+# 0: Unlimited, 1024 (default)
+texture_memory_budget =
+
 # Turns on the frame limiter, which will limit frames output to the target game speed
 # 0: Off, 1: On (default)
 use_frame_limit =
@@ -206,6 +229,12 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# Whether or not to size the audio buffer dynamically based on the measured output jitter.
+# When enabled, audio stretching is only engaged after sustained underruns, which keeps the
+# output latency low when emulation runs at full speed.
+# 0 (default): No, 1: Yes
+enable_adaptive_audio_buffering =
+
 # Which audio device to use.
 # auto (default): Auto-select
 output_device =
@@ -226,6 +255,11 @@ mic_input_type = 0
 # 1 (default): Yes, 0: No
 use_virtual_sd =
 
+# Whether to keep decrypted, compressed copies of loaded titles' code and RomFS in the cache
+# directory, which speeds up later boots of the same title.
+# 0 (default): No, 1: Yes
+use_title_image_cache =
+
 [System]
 # The system model that Citra will try to emulate
 # 0: Old 3DS (default), 1: New 3DS
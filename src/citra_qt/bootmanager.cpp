@@ -13,6 +13,7 @@
 #include <QOpenGLWindow>
 #include <QScreen>
 #include <QWindow>
+#include <optional>
 #include <fmt/format.h>
 #include "citra_qt/bootmanager.h"
 #include "citra_qt/main.h"
@@ -43,9 +44,13 @@ static GMainWindow* GetMainWindow() {
 
 void EmuThread::run() {
     MicroProfileOnThreadCreate("EmuThread");
-    Frontend::ScopeAcquireContext scope(core_context);
+    // With asynchronous GPU emulation, the GPU thread takes over the context instead
+    std::optional<Frontend::ScopeAcquireContext> scope;
+    if (!VideoCore::g_gpu_thread) {
+        scope.emplace(core_context);
+    }
 
-    Core::System::GetInstance().Renderer().Rasterizer()->LoadDiskResources(
+    VideoCore::LoadDiskResources(
         stop_run, [this](VideoCore::LoadCallbackStage stage, std::size_t value, std::size_t total) {
             LOG_DEBUG(Frontend, "Loading stage {} progress {} {}", static_cast<u32>(stage), value,
                       total);
@@ -8,11 +8,17 @@
 void Config::ReadCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
     Settings::values.use_cpu_jit = ReadSetting(QStringLiteral("use_cpu_jit"), true).toBool();
+    Settings::values.use_multi_core =
+        ReadSetting(QStringLiteral("use_multi_core"), false).toBool();
+    Settings::values.skip_idle_loops =
+        ReadSetting(QStringLiteral("skip_idle_loops"), false).toBool();
     qt_config->endGroup();
 }
 
 void Config::SaveCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
     WriteSetting(QStringLiteral("use_cpu_jit"), Settings::values.use_cpu_jit, true);
+    WriteSetting(QStringLiteral("use_multi_core"), Settings::values.use_multi_core, false);
+    WriteSetting(QStringLiteral("skip_idle_loops"), Settings::values.skip_idle_loops, false);
     qt_config->endGroup();
 }
@@ -8,11 +8,15 @@
 void Config::ReadDataStorageValues() {
     qt_config->beginGroup(QStringLiteral("Data Storage"));
     Settings::values.use_virtual_sd = ReadSetting(QStringLiteral("use_virtual_sd"), true).toBool();
+    Settings::values.use_title_image_cache =
+        ReadSetting(QStringLiteral("use_title_image_cache"), false).toBool();
     qt_config->endGroup();
 }
 
 void Config::SaveDataStorageValues() {
     qt_config->beginGroup(QStringLiteral("Data Storage"));
     WriteSetting(QStringLiteral("use_virtual_sd"), Settings::values.use_virtual_sd, true);
+    WriteSetting(QStringLiteral("use_title_image_cache"), Settings::values.use_title_image_cache,
+                 false);
     qt_config->endGroup();
 }
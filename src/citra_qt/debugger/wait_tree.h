@@ -144,12 +144,12 @@ private:
 class WaitTreeThreadList : public WaitTreeExpandableItem {
     Q_OBJECT
 public:
-    explicit WaitTreeThreadList(const std::vector<std::shared_ptr<Kernel::Thread>>& list);
+    explicit WaitTreeThreadList(std::vector<std::shared_ptr<Kernel::Thread>> list);
     QString GetText() const override;
     std::vector<std::unique_ptr<WaitTreeItem>> GetChildren() const override;
 
 private:
-    const std::vector<std::shared_ptr<Kernel::Thread>>& thread_list;
+    std::vector<std::shared_ptr<Kernel::Thread>> thread_list;
 };
 
 class WaitTreeModel : public QAbstractItemModel {
@@ -14,9 +14,9 @@
 #include "citra_qt/uisettings.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
-#include "core/hle/service/am/am.h"
-#include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
+#include "core/loader/smdh.h"
+#include "core/title_scanner.h"
 
 namespace {
 bool HasSupportedFileExtension(const std::string& file_name) {
@@ -29,11 +29,11 @@ GameListWorker::GameListWorker(QVector<UISettings::GameDir>& game_dirs) : game_d
 
 GameListWorker::~GameListWorker() = default;
 
-void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
-                                             GameListDir* parent_dir) {
-    const auto callback = [this, recursion, parent_dir](u64* num_entries_out,
-                                                        const std::string& directory,
-                                                        const std::string& virtual_name) -> bool {
+void GameListWorker::CollectFiles(const std::string& dir_path, unsigned int recursion,
+                                  std::vector<std::string>& files) {
+    const auto callback = [this, recursion, &files](u64* num_entries_out,
+                                                    const std::string& directory,
+                                                    const std::string& virtual_name) -> bool {
         if (stop_processing) {
             // Breaks the callback loop.
             return false;
@@ -42,70 +42,52 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
         const std::string physical_name = directory + DIR_SEP + virtual_name;
         const bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader)
-                return true;
-
-            bool executable = false;
-            loader->IsExecutable(executable);
-            if (!executable) {
-                return true;
-            }
-
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh = [program_id, &loader]() -> std::vector<u8> {
-                std::vector<u8> original_smdh;
-                loader->ReadIcon(original_smdh);
-
-                if (program_id < 0x0004000000000000 || program_id > 0x00040000FFFFFFFF)
-                    return original_smdh;
-
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id + 0x0000000E00000000);
+            files.push_back(physical_name);
+        } else if (is_dir && recursion > 0) {
+            watch_list.append(QString::fromStdString(physical_name));
+            CollectFiles(physical_name, recursion - 1, files);
+        }
 
-                if (!FileUtil::Exists(update_path))
-                    return original_smdh;
+        return true;
+    };
 
-                std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(update_path);
+    FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
+}
 
-                if (!update_loader)
-                    return original_smdh;
+void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
+                                             GameListDir* parent_dir) {
+    std::vector<std::string> files;
+    CollectFiles(dir_path, recursion, files);
+    if (stop_processing)
+        return;
 
-                std::vector<u8> update_smdh;
-                update_loader->ReadIcon(update_smdh);
-                return update_smdh;
-            }();
+    // Files are scanned in parallel, and only the ones that changed since the last scan are opened
+    const std::vector<Core::ScannedTitle> titles =
+        Core::TitleScanner::GetInstance().Scan(files, &stop_processing);
 
-            if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
-                // Skip this invalid entry
-                return true;
-            }
+    for (const Core::ScannedTitle& title : titles) {
+        if (stop_processing)
+            return;
 
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                },
-                parent_dir);
+        if (!title.executable)
+            continue;
 
-        } else if (is_dir && recursion > 0) {
-            watch_list.append(QString::fromStdString(physical_name));
-            AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir);
+        if (!Loader::IsValidSMDH(title.smdh) && UISettings::values.game_list_hide_no_icon) {
+            // Skip this invalid entry
+            continue;
         }
 
-        return true;
-    };
-
-    FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
+        emit EntryReady(
+            {
+                new GameListItemPath(QString::fromStdString(title.path), title.smdh,
+                                     title.program_id, title.extdata_id),
+                new GameListItemRegion(title.smdh),
+                new GameListItem(
+                    QString::fromStdString(Loader::GetFileTypeString(title.file_type))),
+                new GameListItemSize(title.size),
+            },
+            parent_dir);
+    }
 }
 
 void GameListWorker::run() {
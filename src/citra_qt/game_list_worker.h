@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
@@ -51,6 +52,9 @@ signals:
     void Finished(QStringList watch_list);
 
 private:
+    /// Lists the files with a supported extension in a directory tree
+    void CollectFiles(const std::string& dir_path, unsigned int recursion,
+                      std::vector<std::string>& files);
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                  GameListDir* parent_dir);
 
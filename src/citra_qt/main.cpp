@@ -210,7 +210,16 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         "Time taken to emulate a 3DS frame, not counting framelimiting or v-sync.");
 
-    for (auto& label : {emu_speed_label, emu_frametime_label}) {
+    emu_audio_label = new QLabel();
+    emu_audio_label->setToolTip(
+        "Audio output latency, and number of times the audio output ran out of samples since the "
+        "last update. Underruns are heard as crackling.");
+
+    emu_idle_label = new QLabel();
+    emu_idle_label->setToolTip(
+        "Share of the emulated time skipped because the game was spinning in an idle loop.");
+
+    for (auto& label : {emu_speed_label, emu_frametime_label, emu_audio_label, emu_idle_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -982,6 +991,8 @@ void GMainWindow::ShutdownGame() {
     message_label->setVisible(false);
     emu_speed_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    emu_audio_label->setVisible(false);
+    emu_idle_label->setVisible(false);
 
     emulation_running = false;
 
@@ -1727,9 +1738,16 @@ void GMainWindow::UpdateStatusBar() {
     }
     emu_frametime_label->setText(
         QStringLiteral("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    emu_audio_label->setText(QStringLiteral("Audio: %1 ms (%2 underruns)")
+                                 .arg(results.audio_latency * 1000.0, 0, 'f', 0)
+                                 .arg(results.audio_underruns));
+    emu_idle_label->setText(
+        QStringLiteral("Idle: %1%").arg(results.idle_loop_skip * 100.0, 0, 'f', 0));
 
     emu_speed_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+    emu_audio_label->setVisible(true);
+    emu_idle_label->setVisible(Settings::values.skip_idle_loops);
 }
 
 void GMainWindow::OnCoreError(Core::System::ResultStatus result, std::string details) {
@@ -208,6 +208,8 @@ private:
     QLabel* message_label = nullptr;
     QLabel* emu_speed_label = nullptr;
     QLabel* emu_frametime_label = nullptr;
+    QLabel* emu_audio_label = nullptr;
+    QLabel* emu_idle_label = nullptr;
     QTimer status_bar_update_timer;
 
     MultiplayerState* multiplayer_state = nullptr;
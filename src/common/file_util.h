@@ -62,6 +62,9 @@ u64 GetSize(const int fd);
 // Overloaded GetSize, accepts FILE*
 u64 GetSize(FILE* f);
 
+// Returns the last modification time of filename in seconds since the epoch, or 0 on failure
+s64 GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -78,6 +81,10 @@ bool DeleteDir(const std::string& filename);
 // renames file srcFilename to destFilename, returns true on success
 bool Rename(const std::string& srcFilename, const std::string& destFilename);
 
+// atomically renames file srcFilename to destFilename, replacing destFilename if it exists,
+// returns true on success
+bool ReplaceFile(const std::string& srcFilename, const std::string& destFilename);
+
 // copies file srcFilename to destFilename, returns true on success
 bool Copy(const std::string& srcFilename, const std::string& destFilename);
 
@@ -290,6 +297,8 @@ public:
     u64 GetSize() const;
     bool Resize(u64 size);
     bool Flush();
+    // Flushes and waits for the written data to reach the storage device
+    bool Sync();
 
     // clear error state
     void Clear() {
@@ -0,0 +1,63 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Common {
+
+/**
+ * A fixed set of worker threads running submitted tasks in FIFO order. Tasks still queued when
+ * the pool is destroyed are run before the workers exit.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param num_threads Number of worker threads. 0 picks the number of host hardware threads.
+     * @param name Name given to the worker threads, for debugging purposes.
+     */
+    explicit ThreadPool(std::size_t num_threads = 0, std::string name = "ThreadPool");
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Queues a task and returns a future for its result
+    template <typename F>
+    std::future<std::invoke_result_t<F>> Submit(F&& f) {
+        using Result = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        std::future<Result> future = task->get_future();
+        Enqueue([task] { (*task)(); });
+        return future;
+    }
+
+    std::size_t NumThreads() const {
+        return threads.size();
+    }
+
+private:
+    void Enqueue(std::function<void()>&& task);
+    void WorkerThread();
+
+    std::string name;
+    std::vector<std::thread> threads;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop = false;
+};
+
+} // namespace Common
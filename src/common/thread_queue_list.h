@@ -4,159 +4,171 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
-#include <deque>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/common_types.h"
 
 namespace Common {
 
+/**
+ * Links of an object stored in a ThreadQueueList. Objects to be queued derive from this, so that
+ * the queue doesn't need to allocate and can unlink them in constant time.
+ */
+template <class T>
+struct ThreadQueueListNode {
+    T* queue_prev = nullptr;
+    T* queue_next = nullptr;
+    unsigned int queue_priority = 0;
+    bool queued = false;
+};
+
+/**
+ * Queue of objects ordered by priority level, lower levels first, and in FIFO order within a
+ * level. A bitmap of the non-empty levels lets the first object be found with a single bit scan.
+ */
 template <class T, unsigned int N>
 struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
-
-    typedef unsigned int Priority;
+    using Node = ThreadQueueListNode<T>;
+    using Priority = unsigned int;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static const Priority NUM_QUEUES = N;
+    static_assert(N <= 64, "The non-empty levels must fit in a 64-bit mask");
 
-    ThreadQueueList() {
-        first = nullptr;
+    // Only for debugging, returns priority level.
+    Priority contains(const T* object) const {
+        const Node& node = *object;
+        return node.queued ? node.queue_priority : -1;
     }
 
-    // Only for debugging, returns priority level.
-    Priority contains(const T& uid) {
-        for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
-            }
-        }
+    T* get_first() const {
+        if (nonempty_mask == 0)
+            return nullptr;
 
-        return -1;
+        return queues[LeastSignificantSetBit(nonempty_mask)].head;
     }
 
-    T get_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
-        }
+    T* pop_first() {
+        if (nonempty_mask == 0)
+            return nullptr;
 
-        return T();
+        return pop_front(LeastSignificantSetBit(nonempty_mask));
     }
 
-    T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
+    /// Pops the first object with a strictly better (lower) priority level, if there is any
+    T* pop_first_better(Priority priority) {
+        const u64 better_mask = nonempty_mask & ((u64{1} << priority) - 1);
+        if (better_mask == 0)
+            return nullptr;
 
-        return T();
+        return pop_front(LeastSignificantSetBit(better_mask));
     }
 
-    T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+    void push_front(Priority priority, T* object) {
+        Node& node = *object;
+        DEBUG_ASSERT(!node.queued);
+        Queue& queue = queues[priority];
+
+        node.queue_prev = nullptr;
+        node.queue_next = queue.head;
+        if (queue.head) {
+            static_cast<Node&>(*queue.head).queue_prev = object;
+        } else {
+            queue.tail = object;
         }
+        queue.head = object;
 
-        return T();
+        node.queue_priority = priority;
+        node.queued = true;
+        nonempty_mask |= u64{1} << priority;
     }
 
-    void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
-    }
+    void push_back(Priority priority, T* object) {
+        Node& node = *object;
+        DEBUG_ASSERT(!node.queued);
+        Queue& queue = queues[priority];
+
+        node.queue_prev = queue.tail;
+        node.queue_next = nullptr;
+        if (queue.tail) {
+            static_cast<Node&>(*queue.tail).queue_next = object;
+        } else {
+            queue.head = object;
+        }
+        queue.tail = object;
 
-    void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        node.queue_priority = priority;
+        node.queued = true;
+        nonempty_mask |= u64{1} << priority;
     }
 
-    void move(const T& thread_id, Priority old_priority, Priority new_priority) {
-        remove(old_priority, thread_id);
-        prepare(new_priority);
-        push_back(new_priority, thread_id);
+    void move(T* object, Priority old_priority, Priority new_priority) {
+        remove(old_priority, object);
+        push_back(new_priority, object);
     }
 
-    void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+    /// Unlinks an object from the queue. Does nothing if it isn't queued.
+    void remove(Priority priority, T* object) {
+        Node& node = *object;
+        if (!node.queued)
+            return;
+
+        DEBUG_ASSERT(node.queue_priority == priority);
+        Queue& queue = queues[node.queue_priority];
+
+        if (node.queue_prev) {
+            static_cast<Node&>(*node.queue_prev).queue_next = node.queue_next;
+        } else {
+            queue.head = node.queue_next;
+        }
+        if (node.queue_next) {
+            static_cast<Node&>(*node.queue_next).queue_prev = node.queue_prev;
+        } else {
+            queue.tail = node.queue_prev;
+        }
+
+        node.queue_prev = nullptr;
+        node.queue_next = nullptr;
+        node.queued = false;
+        if (queue.head == nullptr)
+            nonempty_mask &= ~(u64{1} << node.queue_priority);
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
+        Queue& queue = queues[priority];
 
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
-        }
+        if (queue.head != queue.tail)
+            push_back(priority, pop_front(priority));
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        for (Queue& queue : queues) {
+            while (queue.head)
+                remove(static_cast<Node&>(*queue.head).queue_priority, queue.head);
+        }
     }
 
     bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
-    }
-
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        return (nonempty_mask & (u64{1} << priority)) == 0;
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T* head = nullptr;
+        T* tail = nullptr;
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
-    }
-
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
-
-        cur->next_nonempty = first;
-        first = cur;
+    T* pop_front(Priority priority) {
+        T* object = queues[priority].head;
+        remove(priority, object);
+        return object;
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
+    // Bit i is set when the level i queue isn't empty.
+    u64 nonempty_mask = 0;
+    // The priority level queues of objects.
+    std::array<Queue, NUM_QUEUES> queues{};
 };
 
 } // namespace Common
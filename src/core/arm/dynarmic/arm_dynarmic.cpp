@@ -13,7 +13,9 @@
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/svc.h"
+#include "core/hle/kernel/thread.h"
 #include "core/memory.h"
 #include "core/settings.h"
 
@@ -162,11 +164,20 @@ public:
                 return;
             }
             break;
-        case Dynarmic::A32::Exception::SendEvent:
-        case Dynarmic::A32::Exception::SendEventLocal:
         case Dynarmic::A32::Exception::WaitForInterrupt:
         case Dynarmic::A32::Exception::WaitForEvent:
-        case Dynarmic::A32::Exception::Yield:
+        case Dynarmic::A32::Exception::Yield: {
+            // These hints are executed by spinlocks waiting for another thread, which can't run
+            // before the next event on this core
+            Kernel::ThreadManager& thread_manager = parent.system.Kernel().GetThreadManager();
+            if (thread_manager.GetIdleLoopDetector().OnPoll(
+                    thread_manager.GetCurrentThread(), pc, static_cast<u32>(exception))) {
+                parent.jit->HaltExecution();
+            }
+            return;
+        }
+        case Dynarmic::A32::Exception::SendEvent:
+        case Dynarmic::A32::Exception::SendEventLocal:
         case Dynarmic::A32::Exception::PreloadData:
         case Dynarmic::A32::Exception::PreloadDataWithIntentToWrite:
             return;
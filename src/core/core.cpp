@@ -22,6 +22,8 @@
 #ifdef ENABLE_FFMPEG_VIDEO_DUMPER
 #include "core/dumping/ffmpeg_backend.h"
 #endif
+#include "core/file_sys/disk_archive.h"
+#include "core/file_sys/ncch_container.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
@@ -30,6 +32,7 @@
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/service.h"
 #include "core/hle/service/sm/sm.h"
+#include "core/hw/gpu.h"
 #include "core/hw/hw.h"
 #include "core/loader/loader.h"
 #include "core/movie.h"
@@ -44,7 +47,7 @@ namespace Core {
 
 System::ResultStatus System::RunLoop(bool tight_loop) {
     status = ResultStatus::Success;
-    if (!cpu_core) {
+    if (cpu_cores.empty()) {
         return ResultStatus::ErrorNotInitialized;
     }
 
@@ -66,18 +69,26 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     // instead advance to the next event and try to yield to the next thread
     if (kernel->GetThreadManager().GetCurrentThread() == nullptr) {
         LOG_TRACE(Core_ARM11, "Idling");
-        timing->Idle();
+        // The threads may be waiting for GPU work that the GPU thread is still running, in which
+        // case wait for it rather than skipping ahead to the next event
+        if (!GPU::FinishPendingWork()) {
+            timing->Idle();
+        }
         timing->Advance();
         PrepareReschedule();
     } else {
         timing->Advance();
         if (tight_loop) {
-            cpu_core->Run();
+            running_core->Run();
         } else {
-            cpu_core->Step();
+            running_core->Step();
         }
     }
 
+    if (cpu_cores.size() > 1) {
+        RunOtherCores(tight_loop);
+    }
+
     if (GDBStub::IsServerEnabled()) {
         GDBStub::SetCpuStepFlag(false);
     }
@@ -94,6 +105,46 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     return status;
 }
 
+void System::RunOtherCores(bool tight_loop) {
+    // The cores share the kernel, memory and timing, none of which is thread-safe, so rather than
+    // running on host threads they take turns on this one, each executing the same time slice
+    for (u32 core_id = 1; core_id < cpu_cores.size(); ++core_id) {
+        kernel->SetRunningCPU(core_id);
+        running_core = cpu_cores[core_id].get();
+        timing->RestartSlice();
+
+        Kernel::ThreadManager& thread_manager = kernel->GetThreadManager();
+        if (thread_manager.IsReschedulePending() || thread_manager.GetCurrentThread() == nullptr) {
+            thread_manager.Reschedule();
+        }
+        if (thread_manager.GetCurrentThread() == nullptr) {
+            continue;
+        }
+
+        if (tight_loop) {
+            running_core->Run();
+        } else {
+            running_core->Step();
+        }
+        Reschedule();
+    }
+
+    kernel->SetRunningCPU(0);
+    running_core = cpu_cores[0].get();
+}
+
+void System::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    for (const auto& cpu : cpu_cores) {
+        cpu->InvalidateCacheRange(start_address, length);
+    }
+}
+
+void System::ClearInstructionCache() {
+    for (const auto& cpu : cpu_cores) {
+        cpu->ClearInstructionCache();
+    }
+}
+
 System::ResultStatus System::SingleStep() {
     return RunLoop(false);
 }
@@ -132,7 +183,9 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
 
     std::shared_ptr<Kernel::Process> process;
     const Loader::ResultStatus load_result{app_loader->Load(process)};
-    kernel->SetCurrentProcess(process);
+    for (u32 core_id = 0; core_id < cpu_cores.size(); ++core_id) {
+        kernel->SetCurrentProcessForCPU(process, core_id);
+    }
     if (Loader::ResultStatus::Success != load_result) {
         LOG_CRITICAL(Core, "Failed to load ROM (Error {})!", static_cast<u32>(load_result));
         System::Shutdown();
@@ -178,21 +231,36 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
 }
 
 void System::PrepareReschedule() {
-    cpu_core->PrepareReschedule();
-    reschedule_pending = true;
+    running_core->PrepareReschedule();
+    kernel->GetThreadManager().RequestReschedule();
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
-    return perf_stats->GetAndResetStats(timing->GetGlobalTimeUs());
+    PerfStats::Results results = perf_stats->GetAndResetStats(timing->GetGlobalTimeUs());
+    if (dsp_core) {
+        results.audio_latency = dsp_core->GetOutputLatency();
+        results.audio_underruns = dsp_core->GetAndResetUnderrunCount();
+    }
+
+    const u64 ticks = timing->GetTicks();
+    const u64 skipped_ticks = timing->GetSkippedIdleLoopTicks();
+    results.idle_loop_skip =
+        ticks > perf_stats_ticks
+            ? static_cast<double>(skipped_ticks - perf_stats_skipped_ticks) /
+                  (ticks - perf_stats_ticks)
+            : 0.0;
+    perf_stats_ticks = ticks;
+    perf_stats_skipped_ticks = skipped_ticks;
+    return results;
 }
 
 void System::Reschedule() {
-    if (!reschedule_pending) {
+    Kernel::ThreadManager& thread_manager = kernel->GetThreadManager();
+    if (!thread_manager.IsReschedulePending()) {
         return;
     }
 
-    reschedule_pending = false;
-    kernel->GetThreadManager().Reschedule();
+    thread_manager.Reschedule();
 }
 
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mode) {
@@ -202,21 +270,35 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
 
     timing = std::make_unique<Timing>();
 
-    kernel = std::make_unique<Kernel::KernelSystem>(*memory, *timing,
-                                                    [this] { PrepareReschedule(); }, system_mode);
+    // The Old 3DS has the application and system cores, the New 3DS adds two more
+    const u32 num_cores =
+        Settings::values.use_multi_core ? (Settings::values.is_new_3ds ? 4 : 2) : 1;
 
-    if (Settings::values.use_cpu_jit) {
+    kernel = std::make_unique<Kernel::KernelSystem>(
+        *memory, *timing, [this] { PrepareReschedule(); }, system_mode, num_cores);
+
+    for (u32 core_id = 0; core_id < num_cores; ++core_id) {
+        std::shared_ptr<ARM_Interface> cpu_core;
+        if (Settings::values.use_cpu_jit) {
 #ifdef ARCHITECTURE_x86_64
-        cpu_core = std::make_shared<ARM_Dynarmic>(this, *memory, USER32MODE);
+            cpu_core = std::make_shared<ARM_Dynarmic>(this, *memory, USER32MODE);
 #else
-        cpu_core = std::make_shared<ARM_DynCom>(this, *memory, USER32MODE);
-        LOG_WARNING(Core, "CPU JIT requested, but Dynarmic not available");
+            cpu_core = std::make_shared<ARM_DynCom>(this, *memory, USER32MODE);
+            if (core_id == 0) {
+                LOG_WARNING(Core, "CPU JIT requested, but Dynarmic not available");
+            }
 #endif
-    } else {
-        cpu_core = std::make_shared<ARM_DynCom>(this, *memory, USER32MODE);
+        } else {
+            cpu_core = std::make_shared<ARM_DynCom>(this, *memory, USER32MODE);
+        }
+        cpu_cores.push_back(std::move(cpu_core));
     }
+    running_core = cpu_cores[0].get();
 
-    kernel->SetCPU(cpu_core);
+    kernel->SetCPUs(cpu_cores);
+    if (num_cores > 1) {
+        LOG_INFO(Core, "Emulating {} CPU cores", num_cores);
+    }
 
     if (Settings::values.enable_dsp_lle) {
         dsp_core = std::make_unique<AudioCore::DspLle>(*memory,
@@ -229,6 +311,7 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
 
     dsp_core->SetSink(Settings::values.sink_id, Settings::values.audio_device_id);
     dsp_core->EnableStretching(Settings::values.enable_audio_stretching);
+    dsp_core->EnableAdaptiveBuffering(Settings::values.enable_adaptive_audio_buffering);
 
     rpc_server = std::make_unique<RPC::RPCServer>();
 
@@ -352,11 +435,18 @@ void System::Shutdown() {
     cheat_engine.reset();
     service_manager.reset();
     dsp_core.reset();
-    cpu_core.reset();
+    running_core = nullptr;
+    cpu_cores.clear();
     kernel.reset();
+    // Drains the file reads still running on the I/O threads, which schedule timing events
+    archive_manager.reset();
     timing.reset();
     app_loader.reset();
 
+    // Make sure save data still held by leaked file objects reaches the disk
+    FileSys::FlushAllWriteBackCaches();
+    FileSys::CancelRomFSImageBuilds();
+
     if (video_dumper->IsDumping()) {
         video_dumper->StopDumping();
     }
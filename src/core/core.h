@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "common/common_types.h"
 #include "core/custom_tex_cache.h"
 #include "core/frontend/applets/mii_selector.h"
@@ -139,7 +140,7 @@ public:
      * @returns True if the emulated system is powered on, otherwise false.
      */
     bool IsPoweredOn() const {
-        return cpu_core != nullptr;
+        return !cpu_cores.empty();
     }
 
     /// Prepare the core emulation for a reschedule
@@ -148,13 +149,24 @@ public:
     PerfStats::Results GetAndResetPerfStats();
 
     /**
-     * Gets a reference to the emulated CPU.
+     * Gets a reference to the emulated CPU of the core currently being run.
      * @returns A reference to the emulated CPU.
      */
     ARM_Interface& CPU() {
-        return *cpu_core;
+        return *running_core;
     }
 
+    /// Gets the number of emulated CPU cores
+    std::size_t GetNumCores() const {
+        return cpu_cores.size();
+    }
+
+    /// Invalidates a range of the code caches of every emulated CPU, after code was modified
+    void InvalidateCacheRange(u32 start_address, std::size_t length);
+
+    /// Clears the code caches of every emulated CPU
+    void ClearInstructionCache();
+
     /**
      * Gets a reference to the emulated DSP.
      * @returns A reference to the emulated DSP.
@@ -222,6 +234,10 @@ public:
     std::unique_ptr<PerfStats> perf_stats;
     FrameLimiter frame_limiter;
 
+    /// Emulated and idle loop cycles when the performance statistics were last reset
+    u64 perf_stats_ticks = 0;
+    u64 perf_stats_skipped_ticks = 0;
+
     void SetStatus(ResultStatus new_status, const char* details = nullptr) {
         status = new_status;
         if (details) {
@@ -275,15 +291,18 @@ private:
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
-    /// ARM11 CPU core
-    std::shared_ptr<ARM_Interface> cpu_core;
+    /// Runs the emulated cores other than the application core for one slice each, after it
+    void RunOtherCores(bool tight_loop);
+
+    /// ARM11 CPU cores, the first one being the application core
+    std::vector<std::shared_ptr<ARM_Interface>> cpu_cores;
+
+    /// ARM11 CPU core currently being run
+    ARM_Interface* running_core = nullptr;
 
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
-    /// When true, signals that a reschedule should happen
-    bool reschedule_pending{};
-
     /// Service manager
     std::shared_ptr<Service::SM::ServiceManager> service_manager;
 
@@ -54,6 +54,14 @@ u64 Timing::GetIdleTicks() const {
     return static_cast<u64>(idled_cycles);
 }
 
+u64 Timing::GetSkippedIdleLoopTicks() const {
+    return static_cast<u64>(skipped_idle_loop_cycles);
+}
+
+u64 Timing::GetSkippedIdleLoops() const {
+    return skipped_idle_loops;
+}
+
 void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
                            u64 userdata) {
     ASSERT(event_type != nullptr);
@@ -73,6 +81,11 @@ void Timing::ScheduleEventThreadsafe(s64 cycles_into_future, const TimingEventTy
     ts_queue.Push(Event{global_timer + cycles_into_future, 0, userdata, event_type});
 }
 
+void Timing::ScheduleEventThreadsafeAt(u64 ticks, const TimingEventType* event_type,
+                                       u64 userdata) {
+    ts_queue.Push(Event{static_cast<s64>(ticks), 0, userdata, event_type});
+}
+
 void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
     auto itr = std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
         return e.type == event_type && e.userdata == userdata;
@@ -120,8 +133,9 @@ void Timing::MoveEvents() {
 void Timing::Advance() {
     MoveEvents();
 
-    const s64 cycles_executed = slice_length - downcount;
+    const s64 cycles_executed = std::max(slice_executed, slice_length - downcount);
     global_timer += cycles_executed;
+    slice_executed = 0;
     slice_length = MAX_SLICE_LENGTH;
 
     is_global_timer_sane = true;
@@ -144,11 +158,23 @@ void Timing::Advance() {
     downcount = slice_length;
 }
 
+void Timing::RestartSlice() {
+    slice_executed = std::max(slice_executed, slice_length - downcount);
+    downcount = slice_length;
+}
+
 void Timing::Idle() {
     idled_cycles += downcount;
     downcount = 0;
 }
 
+void Timing::SkipIdleLoop() {
+    if (downcount > 0)
+        skipped_idle_loop_cycles += downcount;
+    ++skipped_idle_loops;
+    Idle();
+}
+
 std::chrono::microseconds Timing::GetGlobalTimeUs() const {
     return std::chrono::microseconds{GetTicks() * 1000000 / BASE_CLOCK_RATE_ARM11};
 }
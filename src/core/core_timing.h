@@ -144,6 +144,12 @@ public:
     u64 GetIdleTicks() const;
     void AddTicks(u64 ticks);
 
+    /// Gets the number of cycles skipped by SkipIdleLoop
+    u64 GetSkippedIdleLoopTicks() const;
+
+    /// Gets the number of times SkipIdleLoop was called
+    u64 GetSkippedIdleLoops() const;
+
     /**
      * Returns the event_type identifier. if name is not unique, it will assert.
      */
@@ -165,6 +171,13 @@ public:
     void ScheduleEventThreadsafe(s64 cycles_into_future, const TimingEventType* event_type,
                                  u64 userdata);
 
+    /**
+     * Like ScheduleEventThreadsafe, but at a given number of ticks rather than relative to the
+     * current time, which other threads can't read. An event whose time has already passed is
+     * run by the next Advance.
+     */
+    void ScheduleEventThreadsafeAt(u64 ticks, const TimingEventType* event_type, u64 userdata);
+
     void UnscheduleEvent(const TimingEventType* event_type, u64 userdata);
 
     /// We only permit one event of each type in the queue at a time.
@@ -180,9 +193,18 @@ public:
     void Advance();
     void MoveEvents();
 
+    /**
+     * Restarts the current slice for the next core, when several cores run the same slice one
+     * after the other. The time that passes during the slice is the most any of them executed.
+     */
+    void RestartSlice();
+
     /// Pretend that the main CPU has executed enough cycles to reach the next event.
     void Idle();
 
+    /// Like Idle, for a thread that was found spinning until the next event
+    void SkipIdleLoop();
+
     void ForceExceptionCheck(s64 cycles);
 
     std::chrono::microseconds GetGlobalTimeUs() const;
@@ -205,6 +227,8 @@ private:
     s64 global_timer = 0;
     s64 slice_length = MAX_SLICE_LENGTH;
     s64 downcount = MAX_SLICE_LENGTH;
+    // The most cycles executed in the current slice by the cores that already ran it
+    s64 slice_executed = 0;
 
     // unordered_map stores each element separately as a linked list node so pointers to
     // elements remain stable regardless of rehashes/resizing.
@@ -220,6 +244,8 @@ private:
     // to the event_queue by the emu thread
     Common::MPSCQueue<Event> ts_queue;
     s64 idled_cycles = 0;
+    s64 skipped_idle_loop_cycles = 0;
+    u64 skipped_idle_loops = 0;
 
     // Are we in a function that has been called from Advance()
     // If events are sheduled from a function that gets called from Advance(),
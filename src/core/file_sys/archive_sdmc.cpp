@@ -135,7 +135,7 @@ ResultCode SDMCArchive::DeleteFile(const Path& path) const {
         break; // Expected 'success' case
     }
 
-    if (FileUtil::Delete(full_path)) {
+    if (DeleteWithWriteBack(full_path, [&] { return FileUtil::Delete(full_path); })) {
         return RESULT_SUCCESS;
     }
 
@@ -162,7 +162,7 @@ ResultCode SDMCArchive::RenameFile(const Path& src_path, const Path& dest_path)
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    if (RenameWithWriteBack(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
 
@@ -203,7 +203,7 @@ static ResultCode DeleteDirectoryHelper(const Path& path, const std::string& mou
         break; // Expected 'success' case
     }
 
-    if (deleter(full_path)) {
+    if (DeleteWithWriteBack(full_path, [&] { return deleter(full_path); })) {
         return RESULT_SUCCESS;
     }
 
@@ -319,7 +319,7 @@ ResultCode SDMCArchive::RenameDirectory(const Path& src_path, const Path& dest_p
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    if (RenameWithWriteBack(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
 
@@ -3,11 +3,26 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <boost/icl/interval_set.hpp>
+#include <fmt/format.h>
+#include "common/common_funcs.h"
+#include "common/common_paths.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/thread.h"
 #include "core/file_sys/disk_archive.h"
 #include "core/file_sys/errors.h"
 
@@ -16,11 +31,452 @@
 
 namespace FileSys {
 
+namespace {
+
+/**
+ * Held by every write-back flush and by every archive operation deleting or moving host files, so
+ * that a flush never writes to a path that is being changed. Also guards the paths of the caches.
+ */
+std::mutex write_back_io_mutex;
+
+constexpr u32 JournalMagic = 0x4A425743; // "CWBJ"
+
+struct JournalHeader {
+    u32_le magic;
+    u32_le path_size;
+    u64_le file_size;
+    u32_le num_ranges;
+    INSERT_PADDING_WORDS(1);
+};
+static_assert(sizeof(JournalHeader) == 0x18, "JournalHeader has incorrect size");
+
+struct JournalRange {
+    u64_le offset;
+    u64_le size;
+};
+static_assert(sizeof(JournalRange) == 0x10, "JournalRange has incorrect size");
+
+struct DirtyRange {
+    u64 offset;
+    std::vector<u8> data;
+};
+
+/// Directory holding the write-back journals, outside of every archive
+std::string GetJournalDirectory() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::UserDir) + "save_journal" DIR_SEP;
+}
+
+std::string GetJournalPath(const std::string& path) {
+    return fmt::format("{}{:016X}.journal", GetJournalDirectory(),
+                       Common::ComputeHash64(path.data(), path.size()));
+}
+
+/// Writes ranges of a file and its size in place, and waits for them to reach the disk
+bool ApplyRanges(const std::string& path, u64 file_size, const std::vector<DirtyRange>& ranges) {
+    FileUtil::IOFile file(path, "r+b");
+    if (!file.IsOpen())
+        file.Open(path, "wb");
+    if (!file.IsOpen() || !file.Resize(file_size))
+        return false;
+    for (const DirtyRange& range : ranges) {
+        if (!file.Seek(range.offset, SEEK_SET) ||
+            file.WriteBytes(range.data.data(), range.data.size()) != range.data.size()) {
+            return false;
+        }
+    }
+    return file.Sync();
+}
+
+/**
+ * Writes ranges of a file without risking its contents on a crash. The ranges are first written
+ * to a journal outside of the archive, which is synced and atomically renamed into place, and only
+ * then to the file itself. A journal left behind by a crash is replayed by ReplayJournals.
+ */
+bool WriteRanges(const std::string& path, u64 file_size, const std::vector<DirtyRange>& ranges) {
+    const std::string journal_path = GetJournalPath(path);
+    const std::string temp_path = journal_path + ".tmp";
+    if (!FileUtil::CreateFullPath(journal_path))
+        return false;
+
+    {
+        FileUtil::IOFile journal(temp_path, "wb");
+        JournalHeader header{};
+        header.magic = JournalMagic;
+        header.path_size = static_cast<u32>(path.size());
+        header.file_size = file_size;
+        header.num_ranges = static_cast<u32>(ranges.size());
+        bool written = journal.IsOpen() && journal.WriteObject(header) == 1 &&
+                       journal.WriteBytes(path.data(), path.size()) == path.size();
+        for (const DirtyRange& range : ranges) {
+            const JournalRange range_header{range.offset, range.data.size()};
+            written = written && journal.WriteObject(range_header) == 1 &&
+                      journal.WriteBytes(range.data.data(), range.data.size()) ==
+                          range.data.size();
+        }
+        if (!written || !journal.Sync()) {
+            journal.Close();
+            FileUtil::Delete(temp_path);
+            return false;
+        }
+    }
+    if (!FileUtil::ReplaceFile(temp_path, journal_path)) {
+        FileUtil::Delete(temp_path);
+        return false;
+    }
+
+    // On failure the journal stays behind, and gets replayed on the next start
+    if (!ApplyRanges(path, file_size, ranges))
+        return false;
+    FileUtil::Delete(journal_path);
+    return true;
+}
+
+/// Finishes the flushes interrupted by a crash, and cleans up the journals they were writing
+void ReplayJournals() {
+    const auto replay = [](u64*, const std::string& directory, const std::string& name) {
+        const std::string journal_path = directory + DIR_SEP + name;
+        if (name.size() < 8 || name.compare(name.size() - 8, 8, ".journal") != 0) {
+            // Journal that was still being written, the file itself wasn't touched yet
+            FileUtil::Delete(journal_path);
+            return true;
+        }
+
+        FileUtil::IOFile journal(journal_path, "rb");
+        const u64 journal_size = journal.GetSize();
+        JournalHeader header{};
+        std::string path;
+        std::vector<DirtyRange> ranges;
+        bool valid = journal.ReadArray(&header, 1) == 1 && header.magic == JournalMagic &&
+                     header.path_size <= journal_size;
+        if (valid) {
+            path.resize(header.path_size);
+            valid = journal.ReadBytes(path.data(), path.size()) == path.size();
+        }
+        for (u32 i = 0; valid && i < header.num_ranges; ++i) {
+            JournalRange range_header{};
+            valid = journal.ReadArray(&range_header, 1) == 1 &&
+                    range_header.size <= journal_size - journal.Tell();
+            if (valid) {
+                DirtyRange& range = ranges.emplace_back();
+                range.offset = range_header.offset;
+                range.data.resize(range_header.size);
+                valid = journal.ReadBytes(range.data.data(), range.data.size()) ==
+                        range.data.size();
+            }
+        }
+        journal.Close();
+
+        if (!valid) {
+            LOG_ERROR(Service_FS, "Discarding corrupted save data journal {}", journal_path);
+        } else if (ApplyRanges(path, header.file_size, ranges)) {
+            LOG_WARNING(Service_FS, "Finished writing {} from its journal", path);
+        } else {
+            LOG_ERROR(Service_FS, "Failed to replay the journal of {}", path);
+            return true;
+        }
+        FileUtil::Delete(journal_path);
+        return true;
+    };
+    FileUtil::ForeachDirectoryEntry(nullptr, GetJournalDirectory(), replay);
+}
+
+/// Whether a path is the given file or directory, or lies under it
+bool IsSameOrUnder(const std::string& path, const std::string& prefix) {
+    if (prefix.empty() || path.compare(0, prefix.size(), prefix) != 0)
+        return false;
+    return path.size() == prefix.size() || prefix.back() == '/' || prefix.back() == '\\' ||
+           path[prefix.size()] == '/' || path[prefix.size()] == '\\';
+}
+
+} // Anonymous namespace
+
+/// In-memory copy of a file, shared by all the DiskFiles open on its path
+class WriteBackCache {
+public:
+    WriteBackCache(std::string path, std::vector<u8>&& data)
+        : path(std::move(path)), data(std::move(data)) {}
+
+    ~WriteBackCache() {
+        Flush();
+    }
+
+    std::size_t Read(u64 offset, std::size_t length, u8* buffer) {
+        std::lock_guard lock{data_mutex};
+        if (offset >= data.size())
+            return 0;
+        length = std::min<std::size_t>(length, data.size() - offset);
+        std::memcpy(buffer, data.data() + offset, length);
+        return length;
+    }
+
+    std::size_t Write(u64 offset, std::size_t length, const u8* buffer) {
+        std::lock_guard lock{data_mutex};
+        // Like with a host file, writing past the end zero-fills the gap
+        const u64 dirty_start = std::min<u64>(offset, data.size());
+        if (offset + length > data.size())
+            data.resize(offset + length);
+        std::memcpy(data.data() + offset, buffer, length);
+        dirty_ranges.add(Interval::right_open(dirty_start, offset + length));
+        return length;
+    }
+
+    u64 GetSize() {
+        std::lock_guard lock{data_mutex};
+        return data.size();
+    }
+
+    void SetSize(u64 size) {
+        std::lock_guard lock{data_mutex};
+        if (size < data.size()) {
+            dirty_ranges.erase(Interval::right_open(size, data.size()));
+        } else if (size > data.size()) {
+            dirty_ranges.add(Interval::right_open(data.size(), size));
+        }
+        data.resize(size);
+        size_dirty = true;
+    }
+
+    /// Writes the modified ranges out to the host file
+    bool Flush() {
+        std::lock_guard io_lock{write_back_io_mutex};
+        if (path.empty())
+            return true;
+
+        std::vector<DirtyRange> ranges;
+        u64 file_size;
+        {
+            std::lock_guard lock{data_mutex};
+            if (dirty_ranges.empty() && !size_dirty)
+                return true;
+            for (const auto& interval : dirty_ranges) {
+                ranges.push_back({interval.lower(), {data.begin() + interval.lower(),
+                                                     data.begin() + interval.upper()}});
+            }
+            file_size = data.size();
+            dirty_ranges.clear();
+            size_dirty = false;
+        }
+
+        if (WriteRanges(path, file_size, ranges))
+            return true;
+
+        LOG_ERROR(Service_FS, "Failed to write {}", path);
+        std::lock_guard lock{data_mutex};
+        for (const DirtyRange& range : ranges) {
+            const u64 end = std::min<u64>(range.offset + range.data.size(), data.size());
+            if (range.offset < end)
+                dirty_ranges.add(Interval::right_open(range.offset, end));
+        }
+        size_dirty = true;
+        return false;
+    }
+
+    /// Gets the host path of the file. write_back_io_mutex must be held.
+    const std::string& GetPath() const {
+        return path;
+    }
+
+    /// Moves the file to another host path. write_back_io_mutex must be held.
+    void SetPath(std::string new_path) {
+        path = std::move(new_path);
+    }
+
+    /// Drops the pending writes of a file that was deleted. write_back_io_mutex must be held.
+    void Detach() {
+        path.clear();
+        std::lock_guard lock{data_mutex};
+        dirty_ranges.clear();
+        size_dirty = false;
+    }
+
+private:
+    using IntervalSet = boost::icl::interval_set<u64>;
+    using Interval = IntervalSet::interval_type;
+
+    /// Empty once the file was deleted
+    std::string path;
+
+    std::mutex data_mutex;
+    std::vector<u8> data;
+    IntervalSet dirty_ranges;
+    bool size_dirty = false;
+};
+
+namespace {
+
+/// Files larger than this are never held in a write-back cache
+constexpr u64 MaxWriteBackFileSize = 32 * 1024 * 1024;
+
+/// How often the background thread writes out modified caches
+constexpr std::chrono::seconds WriteBackFlushInterval{5};
+
+/// Keeps track of the live write-back caches and periodically flushes them
+class WriteBackCacheRegistry {
+public:
+    static WriteBackCacheRegistry& Instance() {
+        static WriteBackCacheRegistry registry;
+        return registry;
+    }
+
+    ~WriteBackCacheRegistry() {
+        {
+            std::lock_guard lock{mutex};
+            stop = true;
+        }
+        cv.notify_one();
+        if (flush_thread.joinable())
+            flush_thread.join();
+    }
+
+    /**
+     * Gets the cache of the file at the given path, optionally creating it from the contents of
+     * the given open file.
+     * @return The cache, or nullptr if there is none and none could be created
+     */
+    std::shared_ptr<WriteBackCache> Get(const std::string& path, FileUtil::IOFile& file,
+                                        bool create) {
+        std::lock_guard lock{mutex};
+        if (auto it = caches.find(path); it != caches.end()) {
+            if (auto cache = it->second.lock())
+                return cache;
+        }
+        if (!create)
+            return nullptr;
+
+        const u64 size = file.GetSize();
+        if (size > MaxWriteBackFileSize)
+            return nullptr;
+        std::vector<u8> data(size);
+        file.Seek(0, SEEK_SET);
+        if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+            LOG_ERROR(Service_FS, "Failed to read {}, not caching it", path);
+            return nullptr;
+        }
+
+        auto cache = std::make_shared<WriteBackCache>(path, std::move(data));
+        caches[path] = cache;
+        if (!flush_thread.joinable())
+            flush_thread = std::thread(&WriteBackCacheRegistry::FlushThread, this);
+        return cache;
+    }
+
+    void FlushAll() {
+        for (const auto& cache : GetLiveCaches())
+            cache->Flush();
+    }
+
+    bool Delete(const std::string& path, const std::function<bool()>& deleter) {
+        // Destroyed after the lock is released, as destroying a cache flushes it
+        std::vector<std::shared_ptr<WriteBackCache>> deleted;
+        std::lock_guard io_lock{write_back_io_mutex};
+        if (!deleter())
+            return false;
+        deleted = TakeCaches(path);
+        for (const auto& cache : deleted)
+            cache->Detach();
+        return true;
+    }
+
+    bool Rename(const std::string& src_path, const std::string& dest_path) {
+        std::vector<std::shared_ptr<WriteBackCache>> replaced, moved;
+        std::lock_guard io_lock{write_back_io_mutex};
+        if (!FileUtil::Rename(src_path, dest_path))
+            return false;
+        replaced = TakeCaches(dest_path);
+        for (const auto& cache : replaced)
+            cache->Detach();
+        moved = TakeCaches(src_path);
+
+        // Directories may be given with or without a trailing separator
+        const auto strip_separator = [](std::string_view path) {
+            while (path.size() > 1 && (path.back() == '/' || path.back() == '\\'))
+                path.remove_suffix(1);
+            return path;
+        };
+        const std::size_t src_size = strip_separator(src_path).size();
+        const std::string dest(strip_separator(dest_path));
+        std::lock_guard lock{mutex};
+        for (const auto& cache : moved) {
+            cache->SetPath(dest + cache->GetPath().substr(src_size));
+            caches[cache->GetPath()] = cache;
+        }
+        return true;
+    }
+
+private:
+    WriteBackCacheRegistry() {
+        ReplayJournals();
+    }
+
+    std::vector<std::shared_ptr<WriteBackCache>> GetLiveCaches() {
+        std::lock_guard lock{mutex};
+        std::vector<std::shared_ptr<WriteBackCache>> live_caches;
+        for (auto it = caches.begin(); it != caches.end();) {
+            if (auto cache = it->second.lock()) {
+                live_caches.push_back(std::move(cache));
+                ++it;
+            } else {
+                it = caches.erase(it);
+            }
+        }
+        return live_caches;
+    }
+
+    /// Removes the caches of the files under a path from the registry and returns the live ones
+    std::vector<std::shared_ptr<WriteBackCache>> TakeCaches(const std::string& path) {
+        std::lock_guard lock{mutex};
+        std::vector<std::shared_ptr<WriteBackCache>> taken;
+        for (auto it = caches.begin(); it != caches.end();) {
+            if (!IsSameOrUnder(it->first, path)) {
+                ++it;
+                continue;
+            }
+            if (auto cache = it->second.lock())
+                taken.push_back(std::move(cache));
+            it = caches.erase(it);
+        }
+        return taken;
+    }
+
+    void FlushThread() {
+        Common::SetCurrentThreadName("Save data flush");
+        std::unique_lock lock{mutex};
+        while (!cv.wait_for(lock, WriteBackFlushInterval, [this] { return stop; })) {
+            lock.unlock();
+            FlushAll();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop = false;
+    std::unordered_map<std::string, std::weak_ptr<WriteBackCache>> caches;
+    std::thread flush_thread;
+};
+
+} // Anonymous namespace
+
+DiskFile::~DiskFile() = default;
+
+void DiskFile::EnableWriteBack(const std::string& path) {
+    // Read-only files only join an existing cache, so that they see pending writes
+    write_back = WriteBackCacheRegistry::Instance().Get(path, *file, mode.write_flag != 0);
+    if (write_back) {
+        // Flushes write through handles of their own, don't keep the file open so that the
+        // archive can still delete or rename it
+        file->Close();
+    }
+}
+
 ResultVal<std::size_t> DiskFile::Read(const u64 offset, const std::size_t length,
                                       u8* buffer) const {
     if (!mode.read_flag)
         return ERROR_INVALID_OPEN_FLAGS;
 
+    if (write_back)
+        return MakeResult<std::size_t>(write_back->Read(offset, length, buffer));
+
     file->Seek(offset, SEEK_SET);
     return MakeResult<std::size_t>(file->ReadBytes(buffer, length));
 }
@@ -30,6 +486,11 @@ ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t lengt
     if (!mode.write_flag)
         return ERROR_INVALID_OPEN_FLAGS;
 
+    // With a write-back cache, flushing is deferred to Flush, Close or the flush thread, so that
+    // titles flushing on every small write don't turn each of them into a rewrite of the file.
+    if (write_back)
+        return MakeResult<std::size_t>(write_back->Write(offset, length, buffer));
+
     file->Seek(offset, SEEK_SET);
     std::size_t written = file->WriteBytes(buffer, length);
     if (flush)
@@ -38,19 +499,51 @@ ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t lengt
 }
 
 u64 DiskFile::GetSize() const {
+    if (write_back)
+        return write_back->GetSize();
+
     return file->GetSize();
 }
 
 bool DiskFile::SetSize(const u64 size) const {
+    if (write_back) {
+        write_back->SetSize(size);
+        return true;
+    }
+
     file->Resize(size);
     file->Flush();
     return true;
 }
 
 bool DiskFile::Close() const {
+    if (write_back)
+        return write_back->Flush();
+
     return file->Close();
 }
 
+void DiskFile::Flush() const {
+    if (write_back) {
+        write_back->Flush();
+        return;
+    }
+
+    file->Flush();
+}
+
+void FlushAllWriteBackCaches() {
+    WriteBackCacheRegistry::Instance().FlushAll();
+}
+
+bool DeleteWithWriteBack(const std::string& path, const std::function<bool()>& deleter) {
+    return WriteBackCacheRegistry::Instance().Delete(path, deleter);
+}
+
+bool RenameWithWriteBack(const std::string& src_path, const std::string& dest_path) {
+    return WriteBackCacheRegistry::Instance().Rename(src_path, dest_path);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 DiskDirectory::DiskDirectory(const std::string& path) {
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -20,6 +21,8 @@
 
 namespace FileSys {
 
+class WriteBackCache;
+
 class DiskFile : public FileBackend {
 public:
     DiskFile(FileUtil::IOFile&& file_, const Mode& mode_,
@@ -28,6 +31,18 @@ public:
         delay_generator = std::move(delay_generator_);
         mode.hex = mode_.hex;
     }
+    ~DiskFile() override;
+
+    /**
+     * Routes all accesses to this file through an in-memory write-back cache shared with every
+     * other DiskFile open on the same path. Writes are coalesced in memory and only written out on
+     * Flush, Close, when the last file using the cache is destroyed, or periodically from a
+     * background thread. Only the modified ranges are written, through a journal kept outside of
+     * the archive, so that an interrupted flush never leaves a partially written file behind.
+     * Files too large to be held in memory keep being accessed directly.
+     * @param path Host path the file was opened from
+     */
+    void EnableWriteBack(const std::string& path);
 
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
@@ -35,16 +50,32 @@ public:
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
     bool Close() const override;
-
-    void Flush() const override {
-        file->Flush();
-    }
+    void Flush() const override;
 
 protected:
     Mode mode;
     std::unique_ptr<FileUtil::IOFile> file;
+    std::shared_ptr<WriteBackCache> write_back;
 };
 
+/// Writes out the pending data of all the write-back caches of DiskFiles
+void FlushAllWriteBackCaches();
+
+/**
+ * Deletes host files through `deleter`, e.g. a file or a directory, and then drops the write-back
+ * caches of the files under `path` so that no later flush brings them back. No cache is flushed
+ * while the deleter runs.
+ * @return Whether the deleter succeeded
+ */
+bool DeleteWithWriteBack(const std::string& path, const std::function<bool()>& deleter);
+
+/**
+ * Renames a host file or directory, moving the write-back caches of the files under it along so
+ * that their later flushes go to the new path. No cache is flushed while the rename runs.
+ * @return Whether the rename succeeded
+ */
+bool RenameWithWriteBack(const std::string& src_path, const std::string& dest_path);
+
 class DiskDirectory : public DirectoryBackend {
 public:
     explicit DiskDirectory(const std::string& path);
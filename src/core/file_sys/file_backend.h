@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/result.h"
 #include "delay_generator.h"
@@ -30,6 +32,25 @@ public:
      */
     virtual ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const = 0;
 
+    /**
+     * Read data from the file into a list of discontiguous buffers, filling them in order
+     * @param offset Offset in bytes to start reading data from
+     * @param blocks Buffers to read data into, as (pointer, length) pairs
+     * @return Number of bytes read, or error code
+     */
+    virtual ResultVal<std::size_t> ReadScatter(
+        u64 offset, const std::vector<std::pair<u8*, u32>>& blocks) const {
+        std::size_t total_read = 0;
+        for (const auto& [block, block_size] : blocks) {
+            CASCADE_RESULT(std::size_t read, Read(offset + total_read, block_size, block));
+            total_read += read;
+            if (read < block_size) {
+                break;
+            }
+        }
+        return MakeResult(total_read);
+    }
+
     /**
      * Write data to the file
      * @param offset Offset in bytes to start writing data to
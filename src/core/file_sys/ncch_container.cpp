@@ -2,19 +2,27 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <atomic>
 #include <cinttypes>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include <cryptopp/sha.h>
+#include <fmt/format.h>
+#include "common/common_paths.h"
 #include "common/common_types.h"
+#include "common/detached_tasks.h"
 #include "common/logging/log.h"
+#include "common/zstd_compression.h"
 #include "core/core.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/seed_db.h"
 #include "core/hw/aes/key.h"
 #include "core/loader/loader.h"
+#include "core/settings.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
@@ -151,6 +159,72 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
     return true;
 }
 
+/**
+ * Gets the path of a cached, already decrypted copy of an NCCH section. The section's hash from
+ * the NCCH header is part of the name, so that different versions of a title don't collide.
+ * @param program_id Program ID of the NCCH
+ * @param section_hash Super block hash of the section
+ * @param extension Extension identifying the kind of cached data
+ * @return Path of the cache file
+ */
+static std::string GetTitleImageCachePath(u64 program_id, const u8* section_hash,
+                                          const char* extension) {
+    u64 hash;
+    std::memcpy(&hash, section_hash, sizeof(hash));
+    return fmt::format("{}title_images" DIR_SEP "{:016X}_{:016X}.{}",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), program_id, hash,
+                       extension);
+}
+
+/**
+ * Loads a zstd-compressed cached section
+ * @param path Path of the cache file
+ * @param buffer Buffer to decompress the section into
+ * @return True on success, otherwise false
+ */
+static bool LoadCachedSection(const std::string& path, std::vector<u8>& buffer) {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen())
+        return false;
+
+    std::vector<u8> compressed(file.GetSize());
+    if (file.ReadBytes(compressed.data(), compressed.size()) != compressed.size())
+        return false;
+
+    std::vector<u8> decompressed = Common::Compression::DecompressDataZSTD(compressed);
+    if (decompressed.empty())
+        return false;
+
+    buffer = std::move(decompressed);
+    return true;
+}
+
+/**
+ * Stores a section in the cache, compressed with zstd. The data is written to a temporary file
+ * first, so that an interrupted write never leaves a truncated cache file behind.
+ * @param path Path of the cache file
+ * @param buffer Section data to store
+ */
+static void StoreCachedSection(const std::string& path, const std::vector<u8>& buffer) {
+    if (!FileUtil::CreateFullPath(path))
+        return;
+
+    const std::string temp_path = path + ".tmp";
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataZSTDDefault(buffer.data(), buffer.size());
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        if (file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return;
+        }
+    }
+    if (!FileUtil::ReplaceFile(temp_path, path)) {
+        FileUtil::Delete(temp_path);
+    }
+}
+
 NCCHContainer::NCCHContainer(const std::string& filepath, u32 ncch_offset)
     : ncch_offset(ncch_offset), filepath(filepath) {
     file = FileUtil::IOFile(filepath, "rb");
@@ -232,12 +306,20 @@ Loader::ResultStatus NCCHContainer::Load() {
                     }
                 }
 
-                SetKeyY(KeySlotID::NCCHSecure1, key_y_primary);
-                if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure1)) {
-                    LOG_ERROR(Service_FS, "Secure1 KeyX missing");
-                    failed_to_decrypt = true;
-                }
-                primary_key = GetNormalKey(KeySlotID::NCCHSecure1);
+                // The key slots are shared with the emulated system and other loaders, so the
+                // normal keys are derived without setting the KeyY of the slots
+                const auto derive_key = [&failed_to_decrypt](std::size_t slot_id,
+                                                             const AESKey& key_y,
+                                                             const char* name) {
+                    const std::optional<AESKey> key = DeriveNormalKey(slot_id, key_y);
+                    if (!key) {
+                        LOG_ERROR(Service_FS, "{} KeyX missing", name);
+                        failed_to_decrypt = true;
+                    }
+                    return key.value_or(AESKey{});
+                };
+
+                primary_key = derive_key(KeySlotID::NCCHSecure1, key_y_primary, "Secure1");
 
                 switch (ncch_header.secondary_key_slot) {
                 case 0:
@@ -246,30 +328,15 @@ Loader::ResultStatus NCCHContainer::Load() {
                     break;
                 case 1:
                     LOG_DEBUG(Service_FS, "Secure2 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure2, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure2)) {
-                        LOG_ERROR(Service_FS, "Secure2 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure2);
+                    secondary_key = derive_key(KeySlotID::NCCHSecure2, key_y_secondary, "Secure2");
                     break;
                 case 10:
                     LOG_DEBUG(Service_FS, "Secure3 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure3, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure3)) {
-                        LOG_ERROR(Service_FS, "Secure3 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure3);
+                    secondary_key = derive_key(KeySlotID::NCCHSecure3, key_y_secondary, "Secure3");
                     break;
                 case 11:
                     LOG_DEBUG(Service_FS, "Secure4 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure4, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure4)) {
-                        LOG_ERROR(Service_FS, "Secure4 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure4);
+                    secondary_key = derive_key(KeySlotID::NCCHSecure4, key_y_secondary, "Secure4");
                     break;
                 }
             }
@@ -491,6 +558,20 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
     if (!exefs_file.IsOpen())
         return Loader::ResultStatus::Error;
 
+    // Decrypting and decompressing the code is the bulk of the work here, so keep the result
+    const bool use_code_cache = Settings::values.use_title_image_cache &&
+                                std::strcmp(name, ".code") == 0 && !is_tainted &&
+                                (is_encrypted || is_compressed);
+    std::string code_cache_path;
+    if (use_code_cache) {
+        code_cache_path = GetTitleImageCachePath(ncch_header.program_id,
+                                                 ncch_header.exefs_super_block_hash, "code");
+        if (LoadCachedSection(code_cache_path, buffer)) {
+            LOG_DEBUG(Service_FS, "Loaded .code section from {}", code_cache_path);
+            return Loader::ResultStatus::Success;
+        }
+    }
+
     LOG_DEBUG(Service_FS, "{} sections:", kMaxSections);
     // Iterate through the ExeFs archive until we find a section with the specified name...
     for (unsigned section_number = 0; section_number < kMaxSections; section_number++) {
@@ -547,6 +628,10 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                 }
             }
 
+            if (use_code_cache) {
+                StoreCachedSection(code_cache_path, buffer);
+            }
+
             return Loader::ResultStatus::Success;
         }
     }
@@ -626,6 +711,18 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
     if (file.GetSize() < romfs_offset + romfs_size)
         return Loader::ResultStatus::Error;
 
+    if (Settings::values.use_title_image_cache) {
+        const std::string image_path = GetTitleImageCachePath(
+            ncch_header.program_id, ncch_header.romfs_super_block_hash, "romfs");
+        auto image = RomFSReader::OpenCompressedImage(image_path);
+        if (image && image->GetSize() == romfs_size) {
+            LOG_DEBUG(Service_FS, "Loaded RomFS from {}", image_path);
+            romfs_file = std::move(image);
+            return Loader::ResultStatus::Success;
+        }
+        BuildRomFSImage(image_path, romfs_offset, romfs_size);
+    }
+
     // We reopen the file, to allow its position to be independent from file's
     FileUtil::IOFile romfs_file_inner(filepath, "rb");
     if (!romfs_file_inner.IsOpen())
@@ -642,6 +739,48 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
     return Loader::ResultStatus::Success;
 }
 
+/// Bumped to cancel the RomFS image builds started before
+static std::atomic<u32> romfs_build_generation{0};
+
+void CancelRomFSImageBuilds() {
+    ++romfs_build_generation;
+}
+
+void NCCHContainer::BuildRomFSImage(const std::string& image_path, u32 romfs_offset,
+                                    u32 romfs_size) const {
+    // Several archives may open the same RomFS while its image is still being built
+    static std::mutex building_mutex;
+    static std::unordered_set<std::string> building;
+    {
+        std::lock_guard lock{building_mutex};
+        if (!building.insert(image_path).second)
+            return;
+    }
+
+    Common::DetachedTasks::AddTask([image_path, filepath = filepath, romfs_offset, romfs_size,
+                                    is_encrypted = is_encrypted, key = secondary_key,
+                                    ctr = romfs_ctr, generation = romfs_build_generation.load()] {
+        const auto is_cancelled = [generation] { return romfs_build_generation != generation; };
+        FileUtil::IOFile file(filepath, "rb");
+        if (file.IsOpen()) {
+            LOG_INFO(Service_FS, "Building RomFS image {}", image_path);
+            std::unique_ptr<RomFSReader> reader;
+            if (is_encrypted) {
+                reader = std::make_unique<RomFSReader>(std::move(file), romfs_offset, romfs_size,
+                                                       key, ctr, 0x1000);
+            } else {
+                reader = std::make_unique<RomFSReader>(std::move(file), romfs_offset, romfs_size);
+            }
+            if (!reader->WriteCompressedImage(image_path, is_cancelled) && !is_cancelled()) {
+                LOG_ERROR(Service_FS, "Failed to build RomFS image {}", image_path);
+            }
+        }
+
+        std::lock_guard lock{building_mutex};
+        building.erase(image_path);
+    });
+}
+
 Loader::ResultStatus NCCHContainer::ReadOverrideRomFS(std::shared_ptr<RomFSReader>& romfs_file) {
     // Check for RomFS overrides
     std::string split_filepath = filepath + ".romfs";
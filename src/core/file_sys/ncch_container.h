@@ -301,6 +301,12 @@ public:
     ExHeader_Header exheader_header;
 
 private:
+    /**
+     * Writes a decrypted, compressed copy of the RomFS to the title image cache on a background
+     * thread, for use by later boots.
+     */
+    void BuildRomFSImage(const std::string& image_path, u32 romfs_offset, u32 romfs_size) const;
+
     bool has_header = false;
     bool has_exheader = false;
     bool has_exefs = false;
@@ -326,4 +332,10 @@ private:
     FileUtil::IOFile exefs_file;
 };
 
+/**
+ * Stops the RomFS images being built in the background, leaving no partial image behind. Called
+ * at shutdown so that exiting doesn't wait for them.
+ */
+void CancelRomFSImageBuilds();
+
 } // namespace FileSys
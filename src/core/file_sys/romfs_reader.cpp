@@ -1,22 +1,314 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/zstd_compression.h"
 #include "core/file_sys/romfs_reader.h"
 
 namespace FileSys {
 
+namespace {
+
+struct CompressedImageHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le data_size;
+    u32_le block_size;
+    u32_le num_blocks;
+};
+static_assert(sizeof(CompressedImageHeader) == 24, "CompressedImageHeader has incorrect size");
+
+constexpr u32 CompressedImageMagic = 0x46525A43; // "CZRF"
+constexpr u32 CompressedImageVersion = 1;
+
+} // Anonymous namespace
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size) {}
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
+                         const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
+                         std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
+      crypto_offset(crypto_offset), data_size(data_size) {}
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t data_size,
+                         std::vector<u64>&& block_offsets)
+    : is_encrypted(false), is_compressed(true), compressed_block_offsets(std::move(block_offsets)),
+      file(std::move(file)), file_offset(0), data_size(data_size) {}
+
+RomFSReader::~RomFSReader() {
+    if (read_ahead_thread.joinable()) {
+        {
+            std::lock_guard lock{cache_mutex};
+            stop_read_ahead = true;
+        }
+        read_ahead_cv.notify_one();
+        read_ahead_thread.join();
+    }
+}
+
+std::shared_ptr<RomFSReader> RomFSReader::OpenCompressedImage(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen())
+        return nullptr;
+
+    CompressedImageHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != CompressedImageMagic || header.version != CompressedImageVersion ||
+        header.block_size != BlockSize) {
+        LOG_WARNING(Service_FS, "Invalid compressed RomFS image {}", path);
+        return nullptr;
+    }
+
+    const std::size_t num_blocks = (header.data_size + BlockSize - 1) / BlockSize;
+    if (header.num_blocks != num_blocks) {
+        LOG_WARNING(Service_FS, "Compressed RomFS image {} has inconsistent block count", path);
+        return nullptr;
+    }
+
+    std::vector<u64_le> offsets(num_blocks + 1);
+    if (file.ReadArray(offsets.data(), offsets.size()) != offsets.size() ||
+        offsets.back() != file.GetSize()) {
+        LOG_WARNING(Service_FS, "Compressed RomFS image {} is truncated", path);
+        return nullptr;
+    }
+
+    std::vector<u64> block_offsets(offsets.begin(), offsets.end());
+    return std::shared_ptr<RomFSReader>(
+        new RomFSReader(std::move(file), header.data_size, std::move(block_offsets)));
+}
+
+bool RomFSReader::WriteCompressedImage(const std::string& path,
+                                       const std::function<bool()>& is_cancelled) {
+    if (is_compressed)
+        return false;
+
+    const std::string temp_path = path + ".tmp";
+    if (!FileUtil::CreateFullPath(path))
+        return false;
+
+    const std::size_t num_blocks = (data_size + BlockSize - 1) / BlockSize;
+    std::vector<u64_le> offsets(num_blocks + 1);
+    {
+        FileUtil::IOFile out(temp_path, "wb");
+        if (!out.IsOpen())
+            return false;
+
+        CompressedImageHeader header{};
+        header.magic = CompressedImageMagic;
+        header.version = CompressedImageVersion;
+        header.data_size = data_size;
+        header.block_size = static_cast<u32>(BlockSize);
+        header.num_blocks = static_cast<u32>(num_blocks);
+
+        // The index is written once all blocks have been compressed
+        u64 offset = sizeof(header) + offsets.size() * sizeof(u64_le);
+        out.Seek(offset, SEEK_SET);
+
+        std::vector<u8> block(BlockSize);
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+            if (is_cancelled && is_cancelled()) {
+                LOG_DEBUG(Service_FS, "Cancelled writing {}", path);
+                out.Close();
+                FileUtil::Delete(temp_path);
+                return false;
+            }
+            const std::size_t block_size = std::min(BlockSize, data_size - i * BlockSize);
+            if (ReadUncached(i * BlockSize, block_size, block.data()) != block_size) {
+                LOG_ERROR(Service_FS, "Failed to read RomFS block {} for {}", i, path);
+                out.Close();
+                FileUtil::Delete(temp_path);
+                return false;
+            }
+            const std::vector<u8> compressed =
+                Common::Compression::CompressDataZSTDDefault(block.data(), block_size);
+            offsets[i] = offset;
+            if (out.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+                out.Close();
+                FileUtil::Delete(temp_path);
+                return false;
+            }
+            offset += compressed.size();
+        }
+        offsets[num_blocks] = offset;
+
+        out.Seek(0, SEEK_SET);
+        if (out.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
+            out.WriteArray(offsets.data(), offsets.size()) != offsets.size()) {
+            out.Close();
+            FileUtil::Delete(temp_path);
+            return false;
+        }
+    }
+
+    // Only publish complete images, so that an interrupted write is never picked up
+    if (!FileUtil::ReplaceFile(temp_path, path)) {
+        FileUtil::Delete(temp_path);
+        return false;
+    }
+    return true;
+}
+
 std::size_t RomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
+    if (length == 0 || offset >= data_size)
         return 0; // Crypto++ does not like zero size buffer
-    file.Seek(file_offset + offset, SEEK_SET);
-    std::size_t read_length = std::min(length, data_size - offset);
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+    const std::size_t read_length = std::min(length, data_size - offset);
+
+    bool sequential;
+    std::size_t capacity;
+    {
+        std::lock_guard lock{cache_mutex};
+        sequential = offset == sequential_offset;
+        sequential_offset = offset + read_length;
+        capacity = cache_capacity;
+    }
+
+    // Large reads would only flush the cache, so stream them directly into the buffer
+    if (!is_compressed && read_length > capacity / 2) {
+        return ReadUncached(offset, read_length, buffer);
+    }
+
+    std::size_t total_read = 0;
+    while (total_read < read_length) {
+        const std::size_t position = offset + total_read;
+        const std::size_t block_index = position / BlockSize;
+        const std::size_t block_offset = position % BlockSize;
+        const std::shared_ptr<const Block> block = GetBlock(block_index);
+        if (block_offset >= block->size())
+            break;
+        const std::size_t copy_length =
+            std::min(read_length - total_read, block->size() - block_offset);
+        std::memcpy(buffer + total_read, block->data() + block_offset, copy_length);
+        total_read += copy_length;
+    }
+
+    if (sequential) {
+        RequestReadAhead((offset + total_read + BlockSize - 1) / BlockSize);
+    }
+
+    return total_read;
+}
+
+void RomFSReader::SetCacheCapacity(std::size_t capacity) {
+    std::lock_guard lock{cache_mutex};
+    cache_capacity = capacity;
+    EvictBlocks();
+}
+
+std::shared_ptr<const RomFSReader::Block> RomFSReader::GetBlock(std::size_t block_index) {
+    if (auto block = FindCachedBlock(block_index)) {
+        return block;
+    }
+    auto block = LoadBlock(block_index);
+    InsertBlock(block_index, block);
+    return block;
+}
+
+std::shared_ptr<const RomFSReader::Block> RomFSReader::LoadBlock(std::size_t block_index) {
+    const std::size_t offset = block_index * BlockSize;
+    if (is_compressed) {
+        const u64 begin = compressed_block_offsets[block_index];
+        std::vector<u8> compressed(compressed_block_offsets[block_index + 1] - begin);
+        {
+            std::lock_guard lock{file_mutex};
+            file.Seek(begin, SEEK_SET);
+            compressed.resize(file.ReadBytes(compressed.data(), compressed.size()));
+        }
+        auto block = std::make_shared<Block>(Common::Compression::DecompressDataZSTD(compressed));
+        block->resize(std::min(block->size(), data_size - offset));
+        return block;
+    }
+
+    auto block = std::make_shared<Block>(std::min(BlockSize, data_size - offset));
+    block->resize(ReadUncached(offset, block->size(), block->data()));
+    return block;
+}
+
+std::size_t RomFSReader::ReadUncached(std::size_t offset, std::size_t length, u8* buffer) {
+    std::size_t read_length;
+    {
+        std::lock_guard lock{file_mutex};
+        file.Seek(file_offset + offset, SEEK_SET);
+        read_length = file.ReadBytes(buffer, length);
+    }
+    if (is_encrypted && read_length != 0) {
+        Decrypt(offset, read_length, buffer);
     }
     return read_length;
 }
 
+void RomFSReader::Decrypt(std::size_t offset, std::size_t length, u8* buffer) const {
+    // Crypto++ picks the AES-NI implementation on its own when the host supports it, and
+    // processing a whole block per cipher object amortizes the key schedule.
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
+    d.Seek(crypto_offset + offset);
+    d.ProcessData(buffer, buffer, length);
+}
+
+std::shared_ptr<const RomFSReader::Block> RomFSReader::FindCachedBlock(std::size_t block_index) {
+    std::lock_guard lock{cache_mutex};
+    const auto it = cache.find(block_index);
+    if (it == cache.end()) {
+        return nullptr;
+    }
+    lru_list.splice(lru_list.begin(), lru_list, it->second.lru_position);
+    return it->second.block;
+}
+
+void RomFSReader::InsertBlock(std::size_t block_index, std::shared_ptr<const Block> block) {
+    std::lock_guard lock{cache_mutex};
+    if (cache.count(block_index) != 0) {
+        return;
+    }
+    lru_list.push_front(block_index);
+    cache_size += block->size();
+    cache.emplace(block_index, CacheEntry{std::move(block), lru_list.begin()});
+    EvictBlocks();
+}
+
+void RomFSReader::EvictBlocks() {
+    while (cache_size > cache_capacity && !lru_list.empty()) {
+        const auto it = cache.find(lru_list.back());
+        cache_size -= it->second.block->size();
+        cache.erase(it);
+        lru_list.pop_back();
+    }
+}
+
+void RomFSReader::RequestReadAhead(std::size_t block_index) {
+    if (block_index * BlockSize >= data_size) {
+        return;
+    }
+    {
+        std::lock_guard lock{cache_mutex};
+        if (cache.count(block_index) != 0) {
+            return;
+        }
+        read_ahead_block = block_index;
+        if (!read_ahead_thread.joinable()) {
+            read_ahead_thread = std::thread(&RomFSReader::ReadAheadThread, this);
+        }
+    }
+    read_ahead_cv.notify_one();
+}
+
+void RomFSReader::ReadAheadThread() {
+    while (true) {
+        std::size_t block_index;
+        {
+            std::unique_lock lock{cache_mutex};
+            read_ahead_cv.wait(lock, [this] { return stop_read_ahead || read_ahead_block; });
+            if (stop_read_ahead) {
+                return;
+            }
+            block_index = *read_ahead_block;
+            read_ahead_block.reset();
+        }
+        GetBlock(block_index);
+    }
+}
+
 } // namespace FileSys
@@ -1,22 +1,50 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
 
 namespace FileSys {
 
+/**
+ * Reads (and decrypts, if needed) data from a RomFS image. Data is read from the host file in
+ * fixed-size blocks which are kept decrypted in an LRU cache, and blocks following a sequential
+ * read are fetched ahead of time on a background thread.
+ */
 class RomFSReader {
 public:
-    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                 const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                std::size_t crypto_offset);
+
+    ~RomFSReader();
+
+    /**
+     * Opens a RomFS image previously written by WriteCompressedImage.
+     * @return The reader, or nullptr if the file is missing or invalid
+     */
+    static std::shared_ptr<RomFSReader> OpenCompressedImage(const std::string& path);
+
+    /**
+     * Writes the decrypted contents of this RomFS as a zstd-compressed image with a per-block
+     * index, so that it can be read back with random access through OpenCompressedImage.
+     * @param is_cancelled checked between blocks, the write is abandoned once it returns true
+     * @return true on success
+     */
+    bool WriteCompressedImage(const std::string& path,
+                              const std::function<bool()>& is_cancelled = {});
 
     std::size_t GetSize() const {
         return data_size;
@@ -24,14 +52,61 @@ public:
 
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer);
 
+    /// Sets the maximum number of bytes of decrypted data kept in the block cache
+    void SetCacheCapacity(std::size_t capacity);
+
+    static constexpr std::size_t BlockSize = 0x10000;
+    static constexpr std::size_t DefaultCacheCapacity = 0x800000;
+
 private:
+    using Block = std::vector<u8>;
+
+    RomFSReader(FileUtil::IOFile&& file, std::size_t data_size, std::vector<u64>&& block_offsets);
+
+    /// Returns the requested block, loading it from the file if it isn't cached
+    std::shared_ptr<const Block> GetBlock(std::size_t block_index);
+    /// Reads and decrypts the requested block from the file
+    std::shared_ptr<const Block> LoadBlock(std::size_t block_index);
+    /// Reads and decrypts data from the file without going through the cache
+    std::size_t ReadUncached(std::size_t offset, std::size_t length, u8* buffer);
+    void Decrypt(std::size_t offset, std::size_t length, u8* buffer) const;
+
+    std::shared_ptr<const Block> FindCachedBlock(std::size_t block_index);
+    void InsertBlock(std::size_t block_index, std::shared_ptr<const Block> block);
+    void EvictBlocks();
+
+    void RequestReadAhead(std::size_t block_index);
+    void ReadAheadThread();
+
     bool is_encrypted;
+    bool is_compressed = false;
+    /// File offsets of each compressed block, followed by the end offset of the last block
+    std::vector<u64> compressed_block_offsets;
+    std::mutex file_mutex; ///< Guards the file position
     FileUtil::IOFile file;
     std::array<u8, 16> key;
     std::array<u8, 16> ctr;
     std::size_t file_offset;
     std::size_t crypto_offset;
     std::size_t data_size;
+
+    struct CacheEntry {
+        std::shared_ptr<const Block> block;
+        std::list<std::size_t>::iterator lru_position;
+    };
+
+    std::mutex cache_mutex; ///< Guards everything below
+    std::unordered_map<std::size_t, CacheEntry> cache;
+    std::list<std::size_t> lru_list; ///< Block indices, most recently used first
+    std::size_t cache_size = 0;
+    std::size_t cache_capacity = DefaultCacheCapacity;
+    /// Offset right after the end of the previous read, used to detect sequential access
+    std::size_t sequential_offset = 0;
+
+    std::thread read_ahead_thread;
+    std::condition_variable read_ahead_cv;
+    std::optional<std::size_t> read_ahead_block;
+    bool stop_read_ahead = false;
 };
 
 } // namespace FileSys
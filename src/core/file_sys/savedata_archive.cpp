@@ -91,6 +91,7 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
 
     std::unique_ptr<DelayGenerator> delay_generator = std::make_unique<SaveDataDelayGenerator>();
     auto disk_file = std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator));
+    disk_file->EnableWriteBack(full_path);
     return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
 }
 
@@ -120,7 +121,7 @@ ResultCode SaveDataArchive::DeleteFile(const Path& path) const {
         break; // Expected 'success' case
     }
 
-    if (FileUtil::Delete(full_path)) {
+    if (DeleteWithWriteBack(full_path, [&] { return FileUtil::Delete(full_path); })) {
         return RESULT_SUCCESS;
     }
 
@@ -147,7 +148,7 @@ ResultCode SaveDataArchive::RenameFile(const Path& src_path, const Path& dest_pa
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    if (RenameWithWriteBack(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
 
@@ -188,7 +189,7 @@ static ResultCode DeleteDirectoryHelper(const Path& path, const std::string& mou
         break; // Expected 'success' case
     }
 
-    if (deleter(full_path)) {
+    if (DeleteWithWriteBack(full_path, [&] { return deleter(full_path); })) {
         return RESULT_SUCCESS;
     }
 
@@ -306,7 +307,7 @@ ResultCode SaveDataArchive::RenameDirectory(const Path& src_path, const Path& de
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    if (RenameWithWriteBack(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
 
@@ -160,7 +160,7 @@ BreakpointMap breakpoints_write;
 } // Anonymous namespace
 
 static Kernel::Thread* FindThreadById(int id) {
-    const auto& threads = Core::System::GetInstance().Kernel().GetThreadManager().GetThreadList();
+    const auto threads = Core::System::GetInstance().Kernel().GetThreadList();
     for (auto& thread : threads) {
         if (thread->GetThreadId() == static_cast<u32>(id)) {
             return thread.get();
@@ -414,7 +414,7 @@ static void RemoveBreakpoint(BreakpointType type, VAddr addr) {
         Core::System::GetInstance().Memory().WriteBlock(
             *Core::System::GetInstance().Kernel().GetCurrentProcess(), bp->second.addr,
             bp->second.inst.data(), bp->second.inst.size());
-        Core::CPU().ClearInstructionCache();
+        Core::System::GetInstance().ClearInstructionCache();
     }
     p.erase(addr);
 }
@@ -540,8 +540,7 @@ static void HandleQuery() {
         SendReply(target_xml);
     } else if (strncmp(query, "fThreadInfo", strlen("fThreadInfo")) == 0) {
         std::string val = "m";
-        const auto& threads =
-            Core::System::GetInstance().Kernel().GetThreadManager().GetThreadList();
+        const auto threads = Core::System::GetInstance().Kernel().GetThreadList();
         for (const auto& thread : threads) {
             val += fmt::format("{:x},", thread->GetThreadId());
         }
@@ -553,8 +552,7 @@ static void HandleQuery() {
         std::string buffer;
         buffer += "l<?xml version=\"1.0\"?>";
         buffer += "<threads>";
-        const auto& threads =
-            Core::System::GetInstance().Kernel().GetThreadManager().GetThreadList();
+        const auto threads = Core::System::GetInstance().Kernel().GetThreadList();
         for (const auto& thread : threads) {
             buffer += fmt::format(R"*(<thread id="{:x}" name="Thread {:x}"></thread>)*",
                                   thread->GetThreadId(), thread->GetThreadId());
@@ -869,7 +867,7 @@ static void WriteMemory() {
     GdbHexToMem(data.data(), len_pos + 1, len);
     Core::System::GetInstance().Memory().WriteBlock(
         *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, data.data(), len);
-    Core::CPU().ClearInstructionCache();
+    Core::System::GetInstance().ClearInstructionCache();
     SendReply("OK");
 }
 
@@ -888,7 +886,7 @@ static void Step() {
     step_loop = true;
     halt_loop = true;
     send_trap = true;
-    Core::CPU().ClearInstructionCache();
+    Core::System::GetInstance().ClearInstructionCache();
 }
 
 bool IsMemoryBreak() {
@@ -904,7 +902,7 @@ static void Continue() {
     memory_break = false;
     step_loop = false;
     halt_loop = false;
-    Core::CPU().ClearInstructionCache();
+    Core::System::GetInstance().ClearInstructionCache();
 }
 
 /**
@@ -930,7 +928,7 @@ static bool CommitBreakpoint(BreakpointType type, VAddr addr, u32 len) {
         Core::System::GetInstance().Memory().WriteBlock(
             *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, btrap.data(),
             btrap.size());
-        Core::CPU().ClearInstructionCache();
+        Core::System::GetInstance().ClearInstructionCache();
     }
     p.insert({addr, breakpoint});
 
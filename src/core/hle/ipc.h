@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include "common/common_types.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/thread.h"
@@ -65,6 +66,16 @@ inline u32 MakeHeader(u16 command_id, unsigned int normal_params_size,
     return header.raw;
 }
 
+/**
+ * Gets the size in words of a command, including its header, from its header. Headers can describe
+ * commands of up to 127 words, so the size is clamped to the command buffer area.
+ */
+inline std::size_t GetCommandSize(u32 raw_header) {
+    const Header header{raw_header};
+    return std::min<std::size_t>(1u + header.normal_params_size + header.translate_params_size,
+                                 COMMAND_BUFFER_LENGTH);
+}
+
 constexpr u32 MoveHandleDesc(u32 num_handles = 1) {
     return MoveHandle | ((num_handles - 1) << 26);
 }
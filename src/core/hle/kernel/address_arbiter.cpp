@@ -2,7 +2,6 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <algorithm>
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hle/kernel/address_arbiter.h"
@@ -18,55 +17,68 @@ namespace Kernel {
 
 void AddressArbiter::WaitThread(std::shared_ptr<Thread> thread, VAddr wait_address) {
     thread->wait_address = wait_address;
+    thread->wait_arbiter = this;
     thread->status = ThreadStatus::WaitArb;
-    waiting_threads.emplace_back(std::move(thread));
+    waiting_threads[wait_address].Add(std::move(thread));
 }
 
 void AddressArbiter::ResumeAllThreads(VAddr address) {
     // Determine which threads are waiting on this address, those should be woken up.
-    auto itr = std::stable_partition(waiting_threads.begin(), waiting_threads.end(),
-                                     [address](const auto& thread) {
-                                         ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                                                    "Inconsistent AddressArbiter state");
-                                         return thread->wait_address != address;
-                                     });
-
-    // Wake up all the found threads
-    std::for_each(itr, waiting_threads.end(), [](auto& thread) { thread->ResumeFromWait(); });
-
-    // Remove the woken up threads from the wait list.
-    waiting_threads.erase(itr, waiting_threads.end());
+    const auto itr = waiting_threads.find(address);
+    if (itr == waiting_threads.end())
+        return;
+
+    // Wake up all the found threads, in priority order, and remove them from the wait list.
+    while (auto thread = itr->second.PopFirst()) {
+        ASSERT_MSG(thread->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
+        thread->wait_arbiter = nullptr;
+        thread->ResumeFromWait();
+    }
+    waiting_threads.erase(itr);
 }
 
 std::shared_ptr<Thread> AddressArbiter::ResumeHighestPriorityThread(VAddr address) {
-    // Determine which threads are waiting on this address, those should be considered for wakeup.
-    auto matches_start = std::stable_partition(
-        waiting_threads.begin(), waiting_threads.end(), [address](const auto& thread) {
-            ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                       "Inconsistent AddressArbiter state");
-            return thread->wait_address != address;
-        });
-
-    // Iterate through threads, find highest priority thread that is waiting to be arbitrated.
-    // Note: The real kernel will pick the first thread in the list if more than one have the
-    // same highest priority value. Lower priority values mean higher priority.
-    auto itr = std::min_element(matches_start, waiting_threads.end(),
-                                [](const auto& lhs, const auto& rhs) {
-                                    return lhs->current_priority < rhs->current_priority;
-                                });
-
+    const auto itr = waiting_threads.find(address);
     if (itr == waiting_threads.end())
         return nullptr;
 
-    auto thread = *itr;
-    thread->ResumeFromWait();
+    // The threads waiting on an address are ordered by priority, and in the order they started
+    // waiting within a priority, which matches the real kernel picking the first thread in the
+    // list if more than one have the same highest priority value.
+    auto thread = itr->second.PopFirst();
+    if (itr->second.IsEmpty())
+        waiting_threads.erase(itr);
 
-    waiting_threads.erase(itr);
+    ASSERT_MSG(thread->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
+    thread->wait_arbiter = nullptr;
+    thread->ResumeFromWait();
     return thread;
 }
 
+void AddressArbiter::RemoveWaitingThread(Thread* thread) {
+    const auto itr = waiting_threads.find(thread->wait_address);
+    if (itr == waiting_threads.end())
+        return;
+
+    itr->second.Remove(thread);
+    if (itr->second.IsEmpty())
+        waiting_threads.erase(itr);
+}
+
+void AddressArbiter::RequeueWaitingThread(Thread* thread) {
+    const auto itr = waiting_threads.find(thread->wait_address);
+    if (itr != waiting_threads.end())
+        itr->second.Requeue(thread);
+}
+
 AddressArbiter::AddressArbiter(KernelSystem& kernel) : Object(kernel), kernel(kernel) {}
-AddressArbiter::~AddressArbiter() {}
+AddressArbiter::~AddressArbiter() {
+    // Threads still waiting on a closed arbiter keep waiting, but must no longer refer to it
+    for (const auto& [address, threads] : waiting_threads) {
+        for (const auto& [priority, thread] : threads)
+            thread->wait_arbiter = nullptr;
+    }
+}
 
 std::shared_ptr<AddressArbiter> KernelSystem::CreateAddressArbiter(std::string name) {
     auto address_arbiter{std::make_shared<AddressArbiter>(*this)};
@@ -79,12 +91,15 @@ std::shared_ptr<AddressArbiter> KernelSystem::CreateAddressArbiter(std::string n
 ResultCode AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type,
                                             VAddr address, s32 value, u64 nanoseconds) {
 
-    auto timeout_callback = [this](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
-                                   std::shared_ptr<WaitObject> object) {
+    auto timeout_callback = [](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                               std::shared_ptr<WaitObject> object) {
         ASSERT(reason == ThreadWakeupReason::Timeout);
-        // Remove the newly-awakened thread from the Arbiter's waiting list.
-        waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
-                              waiting_threads.end());
+        // Remove the newly-awakened thread from the Arbiter's waiting list. The arbiter may have
+        // been closed while the thread was waiting.
+        if (thread->wait_arbiter) {
+            thread->wait_arbiter->RemoveWaitingThread(thread.get());
+            thread->wait_arbiter = nullptr;
+        }
     };
 
     switch (type) {
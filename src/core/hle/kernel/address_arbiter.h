@@ -5,9 +5,10 @@
 #pragma once
 
 #include <memory>
-#include <vector>
+#include <unordered_map>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
 // Address arbiters are an underlying kernel synchronization object that can be created/used via
@@ -52,6 +53,12 @@ public:
     ResultCode ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type, VAddr address,
                                 s32 value, u64 nanoseconds);
 
+    /// Removes a thread from the threads waiting on this address arbiter, if it is waiting on it
+    void RemoveWaitingThread(Thread* thread);
+
+    /// Moves a waiting thread to its new position after its priority changed
+    void RequeueWaitingThread(Thread* thread);
+
 private:
     KernelSystem& kernel;
 
@@ -65,8 +72,8 @@ private:
     /// the resumed thread.
     std::shared_ptr<Thread> ResumeHighestPriorityThread(VAddr address);
 
-    /// Threads waiting for the address arbiter to be signaled.
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    /// Threads waiting for the address arbiter to be signaled, by arbitration address.
+    std::unordered_map<VAddr, ThreadWaitQueue> waiting_threads;
 };
 
 } // namespace Kernel
@@ -0,0 +1,124 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "core/hle/kernel/call_profiler.h"
+
+namespace Kernel {
+
+namespace {
+
+/// Escapes a string to be written between double quotes in JSON
+std::string EscapeJSON(const std::string& string) {
+    std::string escaped;
+    escaped.reserve(string.size());
+    for (const char c : string) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+/// Quotes a CSV field if it contains a separator, a quote or a line break
+std::string EscapeCSV(const std::string& field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos)
+        return field;
+    return '"' + Common::ReplaceAll(field, "\"", "\"\"") + '"';
+}
+
+} // Anonymous namespace
+
+CallCounters& CallProfiler::GetServiceCounters(const void* service,
+                                               const std::string& service_name,
+                                               const char* function_name, u32 header) {
+    auto [it, inserted] = service_commands.try_emplace({service, header});
+    if (inserted) {
+        it->second.service_name = service_name;
+        it->second.function_name = function_name ? function_name : "";
+    }
+    return it->second.counters;
+}
+
+std::string CallProfiler::ToJSON() const {
+    std::string svcs_json;
+    for (std::size_t id = 0; id < svcs.size(); ++id) {
+        const SVCEntry& entry = svcs[id];
+        if (entry.counters.calls == 0)
+            continue;
+
+        if (!svcs_json.empty())
+            svcs_json += ",\n";
+        svcs_json += fmt::format(
+            R"(    {{"id": {}, "name": "{}", "calls": {}, "host_ns": {}, "cycles_slept": {}}})", id,
+            EscapeJSON(entry.name ? entry.name : ""), entry.counters.calls,
+            entry.counters.host_ns, entry.counters.cycles_slept);
+    }
+
+    std::string commands_json;
+    for (const auto& [key, entry] : service_commands) {
+        if (entry.counters.calls == 0)
+            continue;
+
+        if (!commands_json.empty())
+            commands_json += ",\n";
+        commands_json += fmt::format(
+            R"(    {{"service": "{}", "command": "{}", "header": "0x{:08X}", "calls": {}, )"
+            R"("host_ns": {}, "cycles_slept": {}}})",
+            EscapeJSON(entry.service_name), EscapeJSON(entry.function_name), key.second,
+            entry.counters.calls, entry.counters.host_ns, entry.counters.cycles_slept);
+    }
+
+    return fmt::format("{{\n  \"svcs\": [\n{}\n  ],\n  \"service_commands\": [\n{}\n  ]\n}}\n",
+                       svcs_json, commands_json);
+}
+
+std::string CallProfiler::ToCSV() const {
+    std::string csv = "kind,service,name,id,calls,host_ns,cycles_slept\n";
+
+    for (std::size_t id = 0; id < svcs.size(); ++id) {
+        const SVCEntry& entry = svcs[id];
+        if (entry.counters.calls == 0)
+            continue;
+
+        csv += fmt::format("svc,,{},0x{:02X},{},{},{}\n", EscapeCSV(entry.name ? entry.name : ""),
+                           id, entry.counters.calls, entry.counters.host_ns,
+                           entry.counters.cycles_slept);
+    }
+
+    for (const auto& [key, entry] : service_commands) {
+        if (entry.counters.calls == 0)
+            continue;
+
+        csv += fmt::format("service,{},{},0x{:08X},{},{},{}\n", EscapeCSV(entry.service_name),
+                           EscapeCSV(entry.function_name), key.second, entry.counters.calls,
+                           entry.counters.host_ns, entry.counters.cycles_slept);
+    }
+
+    return csv;
+}
+
+bool CallProfiler::Dump(const std::string& path) const {
+    std::string extension;
+    Common::SplitPath(path, nullptr, nullptr, &extension);
+    const std::string contents = Common::ToLower(extension) == ".csv" ? ToCSV() : ToJSON();
+
+    if (FileUtil::WriteStringToFile(false, path, contents) != contents.size()) {
+        LOG_ERROR(Kernel, "Failed to write the call counters to {}", path);
+        return false;
+    }
+
+    LOG_INFO(Kernel, "Wrote the call counters to {}", path);
+    return true;
+}
+
+} // namespace Kernel
@@ -0,0 +1,112 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include "common/common_types.h"
+
+namespace Kernel {
+
+/// Counters of one kind of call into the HLE kernel or an HLE service
+struct CallCounters {
+    u64 calls = 0;
+    /// Host time spent handling the calls
+    u64 host_ns = 0;
+    /// Emulated cycles the calling threads were put to sleep for by the calls
+    u64 cycles_slept = 0;
+};
+
+/**
+ * Always-on counters of the SVCs and HLE service commands called by the emulated software, to
+ * find out which ones take up the most time.
+ */
+class CallProfiler {
+public:
+    /// Accounts a call to a set of counters for as long as it is alive
+    class Scope {
+    public:
+        Scope(CallProfiler& profiler, CallCounters& counters)
+            : profiler(profiler), counters(counters), previous(profiler.current),
+              start(std::chrono::steady_clock::now()) {
+            profiler.current = &counters;
+        }
+
+        ~Scope() {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            counters.host_ns += static_cast<u64>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            ++counters.calls;
+            profiler.current = previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        CallProfiler& profiler;
+        CallCounters& counters;
+        CallCounters* previous;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// Gets the counters of an SVC
+    CallCounters& GetSVCCounters(u32 id, const char* name) {
+        SVCEntry& entry = svcs[id & 0x7F];
+        entry.name = name;
+        return entry.counters;
+    }
+
+    /**
+     * Gets the counters of a service command.
+     * @param service Identifies the service instance handling the command
+     * @param service_name Name of the service, only read the first time the command is called
+     * @param function_name Name of the command, only read the first time the command is called
+     * @param header Header of the command
+     */
+    CallCounters& GetServiceCounters(const void* service, const std::string& service_name,
+                                     const char* function_name, u32 header);
+
+    /// Accounts a sleep of the calling thread to the call currently being handled, if any
+    void AddCyclesSlept(s64 cycles) {
+        if (current != nullptr && cycles > 0)
+            current->cycles_slept += static_cast<u64>(cycles);
+    }
+
+    /// Formats the counters of the calls that were made at least once as JSON
+    std::string ToJSON() const;
+
+    /// Formats the counters of the calls that were made at least once as CSV
+    std::string ToCSV() const;
+
+    /**
+     * Writes the counters to a file, as CSV if its extension is ".csv" and as JSON otherwise.
+     * @return Whether the file could be written
+     */
+    bool Dump(const std::string& path) const;
+
+private:
+    struct SVCEntry {
+        const char* name = nullptr;
+        CallCounters counters;
+    };
+
+    struct ServiceCommandEntry {
+        std::string service_name;
+        std::string function_name;
+        CallCounters counters;
+    };
+
+    std::array<SVCEntry, 0x80> svcs{};
+    std::map<std::pair<const void*, u32>, ServiceCommandEntry> service_commands;
+
+    /// Counters of the innermost call being handled
+    CallCounters* current = nullptr;
+};
+
+} // namespace Kernel
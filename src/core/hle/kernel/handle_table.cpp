@@ -78,7 +78,16 @@ bool HandleTable::IsValid(Handle handle) const {
     std::size_t slot = GetSlot(handle);
     u16 generation = GetGeneration(handle);
 
-    return slot < MAX_COUNT && objects[slot] != nullptr && generations[slot] == generation;
+    if (slot >= MAX_COUNT || objects[slot] == nullptr)
+        return false;
+
+    if (generations[slot] != generation) {
+        LOG_DEBUG(Kernel, "Stale handle {:08X} used, its slot now holds generation {:04X}", handle,
+                  generations[slot]);
+        return false;
+    }
+
+    return true;
 }
 
 std::shared_ptr<Object> HandleTable::GetGeneric(Handle handle) const {
@@ -94,6 +103,19 @@ std::shared_ptr<Object> HandleTable::GetGeneric(Handle handle) const {
     return objects[GetSlot(handle)];
 }
 
+Object* HandleTable::BorrowGeneric(Handle handle) const {
+    if (handle == CurrentThread) {
+        return kernel.GetThreadManager().GetCurrentThread();
+    } else if (handle == CurrentProcess) {
+        return kernel.GetCurrentProcess().get();
+    }
+
+    if (!IsValid(handle)) {
+        return nullptr;
+    }
+    return objects[GetSlot(handle)].get();
+}
+
 void HandleTable::Clear() {
     for (u16 i = 0; i < MAX_COUNT; ++i) {
         generations[i] = i + 1;
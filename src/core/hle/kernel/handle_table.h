@@ -87,6 +87,25 @@ public:
         return DynamicObjectCast<T>(GetGeneric(handle));
     }
 
+    /**
+     * Looks up a handle without taking a reference to the object, which avoids the atomic
+     * reference count updates of `GetGeneric()`. The object is only kept alive by the handle, so
+     * the pointer must not be kept past the call that looked it up, nor used after anything that
+     * could close the handle. Use `SharedFrom()` to take a reference when the object must be kept.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid.
+     */
+    Object* BorrowGeneric(Handle handle) const;
+
+    /**
+     * Looks up a handle while verifying its type, without taking a reference to the object.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid or its
+     *         type differs from the requested one.
+     */
+    template <class T>
+    T* Borrow(Handle handle) const {
+        return DynamicObjectCast<T>(BorrowGeneric(handle));
+    }
+
     /// Closes all handles held in this table.
     void Clear();
 
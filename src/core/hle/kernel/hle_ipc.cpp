@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <vector>
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -16,6 +17,20 @@
 
 namespace Kernel {
 
+namespace {
+
+/// Static buffers larger than this aren't kept around for reuse
+constexpr std::size_t MaxRecycledStaticBufferSize = 0x10000;
+
+/**
+ * Storage of the static buffers of finished requests, reused by the next requests so that
+ * translating a static buffer usually doesn't allocate. Requests are handled on the emulation
+ * thread, so this doesn't need to be shared between host threads.
+ */
+thread_local std::array<std::vector<u8>, IPC::MAX_STATIC_BUFFERS> recycled_static_buffers;
+
+} // Anonymous namespace
+
 SessionRequestHandler::SessionInfo::SessionInfo(std::shared_ptr<ServerSession> session,
                                                 std::unique_ptr<SessionDataBase> data)
     : session(std::move(session)), data(std::move(data)) {}
@@ -52,9 +67,10 @@ std::shared_ptr<Event> HLERequestContext::SleepClientThread(const std::string& r
         memory.ReadBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
                          cmd_buff.size() * sizeof(u32));
         context.WriteToOutgoingCommandBuffer(cmd_buff.data(), *process);
-        // Copy the translated command buffer back into the thread's command buffer area.
+        // Copy the translated command buffer back into the thread's command buffer area. The
+        // static buffers area is left untouched by the translation.
         memory.WriteBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
-                          cmd_buff.size() * sizeof(u32));
+                          IPC::GetCommandSize(cmd_buff[0]) * sizeof(u32));
     };
 
     auto event = kernel.CreateEvent(Kernel::ResetType::OneShot, "HLE Pause Event: " + reason);
@@ -74,7 +90,15 @@ HLERequestContext::HLERequestContext(KernelSystem& kernel, std::shared_ptr<Serve
     cmd_buf[0] = 0;
 }
 
-HLERequestContext::~HLERequestContext() = default;
+HLERequestContext::~HLERequestContext() {
+    for (std::size_t i = 0; i < static_buffers.size(); ++i) {
+        std::vector<u8>& buffer = static_buffers[i];
+        if (buffer.capacity() > recycled_static_buffers[i].capacity() &&
+            buffer.capacity() <= MaxRecycledStaticBufferSize) {
+            recycled_static_buffers[i] = std::move(buffer);
+        }
+    }
+}
 
 std::shared_ptr<Object> HLERequestContext::GetIncomingHandle(u32 id_from_cmdbuf) const {
     ASSERT(id_from_cmdbuf < request_handles.size());
@@ -148,8 +172,10 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* sr
             VAddr source_address = src_cmdbuf[i];
             IPC::StaticBufferDescInfo buffer_info{descriptor};
 
-            // Copy the input buffer into our own vector and store it.
-            std::vector<u8> data(buffer_info.size);
+            // Copy the input buffer into our own vector and store it, reusing the storage of a
+            // previous request.
+            std::vector<u8> data = std::move(recycled_static_buffers[buffer_info.buffer_id]);
+            data.resize(buffer_info.size);
             kernel.memory.ReadBlock(src_process, source_address, data.data(), data.size());
 
             AddStaticBuffer(buffer_info.buffer_id, std::move(data));
@@ -286,4 +312,16 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
     memory->WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+ResultVal<std::vector<std::pair<u8*, u32>>> MappedBuffer::GetWritableBackingBlocks(
+    std::size_t offset, std::size_t size) {
+    ASSERT(perms & IPC::W);
+    ASSERT(offset + size <= this->size);
+    const VAddr start = address + static_cast<VAddr>(offset);
+    CASCADE_RESULT(auto backing_blocks,
+                   process->vm_manager.GetBackingBlocksForRange(start, static_cast<u32>(size)));
+    Memory::RasterizerFlushVirtualRegion(start, static_cast<u32>(size),
+                                         Memory::FlushMode::Invalidate);
+    return MakeResult(std::move(backing_blocks));
+}
+
 } // namespace Kernel
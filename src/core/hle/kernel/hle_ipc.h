@@ -104,6 +104,19 @@ public:
     // interface for service
     void Read(void* dest_buffer, std::size_t offset, std::size_t size);
     void Write(const void* src_buffer, std::size_t offset, std::size_t size);
+
+    /**
+     * Gets the host memory blocks backing a range of the buffer, so that a service can write into
+     * guest memory directly instead of going through an intermediate buffer. Rasterizer cached
+     * surfaces overlapping the range are invalidated once for the whole range.
+     * @param offset Offset in bytes from the start of the buffer
+     * @param size Size in bytes of the range
+     * @return List of (pointer, size) pairs covering the range in order, or an error code if the
+     * range is not entirely backed by memory
+     */
+    ResultVal<std::vector<std::pair<u8*, u32>>> GetWritableBackingBlocks(std::size_t offset,
+                                                                         std::size_t size);
+
     std::size_t GetSize() const {
         return size;
     }
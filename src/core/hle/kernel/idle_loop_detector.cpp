@@ -0,0 +1,35 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/core_timing.h"
+#include "core/hle/kernel/idle_loop_detector.h"
+#include "core/settings.h"
+
+namespace Kernel {
+
+bool IdleLoopDetector::OnPoll(const Thread* thread, u32 pc, u32 kind) {
+    const s64 ticks = static_cast<s64>(timing.GetTicks());
+    if (thread == last_thread && pc == last_pc && kind == last_kind &&
+        ticks - last_ticks <= MaxPollInterval) {
+        ++repeats;
+    } else {
+        last_thread = thread;
+        last_pc = pc;
+        last_kind = kind;
+        repeats = 0;
+    }
+    last_ticks = ticks;
+
+    if (repeats < MinRepeats || !Settings::values.skip_idle_loops)
+        return false;
+
+    // Nothing the thread waits for can happen before the next event, so go straight to it. Keep
+    // tracking the loop so that the next slice is skipped as soon as it polls again.
+    timing.SkipIdleLoop();
+    last_ticks = static_cast<s64>(timing.GetTicks());
+    repeats = MinRepeats - 1;
+    return true;
+}
+
+} // namespace Kernel
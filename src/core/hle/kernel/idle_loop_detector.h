@@ -0,0 +1,57 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Core {
+class Timing;
+} // namespace Core
+
+namespace Kernel {
+
+class Thread;
+
+/**
+ * Detects a thread spinning on calls that can't change anything before the next scheduled event,
+ * like svcSleepThread(0) with no other thread ready or a WFE/WFI/YIELD hint. Once it repeats the
+ * same call from the same place enough times in a row, the rest of the time slice is skipped
+ * instead of being executed.
+ */
+class IdleLoopDetector {
+public:
+    explicit IdleLoopDetector(Core::Timing& timing) : timing(timing) {}
+
+    /**
+     * Accounts a call that had no side effects and didn't block the calling thread.
+     * @param thread Thread that made the call
+     * @param pc Address the call was made from
+     * @param kind Identifies the call, like the SVC number
+     * @return Whether the rest of the slice was skipped, in which case the CPU must stop running
+     */
+    bool OnPoll(const Thread* thread, u32 pc, u32 kind);
+
+    /// Forgets about the loop being tracked, after a call with side effects
+    void Reset() {
+        repeats = 0;
+        last_thread = nullptr;
+    }
+
+private:
+    /// Number of identical polls in a row, after the first, that make up an idle loop
+    static constexpr u32 MinRepeats = 8;
+    /// Most cycles there can be between two polls of an idle loop
+    static constexpr s64 MaxPollInterval = 1024;
+
+    Core::Timing& timing;
+
+    const Thread* last_thread = nullptr;
+    u32 last_pc = 0;
+    u32 last_kind = 0;
+    s64 last_ticks = 0;
+    u32 repeats = 0;
+};
+
+} // namespace Kernel
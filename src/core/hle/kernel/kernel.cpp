@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/assert.h"
+#include "core/hle/kernel/call_profiler.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/config_mem.h"
 #include "core/hle/kernel/handle_table.h"
@@ -18,15 +20,22 @@ namespace Kernel {
 
 /// Initialize the kernel
 KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing,
-                           std::function<void()> prepare_reschedule_callback, u32 system_mode)
+                           std::function<void()> prepare_reschedule_callback, u32 system_mode,
+                           u32 num_cores)
     : memory(memory), timing(timing),
       prepare_reschedule_callback(std::move(prepare_reschedule_callback)) {
+    ASSERT(num_cores > 0);
     MemoryInit(system_mode);
 
     resource_limits = std::make_unique<ResourceLimitList>(*this);
-    thread_manager = std::make_unique<ThreadManager>(*this);
+    core_processes.resize(num_cores);
+    core_page_tables.resize(num_cores);
+    for (u32 core_id = 0; core_id < num_cores; ++core_id) {
+        thread_managers.push_back(std::make_unique<ThreadManager>(*this, core_id));
+    }
     timer_manager = std::make_unique<TimerManager>(timing);
     ipc_recorder = std::make_unique<IPCDebugger::Recorder>();
+    call_profiler = std::make_unique<CallProfiler>();
 }
 
 /// Shutdown the kernel
@@ -44,33 +53,91 @@ u32 KernelSystem::GenerateObjectID() {
     return next_object_id++;
 }
 
-std::shared_ptr<Process> KernelSystem::GetCurrentProcess() const {
+u32 KernelSystem::NewThreadId() {
+    return next_thread_id++;
+}
+
+const std::shared_ptr<Process>& KernelSystem::GetCurrentProcess() const {
     return current_process;
 }
 
 void KernelSystem::SetCurrentProcess(std::shared_ptr<Process> process) {
     current_process = process;
+    core_processes[running_core_id] = process;
     SetCurrentMemoryPageTable(&process->vm_manager.page_table);
 }
 
+void KernelSystem::SetCurrentProcessForCPU(std::shared_ptr<Process> process, u32 core_id) {
+    if (core_id == running_core_id) {
+        SetCurrentProcess(std::move(process));
+    } else {
+        core_processes[core_id] = std::move(process);
+    }
+}
+
 void KernelSystem::SetCurrentMemoryPageTable(Memory::PageTable* page_table) {
     memory.SetCurrentPageTable(page_table);
-    if (current_cpu != nullptr) {
-        current_cpu->PageTableChanged(); // notify the CPU the page table in memory has changed
+
+    // Notify the CPU the page table in memory has changed, unless it already uses it, as that may
+    // flush its code cache. Changes to the entries of a page table need no notification.
+    if (current_cpu != nullptr && core_page_tables[running_core_id] != page_table) {
+        current_cpu->PageTableChanged();
+        core_page_tables[running_core_id] = page_table;
     }
 }
 
-void KernelSystem::SetCPU(std::shared_ptr<ARM_Interface> cpu) {
-    current_cpu = cpu;
-    thread_manager->SetCPU(*cpu);
+void KernelSystem::SetCPUs(std::vector<std::shared_ptr<ARM_Interface>> cpus) {
+    ASSERT(cpus.size() == thread_managers.size());
+    this->cpus = std::move(cpus);
+    for (std::size_t core_id = 0; core_id < this->cpus.size(); ++core_id) {
+        thread_managers[core_id]->SetCPU(*this->cpus[core_id]);
+        core_page_tables[core_id] = memory.GetCurrentPageTable();
+    }
+    current_cpu = this->cpus[running_core_id];
+}
+
+void KernelSystem::SetRunningCPU(u32 core_id) {
+    if (core_id == running_core_id)
+        return;
+
+    running_core_id = core_id;
+    current_cpu = cpus[core_id];
+
+    // Switch to the address space of the process the core executes, and only notify the CPU when
+    // it last ran with another page table, as that may flush its code cache
+    if (core_processes[core_id] != nullptr && core_processes[core_id] != current_process) {
+        current_process = core_processes[core_id];
+        memory.SetCurrentPageTable(&current_process->vm_manager.page_table);
+    }
+    if (core_page_tables[core_id] != memory.GetCurrentPageTable()) {
+        current_cpu->PageTableChanged();
+        core_page_tables[core_id] = memory.GetCurrentPageTable();
+    }
 }
 
 ThreadManager& KernelSystem::GetThreadManager() {
-    return *thread_manager;
+    return *thread_managers[running_core_id];
 }
 
 const ThreadManager& KernelSystem::GetThreadManager() const {
-    return *thread_manager;
+    return *thread_managers[running_core_id];
+}
+
+ThreadManager& KernelSystem::GetThreadManager(u32 core_id) {
+    return *thread_managers[core_id];
+}
+
+const ThreadManager& KernelSystem::GetThreadManager(u32 core_id) const {
+    return *thread_managers[core_id];
+}
+
+std::vector<std::shared_ptr<Thread>> KernelSystem::GetThreadList() const {
+    std::vector<std::shared_ptr<Thread>> threads;
+    for (const auto& thread_manager : thread_managers) {
+        const auto& core_threads = thread_manager->GetThreadList();
+        threads.insert(threads.end(), core_threads.begin(), core_threads.end());
+    }
+    return threads;
 }
 
 TimerManager& KernelSystem::GetTimerManager() {
@@ -97,6 +164,14 @@ const IPCDebugger::Recorder& KernelSystem::GetIPCRecorder() const {
     return *ipc_recorder;
 }
 
+CallProfiler& KernelSystem::GetCallProfiler() {
+    return *call_profiler;
+}
+
+const CallProfiler& KernelSystem::GetCallProfiler() const {
+    return *call_profiler;
+}
+
 void KernelSystem::AddNamedPort(std::string name, std::shared_ptr<ClientPort> port) {
     named_ports.emplace(std::move(name), std::move(port));
 }
@@ -39,6 +39,7 @@ class Recorder;
 namespace Kernel {
 
 class AddressArbiter;
+class CallProfiler;
 class Event;
 class Mutex;
 class CodeSet;
@@ -85,7 +86,8 @@ enum class MemoryRegion : u16 {
 class KernelSystem {
 public:
     explicit KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing,
-                          std::function<void()> prepare_reschedule_callback, u32 system_mode);
+                          std::function<void()> prepare_reschedule_callback, u32 system_mode,
+                          u32 num_cores = 1);
     ~KernelSystem();
 
     using PortPair = std::pair<std::shared_ptr<ServerPort>, std::shared_ptr<ClientPort>>;
@@ -205,19 +207,45 @@ public:
 
     u32 GenerateObjectID();
 
+    /// Creates a new thread ID, unique among the threads of every core
+    u32 NewThreadId();
+
     /// Retrieves a process from the current list of processes.
     std::shared_ptr<Process> GetProcessById(u32 process_id) const;
 
-    std::shared_ptr<Process> GetCurrentProcess() const;
+    /// Gets the process the running core is executing
+    const std::shared_ptr<Process>& GetCurrentProcess() const;
     void SetCurrentProcess(std::shared_ptr<Process> process);
 
+    /// Sets the process a core executes, which takes effect when the core starts running
+    void SetCurrentProcessForCPU(std::shared_ptr<Process> process, u32 core_id);
+
     void SetCurrentMemoryPageTable(Memory::PageTable* page_table);
 
-    void SetCPU(std::shared_ptr<ARM_Interface> cpu);
+    /// Sets the emulated CPU of each core, in core ID order
+    void SetCPUs(std::vector<std::shared_ptr<ARM_Interface>> cpus);
+
+    /// Makes a core the one whose threads and process are being executed
+    void SetRunningCPU(u32 core_id);
+
+    u32 GetRunningCoreId() const {
+        return running_core_id;
+    }
+
+    u32 GetNumCores() const {
+        return static_cast<u32>(thread_managers.size());
+    }
 
+    /// Gets the thread manager of the running core
     ThreadManager& GetThreadManager();
     const ThreadManager& GetThreadManager() const;
 
+    ThreadManager& GetThreadManager(u32 core_id);
+    const ThreadManager& GetThreadManager(u32 core_id) const;
+
+    /// Gets the threads of every core, for debug use
+    std::vector<std::shared_ptr<Thread>> GetThreadList() const;
+
     TimerManager& GetTimerManager();
     const TimerManager& GetTimerManager() const;
 
@@ -229,6 +257,9 @@ public:
     IPCDebugger::Recorder& GetIPCRecorder();
     const IPCDebugger::Recorder& GetIPCRecorder() const;
 
+    CallProfiler& GetCallProfiler();
+    const CallProfiler& GetCallProfiler() const;
+
     MemoryRegionInfo* GetMemoryRegion(MemoryRegion region);
 
     void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
@@ -245,8 +276,12 @@ public:
     /// Map of named ports managed by the kernel, which can be retrieved using the ConnectToPort
     std::unordered_map<std::string, std::shared_ptr<ClientPort>> named_ports;
 
+    /// CPU of the running core
     std::shared_ptr<ARM_Interface> current_cpu;
 
+    /// CPUs of every core, in core ID order
+    std::vector<std::shared_ptr<ARM_Interface>> cpus;
+
     Memory::MemorySystem& memory;
 
     Core::Timing& timing;
@@ -277,12 +312,23 @@ private:
 
     std::shared_ptr<Process> current_process;
 
-    std::unique_ptr<ThreadManager> thread_manager;
+    /// Process executed by each core, the one of the running core being current_process
+    std::vector<std::shared_ptr<Process>> core_processes;
+
+    /// Page table each core's CPU was last told about
+    std::vector<Memory::PageTable*> core_page_tables;
+
+    u32 running_core_id = 0;
+    u32 next_thread_id = 1;
+
+    /// Thread manager of each core, in core ID order
+    std::vector<std::unique_ptr<ThreadManager>> thread_managers;
 
     std::unique_ptr<ConfigMem::Handler> config_mem_handler;
     std::unique_ptr<SharedPage::Handler> shared_page_handler;
 
     std::unique_ptr<IPCDebugger::Recorder> ipc_recorder;
+    std::unique_ptr<CallProfiler> call_profiler;
 };
 
 } // namespace Kernel
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <map>
 #include <vector>
 #include "common/assert.h"
@@ -35,7 +36,7 @@ std::shared_ptr<Mutex> KernelSystem::CreateMutex(bool initial_locked, std::strin
 
     // Acquire mutex with current thread if initialized as locked
     if (initial_locked)
-        mutex->Acquire(thread_manager->GetCurrentThread());
+        mutex->Acquire(GetThreadManager().GetCurrentThread());
 
     return mutex;
 }
@@ -109,10 +110,8 @@ void Mutex::UpdatePriority() {
         return;
 
     u32 best_priority = ThreadPrioLowest;
-    for (auto& waiter : GetWaitingThreads()) {
-        if (waiter->current_priority < best_priority)
-            best_priority = waiter->current_priority;
-    }
+    if (const Thread* waiter = GetHighestPriorityWaitingThread())
+        best_priority = std::min(best_priority, waiter->current_priority);
 
     if (best_priority != priority) {
         priority = best_priority;
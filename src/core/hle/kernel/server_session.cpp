@@ -84,8 +84,10 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
         // wakeup callback.
         if (thread->status == Kernel::ThreadStatus::Running) {
             context.WriteToOutgoingCommandBuffer(cmd_buf.data(), *current_process);
+            // Only the command itself changes, the static buffers area is left untouched
             kernel.memory.WriteBlock(*current_process, thread->GetCommandBufferAddress(),
-                                     cmd_buf.data(), cmd_buf.size() * sizeof(u32));
+                                     cmd_buf.data(),
+                                     IPC::GetCommandSize(cmd_buf[0]) * sizeof(u32));
         }
     }
 
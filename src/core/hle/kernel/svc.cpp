@@ -13,11 +13,13 @@
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/call_profiler.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/idle_loop_detector.h"
 #include "core/hle/kernel/ipc.h"
 #include "core/hle/kernel/ipc_debugger/recorder.h"
 #include "core/hle/kernel/memory.h"
@@ -115,6 +117,9 @@ private:
     u32 GetReg(std::size_t n);
     void SetReg(std::size_t n, u32 value);
 
+    /// Skips the rest of the time slice if the calling thread is spinning on an SVC
+    void DetectIdleLoop(u32 immediate);
+
     // SVC interfaces
 
     ResultCode ControlMemory(u32* out_addr, u32 addr0, u32 addr1, u32 size, u32 operation,
@@ -279,21 +284,29 @@ void SVC::ExitProcess() {
 
     current_process->status = ProcessStatus::Exited;
 
-    // Stop all the process threads that are currently waiting for objects.
-    auto& thread_list = kernel.GetThreadManager().GetThreadList();
-    for (auto& thread : thread_list) {
-        if (thread->owner_process != current_process.get())
-            continue;
-
-        if (thread.get() == kernel.GetThreadManager().GetCurrentThread())
-            continue;
+    // Stop all the process threads that are currently waiting for objects, on every core.
+    for (u32 core_id = 0; core_id < kernel.GetNumCores(); ++core_id) {
+        ThreadManager& thread_manager = kernel.GetThreadManager(core_id);
+        for (auto& thread : thread_manager.GetThreadList()) {
+            if (thread->owner_process != current_process.get())
+                continue;
+
+            if (thread.get() == thread_manager.GetCurrentThread()) {
+                // Stop threads running on another core, which switches away when it next runs
+                if (core_id != kernel.GetRunningCoreId()) {
+                    thread->Stop();
+                    thread_manager.RequestReschedule();
+                }
+                continue;
+            }
 
-        // TODO(Subv): When are the other running/ready threads terminated?
-        ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
-                       thread->status == ThreadStatus::WaitSynchAll,
-                   "Exiting processes with non-waiting threads is currently unimplemented");
+            // TODO(Subv): When are the other running/ready threads terminated?
+            ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
+                           thread->status == ThreadStatus::WaitSynchAll,
+                       "Exiting processes with non-waiting threads is currently unimplemented");
 
-        thread->Stop();
+            thread->Stop();
+        }
     }
 
     // Kill the current thread
@@ -378,8 +391,7 @@ ResultCode SVC::ConnectToPort(Handle* out_handle, VAddr port_name_address) {
 
 /// Makes a blocking IPC call to an OS service.
 ResultCode SVC::SendSyncRequest(Handle handle) {
-    std::shared_ptr<ClientSession> session =
-        kernel.GetCurrentProcess()->handle_table.Get<ClientSession>(handle);
+    ClientSession* session = kernel.GetCurrentProcess()->handle_table.Borrow<ClientSession>(handle);
     if (session == nullptr) {
         return ERR_INVALID_HANDLE;
     }
@@ -391,7 +403,7 @@ ResultCode SVC::SendSyncRequest(Handle handle) {
     auto thread = SharedFrom(kernel.GetThreadManager().GetCurrentThread());
 
     if (kernel.GetIPCRecorder().IsEnabled()) {
-        kernel.GetIPCRecorder().RegisterRequest(session, thread);
+        kernel.GetIPCRecorder().RegisterRequest(SharedFrom(session), thread);
     }
 
     return session->SendSyncRequest(thread);
@@ -405,7 +417,7 @@ ResultCode SVC::CloseHandle(Handle handle) {
 
 /// Wait for a handle to synchronize, timeout after the specified nanoseconds
 ResultCode SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
-    auto object = kernel.GetCurrentProcess()->handle_table.Get<WaitObject>(handle);
+    WaitObject* object = kernel.GetCurrentProcess()->handle_table.Borrow<WaitObject>(handle);
     Thread* thread = kernel.GetThreadManager().GetCurrentThread();
 
     if (object == nullptr)
@@ -419,7 +431,7 @@ ResultCode SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
         if (nano_seconds == 0)
             return RESULT_TIMEOUT;
 
-        thread->wait_objects = {object};
+        thread->wait_objects = {SharedFrom(object)};
         object->AddWaitingThread(SharedFrom(thread));
         thread->status = ThreadStatus::WaitSynchAny;
 
@@ -770,8 +782,8 @@ ResultCode SVC::ArbitrateAddress(Handle handle, u32 address, u32 type, u32 value
     LOG_TRACE(Kernel_SVC, "called handle=0x{:08X}, address=0x{:08X}, type=0x{:08X}, value=0x{:08X}",
               handle, address, type, value);
 
-    std::shared_ptr<AddressArbiter> arbiter =
-        kernel.GetCurrentProcess()->handle_table.Get<AddressArbiter>(handle);
+    AddressArbiter* arbiter =
+        kernel.GetCurrentProcess()->handle_table.Borrow<AddressArbiter>(handle);
     if (arbiter == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -896,16 +908,23 @@ ResultCode SVC::CreateThread(Handle* out_handle, u32 entry_point, u32 arg, VAddr
     case ThreadProcessorId0:
         break;
     case ThreadProcessorIdAll:
-        LOG_INFO(Kernel_SVC,
-                 "Newly created thread is allowed to be run in any Core, unimplemented.");
+        LOG_INFO(Kernel_SVC, "Newly created thread is allowed to be run in any Core, running it "
+                             "in the AppCore (Core0).");
         break;
     case ThreadProcessorId1:
-        LOG_ERROR(Kernel_SVC,
-                  "Newly created thread must run in the SysCore (Core1), unimplemented.");
+        if (kernel.GetNumCores() <= 1) {
+            LOG_ERROR(Kernel_SVC, "Newly created thread must run in the SysCore (Core1), which "
+                                  "isn't emulated, running it in the AppCore (Core0).");
+        }
         break;
     default:
-        // TODO(bunnei): Implement support for other processor IDs
-        ASSERT_MSG(false, "Unsupported thread processor ID: {}", processor_id);
+        ASSERT_MSG(processor_id >= 0 && processor_id <= ThreadProcessorIdMax,
+                   "Unsupported thread processor ID: {}", processor_id);
+        if (static_cast<u32>(processor_id) >= kernel.GetNumCores()) {
+            LOG_ERROR(Kernel_SVC, "Newly created thread must run in Core{}, which isn't emulated, "
+                                  "running it in the AppCore (Core0).",
+                      processor_id);
+        }
         break;
     }
 
@@ -938,8 +957,7 @@ void SVC::ExitThread() {
 
 /// Gets the priority for the specified thread
 ResultCode SVC::GetThreadPriority(u32* priority, Handle handle) {
-    const std::shared_ptr<Thread> thread =
-        kernel.GetCurrentProcess()->handle_table.Get<Thread>(handle);
+    const Thread* thread = kernel.GetCurrentProcess()->handle_table.Borrow<Thread>(handle);
     if (thread == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -953,7 +971,7 @@ ResultCode SVC::SetThreadPriority(Handle handle, u32 priority) {
         return ERR_OUT_OF_RANGE;
     }
 
-    std::shared_ptr<Thread> thread = kernel.GetCurrentProcess()->handle_table.Get<Thread>(handle);
+    Thread* thread = kernel.GetCurrentProcess()->handle_table.Borrow<Thread>(handle);
     if (thread == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -991,7 +1009,7 @@ ResultCode SVC::CreateMutex(Handle* out_handle, u32 initial_locked) {
 ResultCode SVC::ReleaseMutex(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called handle=0x{:08X}", handle);
 
-    std::shared_ptr<Mutex> mutex = kernel.GetCurrentProcess()->handle_table.Get<Mutex>(handle);
+    Mutex* mutex = kernel.GetCurrentProcess()->handle_table.Borrow<Mutex>(handle);
     if (mutex == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1002,8 +1020,8 @@ ResultCode SVC::ReleaseMutex(Handle handle) {
 ResultCode SVC::GetProcessId(u32* process_id, Handle process_handle) {
     LOG_TRACE(Kernel_SVC, "called process=0x{:08X}", process_handle);
 
-    const std::shared_ptr<Process> process =
-        kernel.GetCurrentProcess()->handle_table.Get<Process>(process_handle);
+    const Process* process =
+        kernel.GetCurrentProcess()->handle_table.Borrow<Process>(process_handle);
     if (process == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1015,12 +1033,11 @@ ResultCode SVC::GetProcessId(u32* process_id, Handle process_handle) {
 ResultCode SVC::GetProcessIdOfThread(u32* process_id, Handle thread_handle) {
     LOG_TRACE(Kernel_SVC, "called thread=0x{:08X}", thread_handle);
 
-    const std::shared_ptr<Thread> thread =
-        kernel.GetCurrentProcess()->handle_table.Get<Thread>(thread_handle);
+    const Thread* thread = kernel.GetCurrentProcess()->handle_table.Borrow<Thread>(thread_handle);
     if (thread == nullptr)
         return ERR_INVALID_HANDLE;
 
-    const std::shared_ptr<Process> process = SharedFrom(thread->owner_process);
+    const Process* process = thread->owner_process;
 
     ASSERT_MSG(process != nullptr, "Invalid parent process for thread={:#010X}", thread_handle);
 
@@ -1032,8 +1049,7 @@ ResultCode SVC::GetProcessIdOfThread(u32* process_id, Handle thread_handle) {
 ResultCode SVC::GetThreadId(u32* thread_id, Handle handle) {
     LOG_TRACE(Kernel_SVC, "called thread=0x{:08X}", handle);
 
-    const std::shared_ptr<Thread> thread =
-        kernel.GetCurrentProcess()->handle_table.Get<Thread>(handle);
+    const Thread* thread = kernel.GetCurrentProcess()->handle_table.Borrow<Thread>(handle);
     if (thread == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1058,8 +1074,7 @@ ResultCode SVC::CreateSemaphore(Handle* out_handle, s32 initial_count, s32 max_c
 ResultCode SVC::ReleaseSemaphore(s32* count, Handle handle, s32 release_count) {
     LOG_TRACE(Kernel_SVC, "called release_count={}, handle=0x{:08X}", release_count, handle);
 
-    std::shared_ptr<Semaphore> semaphore =
-        kernel.GetCurrentProcess()->handle_table.Get<Semaphore>(handle);
+    Semaphore* semaphore = kernel.GetCurrentProcess()->handle_table.Borrow<Semaphore>(handle);
     if (semaphore == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1135,7 +1150,7 @@ ResultCode SVC::DuplicateHandle(Handle* out, Handle handle) {
 ResultCode SVC::SignalEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcess()->handle_table.Borrow<Event>(handle);
     if (evt == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1148,7 +1163,7 @@ ResultCode SVC::SignalEvent(Handle handle) {
 ResultCode SVC::ClearEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcess()->handle_table.Borrow<Event>(handle);
     if (evt == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1171,7 +1186,7 @@ ResultCode SVC::CreateTimer(Handle* out_handle, u32 reset_type) {
 ResultCode SVC::ClearTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.Borrow<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1187,7 +1202,7 @@ ResultCode SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
         return ERR_OUT_OF_RANGE_KERNEL;
     }
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.Borrow<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1200,7 +1215,7 @@ ResultCode SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
 ResultCode SVC::CancelTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.Borrow<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1586,11 +1601,32 @@ void SVC::CallSVC(u32 immediate) {
     const FunctionDef* info = GetSVCInfo(immediate);
     if (info) {
         if (info->func) {
+            CallProfiler& profiler = kernel.GetCallProfiler();
+            CallProfiler::Scope profile_scope(profiler,
+                                              profiler.GetSVCCounters(immediate, info->name));
             (this->*(info->func))();
         } else {
             LOG_ERROR(Kernel_SVC, "unimplemented SVC function {}(..)", info->name);
         }
     }
+
+    DetectIdleLoop(immediate);
+}
+
+void SVC::DetectIdleLoop(u32 immediate) {
+    ThreadManager& thread_manager = kernel.GetThreadManager();
+    IdleLoopDetector& detector = thread_manager.GetIdleLoopDetector();
+
+    // Only a thread yielding with svcSleepThread(0) while no other thread is ready is known to
+    // wait. Zero-timeout waits, arbitrations and svcGetSystemTick are also polled by loops that
+    // do real work in between, so they aren't treated as idle.
+    if (immediate != 0x0A || thread_manager.IsReschedulePending()) {
+        detector.Reset();
+        return;
+    }
+
+    if (detector.OnPoll(thread_manager.GetCurrentThread(), system.CPU().GetPC(), immediate))
+        system.CPU().PrepareReschedule();
 }
 
 SVC::SVC(Core::System& system) : system(system), kernel(system.Kernel()), memory(system.Memory()) {}
@@ -6,6 +6,7 @@
 #include <list>
 #include <unordered_map>
 #include <vector>
+#include <fmt/format.h>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
@@ -13,6 +14,8 @@
 #include "core/arm/arm_interface.h"
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/core.h"
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/call_profiler.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/kernel.h"
@@ -33,13 +36,9 @@ void Thread::Acquire(Thread* thread) {
     ASSERT_MSG(!ShouldWait(thread), "object unavailable!");
 }
 
-u32 ThreadManager::NewThreadId() {
-    return next_thread_id++;
-}
-
-Thread::Thread(KernelSystem& kernel)
-    : WaitObject(kernel), context(kernel.GetThreadManager().NewContext()),
-      thread_manager(kernel.GetThreadManager()) {}
+Thread::Thread(KernelSystem& kernel, u32 core_id)
+    : WaitObject(kernel), context(kernel.GetThreadManager(core_id).NewContext()),
+      thread_manager(kernel.GetThreadManager(core_id)) {}
 Thread::~Thread() {}
 
 Thread* ThreadManager::GetCurrentThread() const {
@@ -57,6 +56,12 @@ void Thread::Stop() {
         thread_manager.ready_queue.remove(current_priority, this);
     }
 
+    // Clean up thread from the address arbiter it was waiting on, if any
+    if (wait_arbiter) {
+        wait_arbiter->RemoveWaitingThread(this);
+        wait_arbiter = nullptr;
+    }
+
     status = ThreadStatus::Dead;
 
     WakeupAllWaitingThreads();
@@ -184,8 +189,10 @@ void Thread::WakeAfterDelay(s64 nanoseconds) {
     if (nanoseconds == -1)
         return;
 
-    thread_manager.kernel.timing.ScheduleEvent(nsToCycles(nanoseconds),
-                                               thread_manager.ThreadWakeupEventType, thread_id);
+    const s64 cycles = nsToCycles(nanoseconds);
+    thread_manager.kernel.GetCallProfiler().AddCyclesSlept(cycles);
+    thread_manager.kernel.timing.ScheduleEvent(cycles, thread_manager.ThreadWakeupEventType,
+                                               thread_id);
 }
 
 void Thread::ResumeFromWait() {
@@ -223,6 +230,7 @@ void Thread::ResumeFromWait() {
 
     thread_manager.ready_queue.push_back(current_priority, this);
     status = ThreadStatus::Ready;
+    thread_manager.RequestReschedule();
     thread_manager.kernel.PrepareReschedule();
 }
 
@@ -309,12 +317,17 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(std::string name,
                           ErrorSummary::InvalidArgument, ErrorLevel::Permanent);
     }
 
-    auto thread{std::make_shared<Thread>(*this)};
+    // Threads of cores that aren't emulated run on the application core
+    const u32 core_id = processor_id >= 0 && static_cast<u32>(processor_id) < GetNumCores()
+                            ? static_cast<u32>(processor_id)
+                            : 0;
+    ThreadManager& thread_manager = GetThreadManager(core_id);
 
-    thread_manager->thread_list.push_back(thread);
-    thread_manager->ready_queue.prepare(priority);
+    auto thread{std::make_shared<Thread>(*this, core_id)};
 
-    thread->thread_id = thread_manager->NewThreadId();
+    thread_manager.thread_list.push_back(thread);
+
+    thread->thread_id = NewThreadId();
     thread->status = ThreadStatus::Dormant;
     thread->entry_point = entry_point;
     thread->stack_top = stack_top;
@@ -323,8 +336,9 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(std::string name,
     thread->processor_id = processor_id;
     thread->wait_objects.clear();
     thread->wait_address = 0;
+    thread->wait_arbiter = nullptr;
     thread->name = std::move(name);
-    thread_manager->wakeup_callback_table[thread->thread_id] = thread.get();
+    thread_manager.wakeup_callback_table[thread->thread_id] = thread.get();
     thread->owner_process = &owner_process;
 
     // Find the next available TLS index, and mark it as used
@@ -369,7 +383,7 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(std::string name,
     // to initialize the context
     ResetThreadContext(thread->context, stack_top, entry_point, arg);
 
-    thread_manager->ready_queue.push_back(thread->current_priority, thread.get());
+    thread_manager.ready_queue.push_back(thread->current_priority, thread.get());
     thread->status = ThreadStatus::Ready;
 
     return MakeResult<std::shared_ptr<Thread>>(std::move(thread));
@@ -381,10 +395,9 @@ void Thread::SetPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
 
     nominal_priority = current_priority = priority;
+    RequeueInWaitLists();
 }
 
 void Thread::UpdatePriority() {
@@ -400,9 +413,15 @@ void Thread::BoostPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
     current_priority = priority;
+    RequeueInWaitLists();
+}
+
+void Thread::RequeueInWaitLists() {
+    for (auto& object : wait_objects)
+        object->RequeueWaitingThread(this);
+    if (wait_arbiter)
+        wait_arbiter->RequeueWaitingThread(this);
 }
 
 std::shared_ptr<Thread> SetupMainThread(KernelSystem& kernel, u32 entry_point, u32 priority,
@@ -426,6 +445,8 @@ bool ThreadManager::HaveReadyThreads() {
 }
 
 void ThreadManager::Reschedule() {
+    reschedule_pending = false;
+
     Thread* cur = GetCurrentThread();
     Thread* next = PopNextReadyThread();
 
@@ -461,11 +482,11 @@ VAddr Thread::GetCommandBufferAddress() const {
     return GetTLSAddress() + command_header_offset;
 }
 
-ThreadManager::ThreadManager(Kernel::KernelSystem& kernel) : kernel(kernel) {
-    ThreadWakeupEventType =
-        kernel.timing.RegisterEvent("ThreadWakeupCallback", [this](u64 thread_id, s64 cycle_late) {
-            ThreadWakeupCallback(thread_id, cycle_late);
-        });
+ThreadManager::ThreadManager(Kernel::KernelSystem& kernel, u32 core_id)
+    : kernel(kernel), core_id(core_id), idle_loop_detector(kernel.timing) {
+    ThreadWakeupEventType = kernel.timing.RegisterEvent(
+        fmt::format("ThreadWakeupCallback{}", core_id),
+        [this](u64 thread_id, s64 cycle_late) { ThreadWakeupCallback(thread_id, cycle_late); });
 }
 
 ThreadManager::~ThreadManager() {
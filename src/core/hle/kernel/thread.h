@@ -13,12 +13,14 @@
 #include "common/thread_queue_list.h"
 #include "core/arm/arm_interface.h"
 #include "core/core_timing.h"
+#include "core/hle/kernel/idle_loop_detector.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
 namespace Kernel {
 
+class AddressArbiter;
 class Mutex;
 class Process;
 
@@ -57,15 +59,9 @@ enum class ThreadWakeupReason {
 
 class ThreadManager {
 public:
-    explicit ThreadManager(Kernel::KernelSystem& kernel);
+    ThreadManager(Kernel::KernelSystem& kernel, u32 core_id);
     ~ThreadManager();
 
-    /**
-     * Creates a new thread ID
-     * @return The new thread ID
-     */
-    u32 NewThreadId();
-
     /**
      * Gets the current thread
      */
@@ -76,6 +72,23 @@ public:
      */
     void Reschedule();
 
+    /// Marks this core as needing a reschedule, done the next time it stops running
+    void RequestReschedule() {
+        reschedule_pending = true;
+    }
+
+    bool IsReschedulePending() const {
+        return reschedule_pending;
+    }
+
+    u32 GetCoreId() const {
+        return core_id;
+    }
+
+    IdleLoopDetector& GetIdleLoopDetector() {
+        return idle_loop_detector;
+    }
+
     /**
      * Prints the thread queue for debugging purposes
      */
@@ -131,10 +144,12 @@ private:
 
     Kernel::KernelSystem& kernel;
     ARM_Interface* cpu;
+    u32 core_id;
 
-    u32 next_thread_id = 1;
+    bool reschedule_pending = false;
+    IdleLoopDetector idle_loop_detector;
     std::shared_ptr<Thread> current_thread;
-    Common::ThreadQueueList<Thread*, ThreadPrioLowest + 1> ready_queue;
+    Common::ThreadQueueList<Thread, ThreadPrioLowest + 1> ready_queue;
     std::unordered_map<u64, Thread*> wakeup_callback_table;
 
     /// Event type for the thread wake up event
@@ -147,9 +162,9 @@ private:
     friend class KernelSystem;
 };
 
-class Thread final : public WaitObject {
+class Thread final : public WaitObject, public Common::ThreadQueueListNode<Thread> {
 public:
-    explicit Thread(KernelSystem&);
+    Thread(KernelSystem&, u32 core_id);
     ~Thread() override;
 
     std::string GetName() const override {
@@ -293,6 +308,8 @@ public:
     std::vector<std::shared_ptr<WaitObject>> wait_objects;
 
     VAddr wait_address; ///< If waiting on an AddressArbiter, this is the arbitration address
+    /// If waiting on an AddressArbiter, this is the arbiter. Cleared when the arbiter is destroyed.
+    AddressArbiter* wait_arbiter = nullptr;
 
     std::string name;
 
@@ -304,6 +321,9 @@ public:
     std::function<WakeupCallback> wakeup_callback;
 
 private:
+    /// Moves the thread to the position matching its current priority in the lists it waits in
+    void RequeueInWaitLists();
+
     ThreadManager& thread_manager;
 };
 
@@ -44,6 +44,7 @@ VMManager::~VMManager() = default;
 
 void VMManager::Reset() {
     vma_map.clear();
+    last_found_vma = vma_map.end();
 
     // Initialize the map with a single free region covering the entire managed space.
     VirtualMemoryArea initial_vma;
@@ -59,9 +60,15 @@ void VMManager::Reset() {
 VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
     if (target >= MAX_ADDRESS) {
         return vma_map.end();
-    } else {
-        return std::prev(vma_map.upper_bound(target));
     }
+
+    if (last_found_vma != vma_map.end() &&
+        target - last_found_vma->second.base < last_found_vma->second.size) {
+        return last_found_vma;
+    }
+
+    last_found_vma = std::prev(vma_map.upper_bound(target));
+    return last_found_vma;
 }
 
 ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size, u8* memory,
@@ -153,9 +160,9 @@ ResultCode VMManager::ChangeMemoryState(VAddr target, u32 size, MemoryState expe
     CASCADE_RESULT(auto vma, CarveVMARange(target, size));
     ASSERT(vma->second.size == size);
 
+    // The page table doesn't hold the state nor the permissions, so it needs no update
     vma->second.permissions = new_perms;
     vma->second.meminfo_state = new_state;
-    UpdatePageTableForVMA(vma->second);
 
     MergeAdjacent(vma);
 
@@ -171,8 +178,6 @@ VMManager::VMAIter VMManager::Unmap(VMAIter vma_handle) {
     vma.backing_memory = nullptr;
     vma.paddr = 0;
 
-    UpdatePageTableForVMA(vma);
-
     return MergeAdjacent(vma_handle);
 }
 
@@ -187,6 +192,9 @@ ResultCode VMManager::UnmapRange(VAddr target, u32 size) {
         vma = std::next(Unmap(vma));
     }
 
+    // Update the pages of the whole range at once rather than VMA by VMA
+    memory.UnmapRegion(page_table, target, size);
+
     ASSERT(FindVMA(target)->second.size >= size);
     return RESULT_SUCCESS;
 }
@@ -194,9 +202,8 @@ ResultCode VMManager::UnmapRange(VAddr target, u32 size) {
 VMManager::VMAHandle VMManager::Reprotect(VMAHandle vma_handle, VMAPermission new_perms) {
     VMAIter iter = StripIterConstness(vma_handle);
 
-    VirtualMemoryArea& vma = iter->second;
-    vma.permissions = new_perms;
-    UpdatePageTableForVMA(vma);
+    // The page table doesn't hold the permissions, so it needs no update
+    iter->second.permissions = new_perms;
 
     return MergeAdjacent(iter);
 }
@@ -330,6 +337,7 @@ VMManager::VMAIter VMManager::MergeAdjacent(VMAIter iter) {
     const VMAIter next_vma = std::next(iter);
     if (next_vma != vma_map.end() && iter->second.CanBeMergedWith(next_vma->second)) {
         iter->second.size += next_vma->second.size;
+        last_found_vma = vma_map.end();
         vma_map.erase(next_vma);
     }
 
@@ -337,6 +345,7 @@ VMManager::VMAIter VMManager::MergeAdjacent(VMAIter iter) {
         VMAIter prev_vma = std::prev(iter);
         if (prev_vma->second.CanBeMergedWith(iter->second)) {
             prev_vma->second.size += iter->second.size;
+            last_found_vma = vma_map.end();
             vma_map.erase(iter);
             iter = prev_vma;
         }
@@ -359,8 +368,8 @@ void VMManager::UpdatePageTableForVMA(const VirtualMemoryArea& vma) {
     }
 }
 
-ResultVal<std::vector<std::pair<u8*, u32>>> VMManager::GetBackingBlocksForRange(VAddr address,
-                                                                                u32 size) {
+ResultVal<std::vector<std::pair<u8*, u32>>> VMManager::GetBackingBlocksForRange(
+    VAddr address, u32 size) const {
     std::vector<std::pair<u8*, u32>> backing_blocks;
     VAddr interval_target = address;
     while (interval_target != address + size) {
@@ -119,7 +119,10 @@ public:
     /// Clears the address space map, re-initializing with a single free area.
     void Reset();
 
-    /// Finds the VMA in which the given address is included in, or `vma_map.end()`.
+    /**
+     * Finds the VMA in which the given address is included in, or `vma_map.end()`. The last VMA
+     * found is checked first, as lookups tend to hit the same one repeatedly.
+     */
     VMAHandle FindVMA(VAddr target) const;
 
     // TODO(yuriks): Should these functions actually return the handle?
@@ -186,7 +189,8 @@ public:
     void LogLayout(Log::Level log_level) const;
 
     /// Gets a list of backing memory blocks for the specified range
-    ResultVal<std::vector<std::pair<u8*, u32>>> GetBackingBlocksForRange(VAddr address, u32 size);
+    ResultVal<std::vector<std::pair<u8*, u32>>> GetBackingBlocksForRange(VAddr address,
+                                                                         u32 size) const;
 
     /// Each VMManager has its own page table, which is set as the main one when the owning process
     /// is scheduled.
@@ -198,7 +202,7 @@ private:
     /// Converts a VMAHandle to a mutable VMAIter.
     VMAIter StripIterConstness(const VMAHandle& iter);
 
-    /// Unmaps the given VMA.
+    /// Unmaps the given VMA, leaving the page table to be updated by the caller.
     VMAIter Unmap(VMAIter vma);
 
     /**
@@ -229,5 +233,8 @@ private:
     void UpdatePageTableForVMA(const VirtualMemoryArea& vma);
 
     Memory::MemorySystem& memory;
+
+    /// VMA returned by the last FindVMA call, or `vma_map.end()`. Reset whenever a VMA is erased.
+    mutable VMAHandle last_found_vma;
 };
 } // namespace Kernel
@@ -16,56 +16,92 @@
 
 namespace Kernel {
 
+void ThreadWaitQueue::Add(std::shared_ptr<Thread> thread) {
+    const Thread* key = thread.get();
+    if (positions.count(key) != 0)
+        return;
+
+    const u32 priority = thread->current_priority;
+    // Equivalent keys are inserted at the upper bound of their range, which keeps the FIFO order
+    positions.emplace(key, threads.emplace(priority, std::move(thread)));
+}
+
+void ThreadWaitQueue::Remove(const Thread* thread) {
+    const auto position = positions.find(thread);
+    if (position == positions.end())
+        return;
+
+    threads.erase(position->second);
+    positions.erase(position);
+}
+
+void ThreadWaitQueue::Requeue(const Thread* thread) {
+    const auto position = positions.find(thread);
+    if (position == positions.end() || position->second->first == thread->current_priority)
+        return;
+
+    std::shared_ptr<Thread> shared = std::move(position->second->second);
+    threads.erase(position->second);
+    position->second = threads.emplace(thread->current_priority, std::move(shared));
+}
+
+std::shared_ptr<Thread> ThreadWaitQueue::PopFirst() {
+    if (threads.empty())
+        return nullptr;
+
+    std::shared_ptr<Thread> thread = std::move(threads.begin()->second);
+    threads.erase(threads.begin());
+    positions.erase(thread.get());
+    return thread;
+}
+
+Thread* ThreadWaitQueue::GetFirst() const {
+    return threads.empty() ? nullptr : threads.begin()->second.get();
+}
+
 void WaitObject::AddWaitingThread(std::shared_ptr<Thread> thread) {
-    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr == waiting_threads.end())
-        waiting_threads.push_back(std::move(thread));
+    waiting_threads.Add(std::move(thread));
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
-    auto itr = std::find_if(waiting_threads.begin(), waiting_threads.end(),
-                            [thread](const auto& p) { return p.get() == thread; });
     // If a thread passed multiple handles to the same object,
     // the kernel might attempt to remove the thread from the object's
     // waiting threads list multiple times.
-    if (itr != waiting_threads.end())
-        waiting_threads.erase(itr);
+    waiting_threads.Remove(thread);
+}
+
+void WaitObject::RequeueWaitingThread(Thread* thread) {
+    waiting_threads.Requeue(thread);
 }
 
 std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
-    Thread* candidate = nullptr;
-    u32 candidate_priority = ThreadPrioLowest + 1;
+    // The threads are in priority order, so the first one that can run is the best candidate
+    for (const auto& entry : waiting_threads) {
+        const std::shared_ptr<Thread>& thread = entry.second;
 
-    for (const auto& thread : waiting_threads) {
         // The list of waiting threads must not contain threads that are not waiting to be awakened.
         ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
                        thread->status == ThreadStatus::WaitSynchAll ||
                        thread->status == ThreadStatus::WaitHleEvent,
                    "Inconsistent thread statuses in waiting_threads");
 
-        if (thread->current_priority >= candidate_priority)
-            continue;
-
         if (ShouldWait(thread.get()))
             continue;
 
         // A thread is ready to run if it's either in ThreadStatus::WaitSynchAny or
         // in ThreadStatus::WaitSynchAll and the rest of the objects it is waiting on are ready.
-        bool ready_to_run = true;
-        if (thread->status == ThreadStatus::WaitSynchAll) {
-            ready_to_run = std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
-                                        [&thread](const std::shared_ptr<WaitObject>& object) {
-                                            return object->ShouldWait(thread.get());
-                                        });
+        if (thread->status == ThreadStatus::WaitSynchAll &&
+            std::any_of(thread->wait_objects.begin(), thread->wait_objects.end(),
+                        [&thread](const std::shared_ptr<WaitObject>& object) {
+                            return object->ShouldWait(thread.get());
+                        })) {
+            continue;
         }
 
-        if (ready_to_run) {
-            candidate = thread.get();
-            candidate_priority = thread->current_priority;
-        }
+        return thread;
     }
 
-    return SharedFrom(candidate);
+    return nullptr;
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
@@ -93,8 +129,15 @@ void WaitObject::WakeupAllWaitingThreads() {
         hle_notifier();
 }
 
-const std::vector<std::shared_ptr<Thread>>& WaitObject::GetWaitingThreads() const {
-    return waiting_threads;
+Thread* WaitObject::GetHighestPriorityWaitingThread() const {
+    return waiting_threads.GetFirst();
+}
+
+std::vector<std::shared_ptr<Thread>> WaitObject::GetWaitingThreads() const {
+    std::vector<std::shared_ptr<Thread>> threads;
+    for (const auto& [priority, thread] : waiting_threads)
+        threads.push_back(thread);
+    return threads;
 }
 
 void WaitObject::SetHLENotifier(std::function<void()> callback) {
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
@@ -14,6 +16,54 @@ namespace Kernel {
 
 class Thread;
 
+/**
+ * Threads waiting for something, ordered by their current priority and in FIFO order within a
+ * priority. Threads can be added, removed and requeued after a priority change in logarithmic time.
+ */
+class ThreadWaitQueue {
+public:
+    using List = std::multimap<u32, std::shared_ptr<Thread>>;
+
+    ThreadWaitQueue() = default;
+    ThreadWaitQueue(const ThreadWaitQueue&) = delete;
+    ThreadWaitQueue& operator=(const ThreadWaitQueue&) = delete;
+
+    /// Adds a thread after the ones of the same priority. Does nothing if it is already queued.
+    void Add(std::shared_ptr<Thread> thread);
+
+    /// Removes a thread. Does nothing if it isn't queued.
+    void Remove(const Thread* thread);
+
+    /// Moves a queued thread to the position matching its current priority
+    void Requeue(const Thread* thread);
+
+    /// Removes and returns the first thread, or nullptr if the queue is empty
+    std::shared_ptr<Thread> PopFirst();
+
+    /// Gets the first thread, or nullptr if the queue is empty
+    Thread* GetFirst() const;
+
+    bool Contains(const Thread* thread) const {
+        return positions.count(thread) != 0;
+    }
+
+    bool IsEmpty() const {
+        return threads.empty();
+    }
+
+    List::const_iterator begin() const {
+        return threads.begin();
+    }
+
+    List::const_iterator end() const {
+        return threads.end();
+    }
+
+private:
+    List threads;
+    std::unordered_map<const Thread*, List::iterator> positions;
+};
+
 /// Class that represents a Kernel object that a thread can be waiting on
 class WaitObject : public Object {
 public:
@@ -41,6 +91,12 @@ public:
      */
     virtual void RemoveWaitingThread(Thread* thread);
 
+    /**
+     * Moves a waiting thread to its new position after its priority changed
+     * @param thread Pointer to the thread whose priority changed
+     */
+    void RequeueWaitingThread(Thread* thread);
+
     /**
      * Wake up all threads waiting on this object that can be awoken, in priority order,
      * and set the synchronization result and output of the thread.
@@ -50,15 +106,18 @@ public:
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     std::shared_ptr<Thread> GetHighestPriorityReadyThread() const;
 
-    /// Get a const reference to the waiting threads list for debug use
-    const std::vector<std::shared_ptr<Thread>>& GetWaitingThreads() const;
+    /// Gets the waiting thread with the highest priority, whether it's ready to run or not
+    Thread* GetHighestPriorityWaitingThread() const;
+
+    /// Get a copy of the waiting threads list, in priority order, for debug use
+    std::vector<std::shared_ptr<Thread>> GetWaitingThreads() const;
 
     /// Sets a callback which is called when the object becomes available
     void SetHLENotifier(std::function<void()> callback);
 
 private:
     /// Threads waiting for this object to become available
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    ThreadWaitQueue waiting_threads;
 
     /// Function to call when this object becomes available
     std::function<void()> hle_notifier;
@@ -73,4 +132,12 @@ inline std::shared_ptr<WaitObject> DynamicObjectCast<WaitObject>(std::shared_ptr
     return nullptr;
 }
 
+template <>
+inline WaitObject* DynamicObjectCast<WaitObject>(Object* object) {
+    if (object != nullptr && object->IsWaitable()) {
+        return static_cast<WaitObject*>(object);
+    }
+    return nullptr;
+}
+
 } // namespace Kernel
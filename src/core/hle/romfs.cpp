@@ -47,10 +47,45 @@ struct FileMetadata {
 
 static_assert(sizeof(FileMetadata) == 0x20, "FileMetadata has incorrect size");
 
+constexpr u32 INVALID_FIELD = 0xFFFFFFFF;
+
 static bool MatchName(const u8* buffer, u32 name_length, const std::u16string& name) {
-    std::vector<char16_t> name_buffer(name_length / sizeof(char16_t));
-    std::memcpy(name_buffer.data(), buffer, name_length);
-    return name == std::u16string(name_buffer.begin(), name_buffer.end());
+    return name_length == name.size() * sizeof(char16_t) &&
+           std::memcmp(buffer, name.data(), name_length) == 0;
+}
+
+/**
+ * Computes the hash the RomFS directory and file hash tables are keyed on
+ * @param parent_offset Offset of the parent directory metadata in the directory table
+ * @param name The name of the directory or file
+ * @return the hash value
+ */
+static u32 CalculatePathHash(u32 parent_offset, const std::u16string& name) {
+    u32 hash = parent_offset ^ 123456789;
+    for (char16_t c : name) {
+        hash = (hash >> 5) | (hash << 27);
+        hash ^= static_cast<u16>(c);
+    }
+    return hash;
+}
+
+/**
+ * Gets the offset of the first entry in a hash table bucket
+ * @param romfs The pointer to the RomFS image
+ * @param table_offset Offset of the hash table in the RomFS image
+ * @param table_length Length in bytes of the hash table
+ * @param hash The hash value to look up
+ * @return the offset of the first entry with a matching bucket, or INVALID_FIELD
+ */
+static u32 GetHashTableEntry(const u8* romfs, u32 table_offset, u32 table_length, u32 hash) {
+    const u32 num_buckets = table_length / sizeof(u32_le);
+    if (num_buckets == 0) {
+        return INVALID_FIELD;
+    }
+    u32_le entry;
+    std::memcpy(&entry, romfs + table_offset + (hash % num_buckets) * sizeof(u32_le),
+                sizeof(entry));
+    return entry;
 }
 
 RomFSFile::RomFSFile(const u8* data, u64 length) : data(data), length(length) {}
@@ -64,47 +99,48 @@ u64 RomFSFile::Length() const {
 }
 
 const RomFSFile GetFile(const u8* romfs, const std::vector<std::u16string>& path) {
-    constexpr u32 INVALID_FIELD = 0xFFFFFFFF;
-
-    // Split path into directory names and file name
-    std::vector<std::u16string> dir_names = path;
-    dir_names.pop_back();
+    // The last path component is the file name, the others are directory names
     const std::u16string& file_name = path.back();
 
     Header header;
     std::memcpy(&header, romfs, sizeof(header));
 
-    // Find directories of each level
-    DirectoryMetadata dir;
-    const u8* current_dir = romfs + header.dir_table_offset;
-    std::memcpy(&dir, current_dir, sizeof(dir));
-    for (const std::u16string& dir_name : dir_names) {
-        u32 child_dir_offset;
-        child_dir_offset = dir.first_child_dir_offset;
+    // Find directories of each level through the directory hash table, instead of walking the
+    // sibling lists of every level
+    u32 dir_offset = 0; // root directory
+    for (auto dir_name = path.begin(); dir_name != path.end() - 1; ++dir_name) {
+        u32 child_dir_offset =
+            GetHashTableEntry(romfs, header.dir_hash_table_offset, header.dir_hash_table_length,
+                              CalculatePathHash(dir_offset, *dir_name));
         while (true) {
             if (child_dir_offset == INVALID_FIELD) {
                 return RomFSFile();
             }
+            DirectoryMetadata dir;
             const u8* current_child_dir = romfs + header.dir_table_offset + child_dir_offset;
             std::memcpy(&dir, current_child_dir, sizeof(dir));
-            if (MatchName(current_child_dir + sizeof(dir), dir.name_length, dir_name)) {
-                current_dir = current_child_dir;
+            if (dir.parent_dir_offset == dir_offset &&
+                MatchName(current_child_dir + sizeof(dir), dir.name_length, *dir_name)) {
+                dir_offset = child_dir_offset;
                 break;
             }
-            child_dir_offset = dir.next_dir_offset;
+            child_dir_offset = dir.same_hash_next_dir_offset;
         }
     }
 
     // Find the file
-    FileMetadata file;
-    u32 file_offset = dir.first_file_offset;
+    u32 file_offset =
+        GetHashTableEntry(romfs, header.file_hash_table_offset, header.file_hash_table_length,
+                          CalculatePathHash(dir_offset, file_name));
     while (file_offset != INVALID_FIELD) {
+        FileMetadata file;
         const u8* current_file = romfs + header.file_table_offset + file_offset;
         std::memcpy(&file, current_file, sizeof(file));
-        if (MatchName(current_file + sizeof(file), file.name_length, file_name)) {
+        if (file.parent_dir_offset == dir_offset &&
+            MatchName(current_file + sizeof(file), file.name_length, file_name)) {
             return RomFSFile(romfs + header.data_offset + file.data_offset, file.data_length);
         }
-        file_offset = file.next_file_offset;
+        file_offset = file.same_hash_next_file_offset;
     }
     return RomFSFile();
 }
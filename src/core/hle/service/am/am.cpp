@@ -3,15 +3,20 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstddef>
 #include <cstring>
+#include <thread>
+#include <unordered_set>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
 #include <fmt/format.h>
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/threadsafe_queue.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/ncch_container.h"
@@ -32,6 +37,7 @@
 #include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
 #include "core/loader/smdh.h"
+#include "core/title_scanner.h"
 
 namespace Service::AM {
 
@@ -79,6 +85,7 @@ static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong")
 class CIAFile::DecryptionState {
 public:
     std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    std::vector<CryptoPP::SHA256> content_hash;
 };
 
 CIAFile::CIAFile(Service::FS::MediaType media_type)
@@ -131,6 +138,7 @@ ResultCode CIAFile::WriteTitleMetadata() {
 
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
+    decryption_state->content_hash.resize(content_count);
 
     if (auto title_key = container.GetTicket().GetTitleKey()) {
         decryption_state->content.resize(content_count);
@@ -168,11 +176,15 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
 
             // Since the incoming TMD has already been written, we can use GetTitleContentPath
             // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            FileUtil::IOFile file(GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
-                                  content_written[i] ? "ab" : "wb");
+            const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
+            if (!content_file.IsOpen() || content_file_index != static_cast<std::size_t>(i)) {
+                content_file = FileUtil::IOFile(
+                    GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
+                    content_written[i] ? "ab" : "wb");
+                content_file_index = i;
+            }
 
-            if (!file.IsOpen())
+            if (!content_file.IsOpen())
                 return FileSys::ERROR_INSUFFICIENT_SPACE;
 
             std::vector<u8> temp(buffer + (range_min - offset),
@@ -183,13 +195,31 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
                 decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
             }
 
-            file.WriteBytes(temp.data(), temp.size());
+            // Hash the decrypted data while it is still in cache, rather than reading the
+            // content back once it has been installed.
+            auto& hash = decryption_state->content_hash[i];
+            hash.Update(temp.data(), temp.size());
+
+            content_file.WriteBytes(temp.data(), temp.size());
 
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
             content_written[i] += available_to_write;
             LOG_DEBUG(Service_AM, "Wrote {:x} to content {}, total {:x}", available_to_write, i,
                       content_written[i]);
+
+            if (content_written[i] == size) {
+                content_file.Close();
+
+                std::array<u8, CryptoPP::SHA256::DIGESTSIZE> digest;
+                hash.Final(digest.data());
+                if (digest != tmd.GetContentHashByIndex(static_cast<u16>(i))) {
+                    LOG_ERROR(Service_AM, "Hash mismatch for content {}, aborting install...", i);
+                    content_hash_mismatch = true;
+                    return ResultCode(ErrCodes::InvalidCIAHeader, ErrorModule::AM,
+                                      ErrorSummary::InvalidArgument, ErrorLevel::Permanent);
+                }
+            }
         }
     }
 
@@ -276,7 +306,9 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() const {
-    bool complete = true;
+    content_file.Close();
+
+    bool complete = !content_hash_mismatch;
     for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(static_cast<u16>(i)))
             complete = false;
@@ -353,23 +385,71 @@ InstallStatus InstallCIA(const std::string& path,
         FileUtil::IOFile file(path, "rb");
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
+        const std::size_t file_size = file.GetSize();
+
+        // Reading the CIA happens on a separate thread, so that the disk reads overlap with
+        // decrypting, hashing and writing out the previous chunks. Buffers cycle between the two
+        // threads through a pair of queues, which also bounds how far the reader gets ahead.
+        constexpr std::size_t ChunkSize = 0x100000;
+        constexpr std::size_t NumChunks = 4;
+        struct Chunk {
+            std::vector<u8> buffer;
+            std::size_t size = 0;
+        };
+        Common::SPSCQueue<Chunk> free_chunks;
+        Common::SPSCQueue<Chunk> read_chunks;
+        for (std::size_t i = 0; i < NumChunks; ++i) {
+            free_chunks.Push(Chunk{std::vector<u8>(ChunkSize), 0});
+        }
+
+        std::atomic<bool> stop_reading{false};
+        std::thread reader([&] {
+            std::size_t offset = 0;
+            while (offset != file_size) {
+                Chunk chunk = free_chunks.PopWait();
+                if (stop_reading)
+                    return;
+                chunk.size = file.ReadBytes(chunk.buffer.data(), chunk.buffer.size());
+                offset += chunk.size;
+                const bool failed = chunk.size == 0;
+                read_chunks.Push(std::move(chunk));
+                if (failed)
+                    return;
+            }
+        });
 
-        std::array<u8, 0x10000> buffer;
         std::size_t total_bytes_read = 0;
-        while (total_bytes_read != file.GetSize()) {
-            std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
-            auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            static_cast<u8*>(buffer.data()));
+        InstallStatus status = InstallStatus::Success;
+        while (total_bytes_read != file_size) {
+            Chunk chunk = read_chunks.PopWait();
+            if (chunk.size == 0) {
+                LOG_ERROR(Service_AM, "Failed to read CIA file {}", path);
+                status = InstallStatus::ErrorAborted;
+                break;
+            }
+
+            auto result = installFile.Write(static_cast<u64>(total_bytes_read), chunk.size, true,
+                                            chunk.buffer.data());
 
             if (update_callback)
-                update_callback(total_bytes_read, file.GetSize());
+                update_callback(total_bytes_read, file_size);
             if (result.Failed()) {
                 LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
                           result.Code().raw);
-                return InstallStatus::ErrorAborted;
+                status = InstallStatus::ErrorAborted;
+                break;
             }
-            total_bytes_read += bytes_read;
+            total_bytes_read += chunk.size;
+            free_chunks.Push(std::move(chunk));
         }
+
+        stop_reading = true;
+        free_chunks.Push(Chunk{});
+        reader.join();
+
+        if (status != InstallStatus::Success)
+            return status;
+
         installFile.Close();
 
         LOG_INFO(Service_AM, "Installed {} successfully.", path);
@@ -511,19 +591,37 @@ void Module::ScanForTitles(Service::FS::MediaType media_type) {
 
     FileUtil::FSTEntry entries;
     FileUtil::ScanDirectoryTree(title_path, entries, 1);
+
+    std::vector<u64> title_ids;
+    std::vector<std::string> content_paths;
     for (const FileUtil::FSTEntry& tid_high : entries.children) {
         for (const FileUtil::FSTEntry& tid_low : tid_high.children) {
             std::string tid_string = tid_high.virtualName + tid_low.virtualName;
 
             if (tid_string.length() == TITLE_ID_VALID_LENGTH) {
                 u64 tid = std::stoull(tid_string.c_str(), nullptr, 16);
-
-                FileSys::NCCHContainer container(GetTitleContentPath(media_type, tid));
-                if (container.Load() == Loader::ResultStatus::Success)
-                    am_title_list[static_cast<u32>(media_type)].push_back(tid);
+                title_ids.push_back(tid);
+                content_paths.push_back(GetTitleContentPath(media_type, tid));
             }
         }
     }
+
+    // Only titles whose NCCH loads are listed. The NCCH loader reads the program ID through
+    // NCCHContainer::Load, so an NCCH content has one exactly when it loads.
+    const std::vector<Core::ScannedTitle> scanned =
+        Core::TitleScanner::GetInstance().Scan(content_paths);
+    std::unordered_set<std::string> loadable_paths;
+    for (const Core::ScannedTitle& title : scanned) {
+        const bool is_ncch = title.file_type == Loader::FileType::CXI ||
+                             title.file_type == Loader::FileType::CCI;
+        if (is_ncch && title.has_program_id)
+            loadable_paths.insert(title.path);
+    }
+
+    for (std::size_t i = 0; i < title_ids.size(); ++i) {
+        if (loadable_paths.count(content_paths[i]))
+            am_title_list[static_cast<u32>(media_type)].push_back(title_ids[i]);
+    }
 }
 
 void Module::ScanForAllTitles() {
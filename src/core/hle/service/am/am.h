@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include "common/common_types.h"
+#include "common/file_util.h"
 #include "core/file_sys/cia_container.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/kernel/mutex.h"
@@ -92,6 +93,12 @@ private:
     std::vector<u64> content_written;
     Service::FS::MediaType media_type;
 
+    // Output file of the content currently being written, kept open across writes
+    mutable FileUtil::IOFile content_file;
+    std::size_t content_file_index = 0;
+    // Set when the decrypted data of a content didn't match its hash in the TMD
+    bool content_hash_mismatch = false;
+
     class DecryptionState;
     std::unique_ptr<DecryptionState> decryption_state;
 };
@@ -13,6 +13,8 @@
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "core/core.h"
+#include "core/core_timing.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/archive_extsavedata.h"
 #include "core/file_sys/archive_ncch.h"
@@ -23,6 +25,7 @@
 #include "core/file_sys/archive_selfncch.h"
 #include "core/file_sys/archive_systemsavedata.h"
 #include "core/file_sys/directory_backend.h"
+#include "core/file_sys/disk_archive.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/result.h"
@@ -259,7 +262,10 @@ ResultCode ArchiveManager::DeleteExtSaveData(MediaType media_type, u32 high, u32
     std::string base_path =
         FileSys::GetExtDataContainerPath(media_type_directory, media_type == MediaType::NAND);
     std::string extsavedata_path = FileSys::GetExtSaveDataPath(base_path, path);
-    if (FileUtil::Exists(extsavedata_path) && !FileUtil::DeleteDirRecursively(extsavedata_path))
+    if (FileUtil::Exists(extsavedata_path) &&
+        !FileSys::DeleteWithWriteBack(extsavedata_path, [&] {
+            return FileUtil::DeleteDirRecursively(extsavedata_path);
+        }))
         return ResultCode(-1); // TODO(Subv): Find the right error code
     return RESULT_SUCCESS;
 }
@@ -271,7 +277,9 @@ ResultCode ArchiveManager::DeleteSystemSaveData(u32 high, u32 low) {
     std::string nand_directory = FileUtil::GetUserPath(FileUtil::UserPath::NANDDir);
     std::string base_path = FileSys::GetSystemSaveDataContainerPath(nand_directory);
     std::string systemsavedata_path = FileSys::GetSystemSaveDataPath(base_path, path);
-    if (!FileUtil::DeleteDirRecursively(systemsavedata_path))
+    if (!FileSys::DeleteWithWriteBack(systemsavedata_path, [&] {
+            return FileUtil::DeleteDirRecursively(systemsavedata_path);
+        }))
         return ResultCode(-1); // TODO(Subv): Find the right error code
     return RESULT_SUCCESS;
 }
@@ -352,8 +360,40 @@ void ArchiveManager::RegisterSelfNCCH(Loader::AppLoader& app_loader) {
     factory->Register(app_loader);
 }
 
+void ArchiveManager::SubmitRead(std::function<ResultVal<std::size_t>()> read,
+                                std::chrono::nanoseconds delay,
+                                std::function<void(ResultVal<std::size_t>)> done) {
+    Core::Timing& timing = system.CoreTiming();
+    const u64 read_id = next_read_id++;
+    const u64 done_ticks = timing.GetTicks() + nsToCycles(static_cast<s64>(delay.count()));
+
+    auto pending = std::make_shared<PendingRead>();
+    pending->done = std::move(done);
+    pending_reads.emplace(read_id, pending);
+
+    // The I/O thread schedules the completion itself once the read is done, so that the emulation
+    // thread never has to check on it
+    io_thread_pool.Submit([&timing, event_type = read_done_event, read = std::move(read),
+                           pending = std::move(pending), read_id, done_ticks] {
+        pending->result = read();
+        timing.ScheduleEventThreadsafeAt(done_ticks, event_type, read_id);
+    });
+}
+
+void ArchiveManager::FinishRead(u64 read_id) {
+    const auto it = pending_reads.find(read_id);
+    if (it == pending_reads.end())
+        return;
+
+    const std::shared_ptr<PendingRead> pending = std::move(it->second);
+    pending_reads.erase(it);
+    pending->done(std::move(*pending->result));
+}
+
 ArchiveManager::ArchiveManager(Core::System& system) : system(system) {
     RegisterArchiveTypes();
+    read_done_event = system.CoreTiming().RegisterEvent(
+        "FS::ReadDone", [this](u64 read_id, s64 /*cycles_late*/) { FinishRead(read_id); });
 }
 
 } // namespace Service::FS
@@ -4,12 +4,16 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
+#include "common/thread_pool.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/result.h"
 #include "core/hle/service/fs/directory.h"
@@ -26,7 +30,8 @@ class AppLoader;
 
 namespace Core {
 class System;
-}
+struct TimingEventType;
+} // namespace Core
 
 namespace Service::FS {
 
@@ -233,6 +238,17 @@ public:
     /// Registers a new NCCH file with the SelfNCCH archive factory
     void RegisterSelfNCCH(Loader::AppLoader& app_loader);
 
+    /**
+     * Runs a read on the pool of host I/O threads, then calls a function with its result from the
+     * emulation thread once the read is done, but no sooner than the given delay. The emulation
+     * thread keeps running in the meantime.
+     * @param read Function doing the read, called from an I/O thread
+     * @param delay Emulated duration of the read
+     * @param done Function called from a CoreTiming event with the result of the read
+     */
+    void SubmitRead(std::function<ResultVal<std::size_t>()> read, std::chrono::nanoseconds delay,
+                    std::function<void(ResultVal<std::size_t>)> done);
+
 private:
     Core::System& system;
 
@@ -260,6 +276,21 @@ private:
      */
     std::unordered_map<ArchiveHandle, std::unique_ptr<ArchiveBackend>> handle_map;
     ArchiveHandle next_handle = 1;
+
+    struct PendingRead {
+        std::optional<ResultVal<std::size_t>> result; ///< Set by the I/O thread doing the read
+        std::function<void(ResultVal<std::size_t>)> done;
+    };
+
+    /// Passes the result of a read to its completion function, once the read and its delay are done
+    void FinishRead(u64 read_id);
+
+    std::unordered_map<u64, std::shared_ptr<PendingRead>> pending_reads;
+    u64 next_read_id = 0;
+    Core::TimingEventType* read_done_event;
+
+    /// Declared last so that pending reads are drained before any archive is destroyed
+    Common::ThreadPool io_thread_pool{2, "FS I/O"};
 };
 
 } // namespace Service::FS
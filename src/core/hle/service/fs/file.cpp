@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <optional>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
@@ -11,6 +13,7 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/file.h"
 
 namespace Service::FS {
@@ -50,27 +53,69 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     // This file session might have a specific offset from where to start reading, apply it.
     offset += file->offset;
 
-    if (offset + length > backend->GetSize()) {
-        LOG_ERROR(Service_FS,
-                  "Reading from out of bounds offset=0x{:x} length=0x{:08X} file_size=0x{:x}",
-                  offset, length, backend->GetSize());
+    std::chrono::nanoseconds read_timeout_ns;
+    {
+        std::lock_guard lock{backend_mutex};
+        if (offset + length > backend->GetSize()) {
+            LOG_ERROR(Service_FS,
+                      "Reading from out of bounds offset=0x{:x} length=0x{:08X} file_size=0x{:x}",
+                      offset, length, backend->GetSize());
+        }
+        read_timeout_ns = std::chrono::nanoseconds{backend->GetReadDelayNs(length)};
+    }
+
+    // Issue the host read right away on the I/O threads, straight into the guest memory backing
+    // the buffer, so that it overlaps with the emulated read delay. The client thread is resumed
+    // once both are done.
+    if (length <= buffer.GetSize()) {
+        auto backing_blocks = buffer.GetWritableBackingBlocks(0, length);
+        if (backing_blocks.Succeeded()) {
+            auto result = std::make_shared<std::optional<ResultVal<std::size_t>>>();
+            const auto event = ctx.SleepClientThread(
+                "file::read", std::chrono::nanoseconds{0},
+                [result, buffer_id = buffer.GetId()](std::shared_ptr<Kernel::Thread> /*thread*/,
+                                                     Kernel::HLERequestContext& ctx,
+                                                     Kernel::ThreadWakeupReason /*reason*/) {
+                    const ResultVal<std::size_t>& read = **result;
+                    IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+                    if (read.Failed()) {
+                        rb.Push(read.Code());
+                        rb.Push<u32>(0);
+                    } else {
+                        rb.Push(RESULT_SUCCESS);
+                        rb.Push<u32>(static_cast<u32>(*read));
+                    }
+                    rb.PushMappedBuffer(ctx.GetMappedBuffer(buffer_id));
+                });
+            system.ArchiveManager().SubmitRead(
+                [self = SharedFrom(this), offset, blocks = std::move(*backing_blocks)] {
+                    return self->ReadScatter(offset, blocks);
+                },
+                read_timeout_ns,
+                [result, event = std::weak_ptr<Kernel::Event>(event)](
+                    ResultVal<std::size_t> read) {
+                    *result = std::move(read);
+                    // The waiting thread may have been stopped in the meantime
+                    if (const auto locked_event = event.lock()) {
+                        locked_event->Signal();
+                    }
+                });
+            return;
+        }
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
 
-    std::vector<u8> data(length);
-    ResultVal<std::size_t> read = backend->Read(offset, data.size(), data.data());
+    ResultVal<std::size_t> read = ReadIntoBuffer(offset, length, buffer);
     if (read.Failed()) {
         rb.Push(read.Code());
         rb.Push<u32>(0);
     } else {
-        buffer.Write(data.data(), 0, *read);
         rb.Push(RESULT_SUCCESS);
         rb.Push<u32>(static_cast<u32>(*read));
     }
     rb.PushMappedBuffer(buffer);
 
-    std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
     ctx.SleepClientThread("file::read", read_timeout_ns,
                           [](std::shared_ptr<Kernel::Thread> /*thread*/,
                              Kernel::HLERequestContext& /*ctx*/,
@@ -79,6 +124,58 @@ void File::Read(Kernel::HLERequestContext& ctx) {
                           });
 }
 
+ResultVal<std::size_t> File::ReadIntoBuffer(u64 offset, u32 length,
+                                            Kernel::MappedBuffer& buffer) {
+    if (length <= buffer.GetSize()) {
+        auto backing_blocks = buffer.GetWritableBackingBlocks(0, length);
+        if (backing_blocks.Succeeded()) {
+            return ReadScatter(offset, *backing_blocks);
+        }
+    }
+
+    std::vector<u8> data(length);
+    ResultVal<std::size_t> read = [&] {
+        std::lock_guard lock{backend_mutex};
+        return backend->Read(offset, data.size(), data.data());
+    }();
+    if (read.Succeeded()) {
+        buffer.Write(data.data(), 0, *read);
+    }
+    return read;
+}
+
+ResultVal<std::size_t> File::ReadScatter(u64 offset,
+                                         const std::vector<std::pair<u8*, u32>>& blocks) {
+    std::size_t total_read = 0;
+    auto block = blocks.begin();
+    u32 block_offset = 0;
+    while (block != blocks.end()) {
+        // Gather the next slice of the blocks, splitting them where needed
+        std::vector<std::pair<u8*, u32>> slice;
+        u32 slice_size = 0;
+        while (block != blocks.end() && slice_size < LockedReadSize) {
+            const u32 size = std::min(block->second - block_offset, LockedReadSize - slice_size);
+            slice.emplace_back(block->first + block_offset, size);
+            slice_size += size;
+            block_offset += size;
+            if (block_offset == block->second) {
+                ++block;
+                block_offset = 0;
+            }
+        }
+
+        CASCADE_RESULT(std::size_t read, [&] {
+            std::lock_guard lock{backend_mutex};
+            return backend->ReadScatter(offset + total_read, slice);
+        }());
+        total_read += read;
+        if (read < slice_size) {
+            break;
+        }
+    }
+    return MakeResult(total_read);
+}
+
 void File::Write(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0803, 4, 2);
     u64 offset = rp.Pop<u64>();
@@ -102,6 +199,7 @@ void File::Write(Kernel::HLERequestContext& ctx) {
 
     std::vector<u8> data(length);
     buffer.Read(data.data(), 0, data.size());
+    std::lock_guard lock{backend_mutex};
     ResultVal<std::size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
     if (written.Failed()) {
         rb.Push(written.Code());
@@ -138,6 +236,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
     }
 
     file->size = size;
+    std::lock_guard lock{backend_mutex};
     backend->SetSize(size);
     rb.Push(RESULT_SUCCESS);
 }
@@ -150,7 +249,10 @@ void File::Close(Kernel::HLERequestContext& ctx) {
         LOG_WARNING(Service_FS, "Closing File backend but {} clients still connected",
                     connected_sessions.size());
 
-    backend->Close();
+    {
+        std::lock_guard lock{backend_mutex};
+        backend->Close();
+    }
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
 }
@@ -168,6 +270,7 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    std::lock_guard lock{backend_mutex};
     backend->Flush();
     rb.Push(RESULT_SUCCESS);
 }
@@ -205,7 +308,7 @@ void File::OpenLinkFile(Kernel::HLERequestContext& ctx) {
 
     slot->priority = original_file->priority;
     slot->offset = 0;
-    slot->size = backend->GetSize();
+    slot->size = GetBackendSize();
     slot->subfile = false;
 
     rb.Push(RESULT_SUCCESS);
@@ -263,12 +366,17 @@ std::shared_ptr<Kernel::ClientSession> File::Connect() {
     FileSessionSlot* slot = GetSessionData(server);
     slot->priority = 0;
     slot->offset = 0;
-    slot->size = backend->GetSize();
+    slot->size = GetBackendSize();
     slot->subfile = false;
 
     return client;
 }
 
+u64 File::GetBackendSize() {
+    std::lock_guard lock{backend_mutex};
+    return backend->GetSize();
+}
+
 std::size_t File::GetSessionFileOffset(std::shared_ptr<Kernel::ServerSession> session) {
     const FileSessionSlot* slot = GetSessionData(session);
     ASSERT(slot);
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/service/service.h"
 
@@ -59,7 +62,27 @@ private:
     void OpenLinkFile(Kernel::HLERequestContext& ctx);
     void OpenSubFile(Kernel::HLERequestContext& ctx);
 
+    /**
+     * Reads from the backend straight into the guest memory backing the mapped buffer, falling
+     * back to an intermediate copy if the buffer isn't entirely backed by memory.
+     */
+    ResultVal<std::size_t> ReadIntoBuffer(u64 offset, u32 length, Kernel::MappedBuffer& buffer);
+
+    /**
+     * Reads from the backend into a list of blocks, holding the backend lock for at most
+     * LockedReadSize bytes at a time. The other commands, handled on the emulation thread while
+     * an I/O thread reads, thus only ever wait for a slice of the read.
+     */
+    ResultVal<std::size_t> ReadScatter(u64 offset, const std::vector<std::pair<u8*, u32>>& blocks);
+
+    static constexpr u32 LockedReadSize = 0x10000;
+
+    u64 GetBackendSize();
+
     Core::System& system;
+
+    /// Serializes access to the backend, which may be read from the FS I/O threads
+    std::mutex backend_mutex;
 };
 
 } // namespace Service::FS
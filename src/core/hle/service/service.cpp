@@ -8,6 +8,7 @@
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
+#include "core/hle/kernel/call_profiler.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/process.h"
@@ -178,6 +179,10 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
+
+    Kernel::CallProfiler& profiler = Core::System::GetInstance().Kernel().GetCallProfiler();
+    Kernel::CallProfiler::Scope profile_scope(
+        profiler, profiler.GetServiceCounters(this, service_name, info->name, header_code));
     handler_invoker(this, info->handler_callback, context);
 }
 
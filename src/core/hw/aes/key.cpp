@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <cryptopp/aes.h>
@@ -71,11 +72,13 @@ struct KeySlot {
     }
 
     void GenerateNormalKey() {
-        if (x && y) {
-            normal = Lrot128(Add128(Xor128(Lrot128(*x, 2), *y), generator_constant), 87);
-        } else {
-            normal = {};
-        }
+        normal = DeriveNormalKey(y);
+    }
+
+    std::optional<AESKey> DeriveNormalKey(const std::optional<AESKey>& key_y) const {
+        if (x && key_y)
+            return Lrot128(Add128(Xor128(Lrot128(*x, 2), *key_y), generator_constant), 87);
+        return {};
     }
 
     void Clear() {
@@ -440,14 +443,14 @@ void LoadPresetKeys() {
 } // namespace
 
 void InitKeys() {
-    static bool initialized = false;
-    if (initialized)
-        return;
-    LoadBootromKeys();
-    LoadNativeFirmKeysOld3DS();
-    LoadNativeFirmKeysNew3DS();
-    LoadPresetKeys();
-    initialized = true;
+    // Titles can be loaded from several threads at once, e.g. by the title scanner
+    static std::once_flag initialized;
+    std::call_once(initialized, [] {
+        LoadBootromKeys();
+        LoadNativeFirmKeysOld3DS();
+        LoadNativeFirmKeysNew3DS();
+        LoadPresetKeys();
+    });
 }
 
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
@@ -470,6 +473,10 @@ AESKey GetNormalKey(std::size_t slot_id) {
     return key_slots.at(slot_id).normal.value_or(AESKey{});
 }
 
+std::optional<AESKey> DeriveNormalKey(std::size_t slot_id, const AESKey& key_y) {
+    return key_slots.at(slot_id).DeriveNormalKey(key_y);
+}
+
 void SelectCommonKeyIndex(u8 index) {
     key_slots[KeySlotID::TicketCommonKey].SetKeyY(common_key_y_slots.at(index));
 }
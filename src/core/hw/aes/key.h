@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <optional>
 #include "common/common_types.h"
 
 namespace HW::AES {
@@ -62,6 +63,12 @@ void SetNormalKey(std::size_t slot_id, const AESKey& key);
 bool IsNormalKeyAvailable(std::size_t slot_id);
 AESKey GetNormalKey(std::size_t slot_id);
 
+/**
+ * Generates the normal key of a slot from its KeyX and the given KeyY, leaving the slot untouched.
+ * @return The normal key, or nothing if the KeyX of the slot is missing
+ */
+std::optional<AESKey> DeriveNormalKey(std::size_t slot_id, const AESKey& key_y);
+
 void SelectCommonKeyIndex(u8 index);
 
 } // namespace HW::AES
@@ -3,8 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <numeric>
 #include <type_traits>
+#include <vector>
 #include "common/alignment.h"
 #include "common/color.h"
 #include "common/common_types.h"
@@ -21,6 +25,7 @@
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/utils.h"
@@ -34,6 +39,40 @@ Memory::MemorySystem* g_memory;
 /// Event id for CoreTiming
 static Core::TimingEventType* vblank_event;
 
+/// GPU work queued on the GPU thread, along with the interrupts to signal once it's done
+struct PendingWork {
+    u64 fence;
+    std::vector<Service::GSP::InterruptId> interrupts;
+};
+static std::deque<PendingWork> pending_work;
+
+/// Interrupts raised by the command lists run on the GPU thread, along with their work's fence
+static std::deque<std::pair<u64, Service::GSP::InterruptId>> pica_interrupts;
+static std::mutex pica_interrupt_mutex;
+
+/// Fence of the last buffer swap queued on the GPU thread
+static u64 last_swap_fence = 0;
+
+/**
+ * Runs some GPU work and signals the given interrupts once it's done. With asynchronous GPU
+ * emulation, the work is queued on the GPU thread and the interrupts are signaled by Update.
+ */
+static void SubmitWork(std::function<void()> work,
+                       std::vector<Service::GSP::InterruptId> interrupts = {}) {
+    if (!VideoCore::g_gpu_thread) {
+        work();
+        for (Service::GSP::InterruptId interrupt : interrupts) {
+            Service::GSP::SignalInterrupt(interrupt);
+        }
+        return;
+    }
+
+    // All the work is tracked, even without interrupts to signal, as command lists can raise
+    // interrupts of their own while running
+    const u64 fence = VideoCore::g_gpu_thread->Push(std::move(work));
+    pending_work.push_back({fence, std::move(interrupts)});
+}
+
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
     u32 addr = raw_addr - HW::VADDR_GPU;
@@ -407,19 +446,17 @@ inline void Write(u32 addr, const T data) {
         auto& config = g_regs.memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
             LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
                       config.GetEndAddress());
 
             // It seems that it won't signal interrupt if "address_start" is zero.
             // TODO: hwtest this
+            std::vector<Service::GSP::InterruptId> interrupts;
             if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
-                }
+                interrupts.push_back(is_second_filler ? Service::GSP::InterruptId::PSC1
+                                                      : Service::GSP::InterruptId::PSC0);
             }
+            SubmitWork([config = config] { MemoryFill(config); }, std::move(interrupts));
 
             // Reset "trigger" flag and set the "finish" flag
             // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
@@ -430,17 +467,25 @@ inline void Write(u32 addr, const T data) {
     }
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
-        MICROPROFILE_SCOPE(GPU_DisplayTransfer);
-
         const auto& config = g_regs.display_transfer_config;
         if (config.trigger & 1) {
-
-            if (Pica::g_debug_context)
-                Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
-                                               nullptr);
+            SubmitWork(
+                [config = config] {
+                    MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+
+                    if (Pica::g_debug_context)
+                        Pica::g_debug_context->OnEvent(
+                            Pica::DebugContext::Event::IncomingDisplayTransfer, nullptr);
+
+                    if (config.is_texture_copy) {
+                        TextureCopy(config);
+                    } else {
+                        DisplayTransfer(config);
+                    }
+                },
+                {Service::GSP::InterruptId::PPF});
 
             if (config.is_texture_copy) {
-                TextureCopy(config);
                 LOG_TRACE(HW_GPU,
                           "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
                           "{:#010X}({}+{}), flags {:#010X}",
@@ -449,7 +494,6 @@ inline void Write(u32 addr, const T data) {
                           config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
                           config.texture_copy.output_gap * 16, config.flags);
             } else {
-                DisplayTransfer(config);
                 LOG_TRACE(HW_GPU,
                           "DisplayTransfer: {:#010X}({}x{})-> "
                           "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
@@ -460,7 +504,6 @@ inline void Write(u32 addr, const T data) {
             }
 
             g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
         }
         break;
     }
@@ -469,8 +512,6 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(command_processor_config.trigger): {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
-            MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
-
             u32* buffer = (u32*)g_memory->GetPhysicalPointer(config.GetPhysicalAddress());
 
             if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
@@ -478,7 +519,18 @@ inline void Write(u32 addr, const T data) {
                                                                 config.GetPhysicalAddress());
             }
 
-            Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+            if (!VideoCore::g_gpu_thread) {
+                MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+                Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+            } else {
+                // The application is free to reuse the buffer once it is submitted
+                std::vector<u32> list(buffer, buffer + config.size / sizeof(u32));
+                SubmitWork([list = std::move(list)] {
+                    MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+                    Pica::CommandProcessor::ProcessCommandList(
+                        list.data(), static_cast<u32>(list.size() * sizeof(u32)));
+                });
+            }
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -512,7 +564,26 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
-    VideoCore::g_renderer->SwapBuffers();
+    Core::System& system = Core::System::GetInstance();
+
+    // The screens are read now, as the application may reconfigure them before the GPU thread
+    // gets to the swap
+    const auto screens = RendererBase::ScreenConfig::Read();
+    if (!VideoCore::g_gpu_thread) {
+        VideoCore::g_renderer->SwapBuffers(screens);
+    } else {
+        // Let the GPU thread fall at most a frame behind
+        VideoCore::g_gpu_thread->WaitForFence(last_swap_fence);
+        last_swap_fence = VideoCore::g_gpu_thread->Push(
+            [screens] { VideoCore::g_renderer->SwapBuffers(screens); });
+    }
+
+    system.perf_stats->EndSystemFrame();
+    VideoCore::g_renderer->GetRenderWindow().PollEvents();
+    system.frame_limiter.DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
+    system.perf_stats->BeginSystemFrame();
+
+    Update();
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -523,7 +594,7 @@ static void VBlankCallback(u64 userdata, s64 cycles_late) {
     Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC1);
 
     // Reschedule recurrent event
-    Core::System::GetInstance().CoreTiming().ScheduleEvent(
+    system.CoreTiming().ScheduleEvent(
         static_cast<u64>(BASE_CLOCK_RATE_ARM11 / (Settings::values.custom_screen_refresh_rate
                                                       ? Settings::values.screen_refresh_rate
                                                       : 60.0)) -
@@ -531,10 +602,65 @@ static void VBlankCallback(u64 userdata, s64 cycles_late) {
         vblank_event);
 }
 
+void SignalPicaInterrupt(Service::GSP::InterruptId interrupt) {
+    if (VideoCore::g_gpu_thread && VideoCore::g_gpu_thread->IsGPUThread()) {
+        std::lock_guard lock{pica_interrupt_mutex};
+        pica_interrupts.emplace_back(VideoCore::g_gpu_thread->GetRunningFence(), interrupt);
+    } else {
+        Service::GSP::SignalInterrupt(interrupt);
+    }
+}
+
+/// Signals the interrupts that the command lists up to the given fence raised
+static void SignalPicaInterrupts(u64 fence) {
+    std::vector<Service::GSP::InterruptId> interrupts;
+    {
+        std::lock_guard lock{pica_interrupt_mutex};
+        while (!pica_interrupts.empty() && pica_interrupts.front().first <= fence) {
+            interrupts.push_back(pica_interrupts.front().second);
+            pica_interrupts.pop_front();
+        }
+    }
+    for (Service::GSP::InterruptId interrupt : interrupts) {
+        Service::GSP::SignalInterrupt(interrupt);
+    }
+}
+
+void Update() {
+    if (!VideoCore::g_gpu_thread) {
+        return;
+    }
+
+    // The pages that the finished work cached or flushed are marked before signaling its
+    // interrupts, so that the application reads and writes them through the rasterizer
+    g_memory->ApplyDeferredRasterizerMarks();
+
+    while (!pending_work.empty() &&
+           VideoCore::g_gpu_thread->IsFenceSignaled(pending_work.front().fence)) {
+        SignalPicaInterrupts(pending_work.front().fence);
+        for (Service::GSP::InterruptId interrupt : pending_work.front().interrupts) {
+            Service::GSP::SignalInterrupt(interrupt);
+        }
+        pending_work.pop_front();
+    }
+}
+
+bool FinishPendingWork() {
+    if (pending_work.empty()) {
+        return false;
+    }
+    VideoCore::g_gpu_thread->WaitForFence(pending_work.back().fence);
+    Update();
+    return true;
+}
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory) {
     g_memory = &memory;
     memset(&g_regs, 0, sizeof(g_regs));
+    pending_work.clear();
+    pica_interrupts.clear();
+    last_swap_fence = 0;
 
     auto& framebuffer_top = g_regs.framebuffer_config[0];
     auto& framebuffer_sub = g_regs.framebuffer_config[1];
@@ -575,6 +701,11 @@ void Init(Memory::MemorySystem& memory) {
 
 /// Shutdown hardware
 void Shutdown() {
+    pending_work.clear();
+    {
+        std::lock_guard lock{pica_interrupt_mutex};
+        pica_interrupts.clear();
+    }
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
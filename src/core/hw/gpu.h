@@ -15,6 +15,10 @@ namespace Memory {
 class MemorySystem;
 }
 
+namespace Service::GSP {
+enum class InterruptId : u8;
+}
+
 namespace GPU {
 
 // Returns index corresponding to the Regs member labeled by field_name
@@ -327,6 +331,24 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Signals an interrupt raised by a PICA command list. On the GPU thread the interrupt is queued
+ * and signaled by Update once the command list is done, as the GSP service isn't thread safe.
+ */
+void SignalPicaInterrupt(Service::GSP::InterruptId interrupt);
+
+/**
+ * Signals the interrupts of the GPU work that the GPU thread finished, after marking the pages
+ * that it cached or flushed in the page tables
+ */
+void Update();
+
+/**
+ * Waits for the GPU thread to finish the queued GPU work, and signals its interrupts.
+ * @return Whether there was any such work
+ */
+bool FinishPendingWork();
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory);
 
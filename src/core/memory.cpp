@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <mutex>
 #include "audio_core/dsp_interface.h"
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -15,6 +17,7 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
 #include "core/memory.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -35,7 +38,31 @@ public:
         return false;
     }
 
+    /// Calls a function with the page number of each cached page in [first_page, end_page)
+    template <typename Func>
+    void ForEachCachedPage(u32 first_page, u32 end_page, Func&& func) const {
+        ForEachCachedPage(vram, VRAM_VADDR, first_page, end_page, func);
+        ForEachCachedPage(linear_heap, LINEAR_HEAP_VADDR, first_page, end_page, func);
+        ForEachCachedPage(new_linear_heap, NEW_LINEAR_HEAP_VADDR, first_page, end_page, func);
+    }
+
 private:
+    template <std::size_t N, typename Func>
+    static void ForEachCachedPage(const std::array<bool, N>& pages, VAddr region_start,
+                                  u32 first_page, u32 end_page, Func& func) {
+        const u32 region_first_page = region_start >> PAGE_BITS;
+        const u32 region_end_page = region_first_page + static_cast<u32>(N);
+        if (end_page <= region_first_page || first_page >= region_end_page)
+            return;
+
+        const auto begin =
+            pages.begin() + (std::max(first_page, region_first_page) - region_first_page);
+        const auto end = pages.begin() + (std::min(end_page, region_end_page) - region_first_page);
+        for (auto it = std::find(begin, end, true); it != end; it = std::find(it + 1, end, true)) {
+            func(region_first_page + static_cast<u32>(it - pages.begin()));
+        }
+    }
+
     bool* At(VAddr addr) {
         if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
             return &vram[(addr - VRAM_VADDR) / PAGE_SIZE];
@@ -66,6 +93,15 @@ public:
     RasterizerCacheMarker cache_marker;
     std::vector<PageTable*> page_table_list;
 
+    /// Regions that the rasterizer marked on the GPU thread, to mark on the emulation thread
+    struct DeferredMark {
+        PAddr start;
+        u32 size;
+        bool cached;
+    };
+    std::vector<DeferredMark> deferred_marks;
+    std::mutex deferred_marks_mutex;
+
     AudioCore::DspInterface* dsp = nullptr;
 };
 
@@ -87,22 +123,28 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, u8* memor
     RasterizerFlushVirtualRegion(base << PAGE_BITS, size * PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
 
-    u32 end = base + size;
-    while (base != end) {
-        ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
+    const u32 end = base + size;
+    ASSERT_MSG(end <= PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", end - 1);
 
-        page_table.attributes[base] = type;
-        page_table.pointers[base] = memory;
+    // The cache marker must be up to date before it's used below
+    ApplyDeferredRasterizerMarks();
 
-        // If the memory to map is already rasterizer-cached, mark the page
-        if (type == PageType::Memory && impl->cache_marker.IsCached(base * PAGE_SIZE)) {
-            page_table.attributes[base] = PageType::RasterizerCachedMemory;
-            page_table.pointers[base] = nullptr;
+    // Fill the whole run at once rather than page by page
+    std::fill(page_table.attributes.begin() + base, page_table.attributes.begin() + end, type);
+    if (memory == nullptr) {
+        std::fill(page_table.pointers.begin() + base, page_table.pointers.begin() + end, nullptr);
+    } else {
+        for (u32 page = base; page != end; ++page, memory += PAGE_SIZE) {
+            page_table.pointers[page] = memory;
         }
+    }
 
-        base += 1;
-        if (memory != nullptr)
-            memory += PAGE_SIZE;
+    // If the memory to map is already rasterizer-cached, mark the pages
+    if (type == PageType::Memory) {
+        impl->cache_marker.ForEachCachedPage(base, end, [&](u32 page) {
+            page_table.attributes[page] = PageType::RasterizerCachedMemory;
+            page_table.pointers[page] = nullptr;
+        });
     }
 }
 
@@ -357,6 +399,31 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     }
 
+    if (VideoCore::g_gpu_thread && VideoCore::g_gpu_thread->IsGPUThread()) {
+        std::lock_guard lock{impl->deferred_marks_mutex};
+        impl->deferred_marks.push_back({start, size, cached});
+        return;
+    }
+
+    ApplyDeferredRasterizerMarks();
+    MarkRegionCached(start, size, cached);
+}
+
+void MemorySystem::ApplyDeferredRasterizerMarks() {
+    std::vector<Impl::DeferredMark> marks;
+    {
+        std::lock_guard lock{impl->deferred_marks_mutex};
+        if (impl->deferred_marks.empty()) {
+            return;
+        }
+        marks.swap(impl->deferred_marks);
+    }
+    for (const auto& mark : marks) {
+        MarkRegionCached(mark.start, mark.size, mark.cached);
+    }
+}
+
+void MemorySystem::MarkRegionCached(PAddr start, u32 size, bool cached) {
     u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
     PAddr paddr = start;
 
@@ -407,7 +474,7 @@ void RasterizerFlushRegion(PAddr start, u32 size) {
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
+    VideoCore::RunSync([=] { VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size); });
 }
 
 void RasterizerInvalidateRegion(PAddr start, u32 size) {
@@ -415,7 +482,7 @@ void RasterizerInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size);
+    VideoCore::RunSync([=] { VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size); });
 }
 
 void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
@@ -425,7 +492,8 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
+    VideoCore::RunSync(
+        [=] { VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size); });
 }
 
 void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
@@ -448,18 +516,20 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         PAddr physical_start = paddr_region_start + (overlap_start - region_start);
         u32 overlap_size = overlap_end - overlap_start;
 
-        auto* rasterizer = VideoCore::g_renderer->Rasterizer();
-        switch (mode) {
-        case FlushMode::Flush:
-            rasterizer->FlushRegion(physical_start, overlap_size);
-            break;
-        case FlushMode::Invalidate:
-            rasterizer->InvalidateRegion(physical_start, overlap_size);
-            break;
-        case FlushMode::FlushAndInvalidate:
-            rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
-            break;
-        }
+        VideoCore::RunSync([=] {
+            auto* rasterizer = VideoCore::g_renderer->Rasterizer();
+            switch (mode) {
+            case FlushMode::Flush:
+                rasterizer->FlushRegion(physical_start, overlap_size);
+                break;
+            case FlushMode::Invalidate:
+                rasterizer->InvalidateRegion(physical_start, overlap_size);
+                break;
+            case FlushMode::FlushAndInvalidate:
+                rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
+                break;
+            }
+        });
     };
 
     CheckRegion(LINEAR_HEAP_VADDR, LINEAR_HEAP_VADDR_END, FCRAM_PADDR);
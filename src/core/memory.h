@@ -283,10 +283,15 @@ public:
     u8* GetFCRAMPointer(u32 offset);
 
     /**
-     * Mark each page touching the region as cached.
+     * Mark each page touching the region as cached. When called from the GPU thread, the pages are
+     * only marked once ApplyDeferredRasterizerMarks is called from the emulation thread, as the CPU
+     * reads the page tables without synchronization.
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /// Marks the pages that the GPU thread requested to mark since the last call
+    void ApplyDeferredRasterizerMarks();
+
     /// Registers page table for rasterizer cache marking
     void RegisterPageTable(PageTable* page_table);
 
@@ -312,6 +317,8 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, PageType type);
 
+    void MarkRegionCached(PAddr start, u32 size, bool cached);
+
     class Impl;
 
     std::unique_ptr<Impl> impl;
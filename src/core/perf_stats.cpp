@@ -104,6 +104,9 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    results.audio_latency = 0.0;
+    results.audio_underruns = 0;
+    results.idle_loop_skip = 0.0;
 
     // Reset counters
     reset_point = now;
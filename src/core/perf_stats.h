@@ -35,6 +35,12 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Measured latency between audio output by the DSP and playback by the sink, in seconds
+        double audio_latency;
+        /// Number of audio sink callbacks that could not be completely filled
+        u64 audio_underruns;
+        /// Fraction of the emulated time skipped in idle loops
+        double idle_loop_skip;
     };
 
     void BeginSystemFrame();
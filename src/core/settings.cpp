@@ -41,6 +41,7 @@ void Apply() {
     if (system.IsPoweredOn()) {
         Core::DSP().SetSink(values.sink_id, values.audio_device_id);
         Core::DSP().EnableStretching(values.enable_audio_stretching);
+        Core::DSP().EnableAdaptiveBuffering(values.enable_adaptive_audio_buffering);
 
         auto hid = Service::HID::GetModule(system);
         if (hid) {
@@ -78,11 +79,16 @@ void LogSettings() {
 
     LOG_INFO(Config, "Citra Configuration:");
     LogSetting("use_cpu_jit", Settings::values.use_cpu_jit);
+    LogSetting("use_multi_core", Settings::values.use_multi_core);
+    LogSetting("skip_idle_loops", Settings::values.skip_idle_loops);
     LogSetting("use_hw_renderer", Settings::values.use_hw_renderer);
     LogSetting("use_hw_shader", Settings::values.use_hw_shader);
+    LogSetting("async_shader_compilation", Settings::values.async_shader_compilation);
     LogSetting("shaders_accurate_mul", Settings::values.shaders_accurate_mul);
     LogSetting("use_shader_jit", Settings::values.use_shader_jit);
+    LogSetting("use_asynchronous_gpu_emulation", Settings::values.use_asynchronous_gpu_emulation);
     LogSetting("resolution_factor", Settings::values.resolution_factor);
+    LogSetting("texture_memory_budget", Settings::values.texture_memory_budget);
     LogSetting("use_frame_limit", Settings::values.use_frame_limit);
     LogSetting("frame_limit", Settings::values.frame_limit);
     LogSetting("pp_shader_name", Settings::values.pp_shader_name);
@@ -97,6 +103,7 @@ void LogSettings() {
     LogSetting("enable_dsp_lle_multithread", Settings::values.enable_dsp_lle_multithread);
     LogSetting("sink_id", Settings::values.sink_id);
     LogSetting("enable_audio_stretching", Settings::values.enable_audio_stretching);
+    LogSetting("enable_adaptive_audio_buffering", Settings::values.enable_adaptive_audio_buffering);
     LogSetting("audio_device_id", Settings::values.audio_device_id);
     LogSetting("mic_input_type", static_cast<int>(Settings::values.mic_input_type));
     LogSetting("mic_input_device", Settings::values.mic_input_device);
@@ -110,6 +117,7 @@ void LogSettings() {
     LogSetting("camera_config[OuterLeftCamera]", Settings::values.camera_config[OuterLeftCamera]);
     LogSetting("camera_flip[OuterLeftCamera]", Settings::values.camera_flip[OuterLeftCamera]);
     LogSetting("use_virtual_sd", Settings::values.use_virtual_sd);
+    LogSetting("use_title_image_cache", Settings::values.use_title_image_cache);
     LogSetting("is_new_3ds", Settings::values.is_new_3ds);
     LogSetting("region_value", Settings::values.region_value);
     LogSetting("use_gdbstub", Settings::values.use_gdbstub);
@@ -129,9 +129,12 @@ struct Values {
 
     // Core
     bool use_cpu_jit;
+    bool use_multi_core;
+    bool skip_idle_loops;
 
     // Data Storage
     bool use_virtual_sd;
+    bool use_title_image_cache;
 
     // System
     int region_value;
@@ -142,9 +145,12 @@ struct Values {
     bool use_hw_renderer;
     bool use_hw_shader;
     bool use_disk_shader_cache;
+    bool async_shader_compilation;
     bool shaders_accurate_mul;
     bool use_shader_jit;
+    bool use_asynchronous_gpu_emulation;
     u16 resolution_factor;
+    u32 texture_memory_budget;
     bool use_frame_limit;
     u16 frame_limit;
 
@@ -179,6 +185,7 @@ struct Values {
     bool enable_dsp_lle_multithread;
     std::string sink_id;
     bool enable_audio_stretching;
+    bool enable_adaptive_audio_buffering;
     std::string audio_device_id;
     float volume;
     MicInputType mic_input_type;
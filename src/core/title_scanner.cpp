@@ -0,0 +1,335 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <future>
+#include <optional>
+#include "common/common_funcs.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/hle/service/am/am.h"
+#include "core/hle/service/fs/archive.h"
+#include "core/loader/smdh.h"
+#include "core/title_scanner.h"
+
+namespace Core {
+
+namespace {
+
+constexpr u32 IndexMagic = 0x58495443; // "CTIX"
+constexpr u32 IndexVersion = 2;
+
+struct IndexHeader {
+    u32_le magic;
+    u32_le version;
+    u32_le num_entries;
+    INSERT_PADDING_WORDS(1);
+    /// Hash of the key and seed files the entries were scanned with
+    u64_le key_state;
+};
+static_assert(sizeof(IndexHeader) == 24, "IndexHeader has incorrect size");
+
+/// Fixed-size part of an index entry, followed by the path and the SMDH
+struct IndexEntryHeader {
+    s64_le mtime;
+    s64_le update_mtime;
+    u64_le size;
+    u64_le program_id;
+    u64_le extdata_id;
+    u32_le file_type;
+    u8 recognized;
+    u8 executable;
+    u8 has_program_id;
+    INSERT_PADDING_BYTES(1);
+    u32_le path_length;
+    u32_le smdh_length;
+};
+static_assert(sizeof(IndexEntryHeader) == 56, "IndexEntryHeader has incorrect size");
+
+/// Longest path and SMDH an index entry may have, anything longer means the index is corrupted
+constexpr u32 MaxPathLength = 0x1000;
+constexpr u32 MaxSMDHLength = sizeof(Loader::SMDH);
+
+/// Gets the path of the installed update of a title, or an empty string if it can't have one
+std::string GetUpdatePath(u64 program_id) {
+    if (program_id < 0x0004000000000000 || program_id > 0x00040000FFFFFFFF)
+        return {};
+
+    return Service::AM::GetTitleContentPath(Service::FS::MediaType::SDMC,
+                                            program_id + 0x0000000E00000000);
+}
+
+/**
+ * Hashes the files that decrypting titles depends on. Encrypted titles whose keys or seed were
+ * missing when they were scanned read as unrecognized or without an icon, so their entries must be
+ * scanned again once these files change.
+ */
+u64 ComputeKeyState() {
+    const std::string sysdata_dir = FileUtil::GetUserPath(FileUtil::UserPath::SysDataDir);
+    std::string contents;
+    for (const char* name : {AES_KEYS, BOOTROM9, SECRET_SECTOR, "seeddb.bin"}) {
+        std::string file_contents;
+        FileUtil::ReadFileToString(false, sysdata_dir + name, file_contents);
+        contents += name;
+        contents += file_contents;
+    }
+    return Common::ComputeHash64(contents.data(), contents.size());
+}
+
+s64 GetUpdateModificationTime(const ScannedTitle& title) {
+    if (!title.has_program_id)
+        return 0;
+
+    const std::string update_path = GetUpdatePath(title.program_id);
+    if (update_path.empty() || !FileUtil::Exists(update_path))
+        return 0;
+
+    return FileUtil::GetModificationTime(update_path);
+}
+
+} // Anonymous namespace
+
+TitleScanner& TitleScanner::GetInstance() {
+    static TitleScanner scanner;
+    return scanner;
+}
+
+TitleScanner::TitleScanner()
+    : index_path(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "title_index.bin") {
+    Load();
+}
+
+TitleScanner::~TitleScanner() {
+    Save();
+}
+
+std::vector<ScannedTitle> TitleScanner::Scan(const std::vector<std::string>& paths,
+                                             const std::atomic_bool* stop) {
+    std::vector<std::optional<IndexEntry>> entries(paths.size());
+    std::vector<std::pair<std::size_t, std::future<IndexEntry>>> pending;
+
+    const u64 current_key_state = ComputeKeyState();
+    {
+        std::lock_guard lock{mutex};
+        if (key_state != current_key_state) {
+            if (!index.empty())
+                LOG_INFO(Core, "Key or seed files changed, discarding the title index");
+            index.clear();
+            key_state = current_key_state;
+            dirty = true;
+        }
+    }
+
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        const std::string& path = paths[i];
+        const u64 size = FileUtil::GetSize(path);
+        const s64 mtime = FileUtil::GetModificationTime(path);
+
+        std::optional<IndexEntry> cached;
+        {
+            std::lock_guard lock{mutex};
+            if (const auto it = index.find(path); it != index.end())
+                cached = it->second;
+        }
+        if (cached && IsUpToDate(*cached, size, mtime)) {
+            entries[i] = std::move(cached);
+            continue;
+        }
+
+        pending.emplace_back(i, thread_pool.Submit([path, size, mtime, stop] {
+            if (stop && *stop)
+                return IndexEntry{};
+            return ScanFile(path, size, mtime);
+        }));
+    }
+
+    for (auto& [i, future] : pending) {
+        IndexEntry entry = future.get();
+        if (stop && *stop)
+            continue;
+
+        std::lock_guard lock{mutex};
+        index[paths[i]] = entry;
+        dirty = true;
+        entries[i] = std::move(entry);
+    }
+
+    if (!pending.empty())
+        Save();
+
+    std::vector<ScannedTitle> titles;
+    for (auto& entry : entries) {
+        if (entry && entry->recognized)
+            titles.push_back(std::move(entry->title));
+    }
+    return titles;
+}
+
+bool TitleScanner::IsUpToDate(const IndexEntry& entry, u64 size, s64 mtime) {
+    return entry.title.size == size && entry.mtime == mtime &&
+           entry.update_mtime == GetUpdateModificationTime(entry.title);
+}
+
+TitleScanner::IndexEntry TitleScanner::ScanFile(const std::string& path, u64 size, s64 mtime) {
+    IndexEntry entry;
+    entry.title.path = path;
+    entry.title.size = size;
+    entry.mtime = mtime;
+
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(path);
+    if (!loader)
+        return entry;
+
+    entry.recognized = true;
+    entry.title.file_type = loader->GetFileType();
+    loader->IsExecutable(entry.title.executable);
+    entry.title.has_program_id =
+        loader->ReadProgramId(entry.title.program_id) == Loader::ResultStatus::Success;
+    loader->ReadExtdataId(entry.title.extdata_id);
+    loader->ReadIcon(entry.title.smdh);
+
+    if (entry.title.has_program_id) {
+        const std::string update_path = GetUpdatePath(entry.title.program_id);
+        if (!update_path.empty() && FileUtil::Exists(update_path)) {
+            entry.update_mtime = FileUtil::GetModificationTime(update_path);
+            if (std::unique_ptr<Loader::AppLoader> update_loader =
+                    Loader::GetLoader(update_path)) {
+                std::vector<u8> update_smdh;
+                update_loader->ReadIcon(update_smdh);
+                entry.title.smdh = std::move(update_smdh);
+            }
+        }
+    }
+
+    return entry;
+}
+
+void TitleScanner::Load() {
+    FileUtil::IOFile file(index_path, "rb");
+    if (!file.IsOpen())
+        return;
+
+    IndexHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) || header.magic != IndexMagic ||
+        header.version != IndexVersion) {
+        LOG_WARNING(Core, "Ignoring invalid title index {}", index_path);
+        return;
+    }
+
+    const u64 file_size = file.GetSize();
+    std::unordered_map<std::string, IndexEntry> entries;
+    for (u32 i = 0; i < header.num_entries; ++i) {
+        IndexEntryHeader entry_header;
+        if (file.ReadBytes(&entry_header, sizeof(entry_header)) != sizeof(entry_header)) {
+            LOG_WARNING(Core, "Ignoring truncated title index {}", index_path);
+            return;
+        }
+
+        // Don't trust the lengths before allocating for them
+        const u64 remaining = file_size - std::min<u64>(file.Tell(), file_size);
+        if (entry_header.path_length > MaxPathLength || entry_header.smdh_length > MaxSMDHLength ||
+            u64{entry_header.path_length} + entry_header.smdh_length > remaining) {
+            LOG_WARNING(Core, "Ignoring corrupted title index {}", index_path);
+            return;
+        }
+
+        IndexEntry entry;
+        entry.recognized = entry_header.recognized != 0;
+        entry.mtime = entry_header.mtime;
+        entry.update_mtime = entry_header.update_mtime;
+        entry.title.file_type =
+            static_cast<Loader::FileType>(static_cast<u32>(entry_header.file_type));
+        entry.title.executable = entry_header.executable != 0;
+        entry.title.has_program_id = entry_header.has_program_id != 0;
+        entry.title.program_id = entry_header.program_id;
+        entry.title.extdata_id = entry_header.extdata_id;
+        entry.title.size = entry_header.size;
+        entry.title.path.resize(entry_header.path_length);
+        entry.title.smdh.resize(entry_header.smdh_length);
+        if (file.ReadBytes(entry.title.path.data(), entry.title.path.size()) !=
+                entry.title.path.size() ||
+            file.ReadBytes(entry.title.smdh.data(), entry.title.smdh.size()) !=
+                entry.title.smdh.size()) {
+            LOG_WARNING(Core, "Ignoring truncated title index {}", index_path);
+            return;
+        }
+
+        entries.emplace(entry.title.path, std::move(entry));
+    }
+
+    index = std::move(entries);
+    key_state = header.key_state;
+
+    LOG_INFO(Core, "Loaded {} entries from the title index", index.size());
+}
+
+bool TitleScanner::Save() {
+    std::lock_guard lock{mutex};
+    if (!dirty)
+        return true;
+
+    // Forget about files that were removed since they were scanned
+    for (auto it = index.begin(); it != index.end();) {
+        if (FileUtil::Exists(it->first)) {
+            ++it;
+        } else {
+            it = index.erase(it);
+        }
+    }
+
+    const std::string temp_path = index_path + ".tmp";
+    if (!FileUtil::CreateFullPath(index_path))
+        return false;
+
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file.IsOpen())
+            return false;
+
+        IndexHeader header{};
+        header.magic = IndexMagic;
+        header.version = IndexVersion;
+        header.num_entries = static_cast<u32>(index.size());
+        header.key_state = key_state;
+        bool success = file.WriteObject(header) == 1;
+
+        for (const auto& [path, entry] : index) {
+            IndexEntryHeader entry_header{};
+            entry_header.mtime = entry.mtime;
+            entry_header.update_mtime = entry.update_mtime;
+            entry_header.size = entry.title.size;
+            entry_header.program_id = entry.title.program_id;
+            entry_header.extdata_id = entry.title.extdata_id;
+            entry_header.file_type = static_cast<u32>(entry.title.file_type);
+            entry_header.recognized = entry.recognized ? 1 : 0;
+            entry_header.executable = entry.title.executable ? 1 : 0;
+            entry_header.has_program_id = entry.title.has_program_id ? 1 : 0;
+            entry_header.path_length = static_cast<u32>(path.size());
+            entry_header.smdh_length = static_cast<u32>(entry.title.smdh.size());
+            success = success && file.WriteObject(entry_header) == 1 &&
+                      file.WriteBytes(path.data(), path.size()) == path.size() &&
+                      file.WriteBytes(entry.title.smdh.data(), entry.title.smdh.size()) ==
+                          entry.title.smdh.size();
+        }
+
+        if (!success || !file.Close()) {
+            LOG_ERROR(Core, "Failed to write the title index to {}", temp_path);
+            FileUtil::Delete(temp_path);
+            return false;
+        }
+    }
+
+    if (!FileUtil::ReplaceFile(temp_path, index_path)) {
+        FileUtil::Delete(temp_path);
+        return false;
+    }
+
+    dirty = false;
+    return true;
+}
+
+} // namespace Core
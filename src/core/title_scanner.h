@@ -0,0 +1,84 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_pool.h"
+#include "core/loader/loader.h"
+
+namespace Core {
+
+/// Metadata of a title file, as shown in the game list
+struct ScannedTitle {
+    std::string path;
+    Loader::FileType file_type = Loader::FileType::Unknown;
+    bool executable = false;
+    /// Whether the file carries a program ID, which isn't the case of homebrew formats
+    bool has_program_id = false;
+    u64 program_id = 0;
+    u64 extdata_id = 0;
+    /// SMDH of the title, taken from its installed update if there is one
+    std::vector<u8> smdh;
+    u64 size = 0;
+};
+
+/**
+ * Reads the metadata of title files on a thread pool. Results are remembered in an index file in
+ * the cache directory, so that files that didn't change since they were last scanned don't need
+ * to be opened again. The index is discarded when the key or seed files change.
+ */
+class TitleScanner {
+public:
+    static TitleScanner& GetInstance();
+
+    /**
+     * Scans the given files.
+     * @param paths Files to scan
+     * @param stop Optional flag, scanning stops early once it is set
+     * @return Metadata of the files that were recognized by a loader, in the order of `paths`
+     */
+    std::vector<ScannedTitle> Scan(const std::vector<std::string>& paths,
+                                   const std::atomic_bool* stop = nullptr);
+
+    /// Writes the index back to its file if it changed
+    bool Save();
+
+private:
+    struct IndexEntry {
+        ScannedTitle title;
+        /// Whether a loader recognized the file
+        bool recognized = false;
+        s64 mtime = 0;
+        /// Modification time of the update the SMDH was taken from, 0 if there is none
+        s64 update_mtime = 0;
+    };
+
+    TitleScanner();
+    ~TitleScanner();
+
+    /// Checks whether an index entry still describes the file at its path
+    static bool IsUpToDate(const IndexEntry& entry, u64 size, s64 mtime);
+
+    static IndexEntry ScanFile(const std::string& path, u64 size, s64 mtime);
+
+    void Load();
+
+    std::string index_path;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, IndexEntry> index;
+    /// Hash of the key and seed files the entries of the index were scanned with
+    u64 key_state = 0;
+    bool dirty = false;
+
+    Common::ThreadPool thread_pool{0, "TitleScanner"};
+};
+
+} // namespace Core
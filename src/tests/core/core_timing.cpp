@@ -114,6 +114,26 @@ TEST_CASE("CoreTiming[Threadsave]", "[core]") {
     AdvanceAndCheck(timing, 4, MAX_SLICE_LENGTH);
 }
 
+TEST_CASE("CoreTiming[ThreadsafeAt]", "[core]") {
+    Core::Timing timing;
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0
+    timing.Advance();
+
+    timing.ScheduleEventThreadsafeAt(timing.GetTicks() + 500, cb_a, CB_IDS[0]);
+    // Manually force since ScheduleEventThreadsafeAt doesn't call it
+    timing.ForceExceptionCheck(500);
+    REQUIRE(500 == timing.GetDowncount());
+    AdvanceAndCheck(timing, 0, MAX_SLICE_LENGTH);
+
+    // An event whose time has already passed runs at the next Advance
+    timing.ScheduleEventThreadsafeAt(timing.GetTicks() - 300, cb_b, CB_IDS[1]);
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH, 400, MAX_SLICE_LENGTH - 100);
+}
+
 namespace SharedSlotTest {
 static unsigned int counter = 0;
 
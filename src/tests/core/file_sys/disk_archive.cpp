@@ -0,0 +1,79 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <catch2/catch.hpp>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "core/file_sys/disk_archive.h"
+
+namespace FileSys {
+
+TEST_CASE("DiskFile write-back", "[core][file_sys]") {
+    const std::string dir =
+        FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "write_back_test" DIR_SEP;
+    FileUtil::DeleteDirRecursively(dir);
+    REQUIRE(FileUtil::CreateFullPath(dir));
+    const std::string path = dir + "save.bin";
+    FileUtil::WriteStringToFile(false, path, "aaaaaaaa");
+
+    const auto open = [](const std::string& path) {
+        Mode mode{};
+        mode.read_flag.Assign(1);
+        mode.write_flag.Assign(1);
+        auto file = std::make_unique<DiskFile>(FileUtil::IOFile(path, "r+b"), mode, nullptr);
+        file->EnableWriteBack(path);
+        return file;
+    };
+    const auto write = [](DiskFile& file, u64 offset, const std::string& data) {
+        file.Write(offset, data.size(), true, reinterpret_cast<const u8*>(data.data()));
+    };
+    const auto read_host = [](const std::string& path) {
+        std::string contents;
+        FileUtil::ReadFileToString(false, path, contents);
+        return contents;
+    };
+
+    SECTION("writes the modified ranges out on flush") {
+        auto file = open(path);
+        write(*file, 2, "bb");
+        REQUIRE(read_host(path) == "aaaaaaaa");
+        file->Flush();
+        REQUIRE(read_host(path) == "aabbaaaa");
+
+        write(*file, 10, "c");
+        file->Flush();
+        REQUIRE(read_host(path) == std::string("aabbaaaa\0\0c", 11));
+
+        file->SetSize(4);
+        file->Flush();
+        REQUIRE(read_host(path) == "aabb");
+    }
+
+    SECTION("follows renames") {
+        auto file = open(path);
+        write(*file, 0, "bb");
+        const std::string renamed_dir = dir + "renamed" DIR_SEP;
+        REQUIRE(FileUtil::CreateDir(renamed_dir));
+        REQUIRE(RenameWithWriteBack(path, renamed_dir + "save.bin"));
+        REQUIRE(RenameWithWriteBack(renamed_dir, dir + "moved" DIR_SEP));
+        file->Flush();
+        REQUIRE(!FileUtil::Exists(path));
+        REQUIRE(read_host(dir + "moved" DIR_SEP "save.bin") == "bbaaaaaa");
+    }
+
+    SECTION("drops the writes of deleted files") {
+        auto file = open(path);
+        write(*file, 0, "bb");
+        REQUIRE(DeleteWithWriteBack(path, [&] { return FileUtil::Delete(path); }));
+        file->Flush();
+        file.reset();
+        REQUIRE(!FileUtil::Exists(path));
+    }
+
+    FileUtil::DeleteDirRecursively(dir);
+}
+
+} // namespace FileSys
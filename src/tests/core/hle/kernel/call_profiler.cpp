@@ -0,0 +1,49 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/hle/kernel/call_profiler.h"
+
+namespace Kernel {
+
+TEST_CASE("CallProfiler output", "[core][kernel]") {
+    CallProfiler profiler;
+    const int service = 0;
+
+    CallCounters& svc = profiler.GetSVCCounters(0x0A, "SleepThread");
+    svc.calls = 3;
+    svc.host_ns = 1200;
+    svc.cycles_slept = 5000;
+
+    CallCounters& command =
+        profiler.GetServiceCounters(&service, R"(srv:"x\y")", "Get, Set", 0x00010040);
+    command.calls = 2;
+    command.host_ns = 300;
+
+    // Commands that were never called are left out
+    profiler.GetServiceCounters(&service, "fs:USER", "OpenFile", 0x080201C2);
+
+    SECTION("JSON") {
+        REQUIRE(profiler.ToJSON() ==
+                "{\n"
+                "  \"svcs\": [\n"
+                R"(    {"id": 10, "name": "SleepThread", "calls": 3, "host_ns": 1200, )"
+                R"("cycles_slept": 5000})"
+                "\n  ],\n"
+                "  \"service_commands\": [\n"
+                R"(    {"service": "srv:\"x\\y\"", "command": "Get, Set", "header": )"
+                R"("0x00010040", "calls": 2, "host_ns": 300, "cycles_slept": 0})"
+                "\n  ]\n"
+                "}\n");
+    }
+
+    SECTION("CSV") {
+        REQUIRE(profiler.ToCSV() == "kind,service,name,id,calls,host_ns,cycles_slept\n"
+                                    "svc,,SleepThread,0x0A,3,1200,5000\n"
+                                    R"(service,"srv:""x\y""","Get, Set",0x00010040,2,300,0)"
+                                    "\n");
+    }
+}
+
+} // namespace Kernel
@@ -2,10 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <catch2/catch.hpp>
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/ipc.h"
+#include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
@@ -373,4 +375,57 @@ TEST_CASE("HLERequestContext::WriteToOutgoingCommandBuffer", "[core][kernel]") {
     }
 }
 
+TEST_CASE("IPC::GetCommandSize", "[core][kernel]") {
+    REQUIRE(IPC::GetCommandSize(IPC::MakeHeader(0x1234, 0, 0)) == 1);
+    REQUIRE(IPC::GetCommandSize(IPC::MakeHeader(0x1234, 1, 2)) == 4);
+    REQUIRE(IPC::GetCommandSize(IPC::MakeHeader(0x1234, 63, 0)) == 64);
+    // Sizes past the command buffer area are clamped to it
+    REQUIRE(IPC::GetCommandSize(IPC::MakeHeader(0x1234, 63, 63)) == IPC::COMMAND_BUFFER_LENGTH);
+}
+
+TEST_CASE("HLERequestContext no-op call benchmark", "[.benchmark][core][kernel]") {
+    // Measures the translation overhead of a service call that does nothing, with a small static
+    // buffer in the request as many service calls have.
+    constexpr std::size_t NumCalls = 1'000'000;
+
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(memory, timing, [] {}, 0);
+    auto [server, client] = kernel.CreateSessionPair();
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+
+    auto buffer = std::make_shared<std::vector<u8>>(Memory::PAGE_SIZE);
+    const VAddr buffer_address = 0x10000000;
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(buffer_address, buffer->data(), buffer->size(),
+                                  MemoryState::Private)
+                .Code() == RESULT_SUCCESS);
+
+    const u32_le request[]{
+        IPC::MakeHeader(0x1234, 1, 2),
+        0x12345678,
+        IPC::StaticBufferDesc(0x100, 0),
+        buffer_address,
+    };
+    std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> reply{};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < NumCalls; ++i) {
+        HLERequestContext context(kernel, server, nullptr);
+        context.PopulateFromIncomingCommandBuffer(request, *process);
+
+        IPC::RequestBuilder rb(context, 0x1234, 1, 0);
+        rb.Push(RESULT_SUCCESS);
+
+        context.WriteToOutgoingCommandBuffer(reply.data(), *process);
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    REQUIRE(reply[1] == RESULT_SUCCESS.raw);
+    WARN("HLERequestContext: " << elapsed.count() / NumCalls << " ns per no-op call");
+
+    REQUIRE(process->vm_manager.UnmapRange(buffer_address, buffer->size()) == RESULT_SUCCESS);
+}
+
 } // namespace Kernel
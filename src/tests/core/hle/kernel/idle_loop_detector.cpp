@@ -0,0 +1,61 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/core_timing.h"
+#include "core/hle/kernel/idle_loop_detector.h"
+#include "core/settings.h"
+
+namespace Kernel {
+
+TEST_CASE("IdleLoopDetector", "[core][kernel]") {
+    Settings::values.skip_idle_loops = true;
+
+    Core::Timing timing;
+    timing.Advance();
+    IdleLoopDetector detector(timing);
+    const Thread* thread = reinterpret_cast<const Thread*>(0x1000);
+
+    // Polls an SVC from the given place, each 100 cycles apart
+    const auto poll = [&](u32 pc, u32 kind) {
+        timing.AddTicks(100);
+        return detector.OnPoll(thread, pc, kind);
+    };
+
+    SECTION("skips the slice once the loop repeats enough") {
+        int polls = 0;
+        while (!poll(0x100000, 0x0A))
+            ++polls;
+
+        REQUIRE(polls == 8);
+        REQUIRE(timing.GetDowncount() == 0);
+        REQUIRE(timing.GetSkippedIdleLoops() == 1);
+        REQUIRE(timing.GetSkippedIdleLoopTicks() > 0);
+
+        // The next slice is skipped as soon as the loop polls again
+        timing.Advance();
+        REQUIRE(poll(0x100000, 0x0A));
+    }
+
+    SECTION("other calls in between break the loop") {
+        for (int i = 0; i < 32; ++i) {
+            REQUIRE_FALSE(poll(0x100000, 0x0A));
+            if (i % 4 == 0)
+                detector.Reset();
+        }
+        for (int i = 0; i < 32; ++i)
+            REQUIRE_FALSE(poll(0x100000 + (i % 2) * 4, 0x0A));
+        REQUIRE(timing.GetSkippedIdleLoops() == 0);
+    }
+
+    SECTION("is disabled by the setting") {
+        Settings::values.skip_idle_loops = false;
+        for (int i = 0; i < 32; ++i)
+            REQUIRE_FALSE(poll(0x100000, 0x0A));
+    }
+
+    Settings::values.skip_idle_loops = false;
+}
+
+} // namespace Kernel
@@ -0,0 +1,230 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/arm/arm_interface.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+namespace {
+
+class TestThreadContext final : public ARM_Interface::ThreadContext {
+public:
+    void Reset() override {
+        registers = {};
+    }
+    u32 GetCpuRegister(std::size_t index) const override {
+        return registers[index];
+    }
+    void SetCpuRegister(std::size_t index, u32 value) override {
+        registers[index] = value;
+    }
+    u32 GetCpsr() const override {
+        return 0;
+    }
+    void SetCpsr(u32 value) override {}
+    u32 GetFpuRegister(std::size_t index) const override {
+        return 0;
+    }
+    void SetFpuRegister(std::size_t index, u32 value) override {}
+    u32 GetFpscr() const override {
+        return 0;
+    }
+    void SetFpscr(u32 value) override {}
+    u32 GetFpexc() const override {
+        return 0;
+    }
+    void SetFpexc(u32 value) override {}
+
+private:
+    std::array<u32, 16> registers{};
+};
+
+/// CPU that executes nothing and counts how many times it was told its page table changed
+class TestCPU final : public ARM_Interface {
+public:
+    void Run() override {}
+    void Step() override {}
+    void ClearInstructionCache() override {}
+    void InvalidateCacheRange(u32 start_address, std::size_t length) override {}
+    void PageTableChanged() override {
+        ++page_table_changes;
+    }
+    void SetPC(u32 addr) override {}
+    u32 GetPC() const override {
+        return 0;
+    }
+    u32 GetReg(int index) const override {
+        return 0;
+    }
+    void SetReg(int index, u32 value) override {}
+    u32 GetVFPReg(int index) const override {
+        return 0;
+    }
+    void SetVFPReg(int index, u32 value) override {}
+    u32 GetVFPSystemReg(VFPSystemRegister reg) const override {
+        return 0;
+    }
+    void SetVFPSystemReg(VFPSystemRegister reg, u32 value) override {}
+    u32 GetCPSR() const override {
+        return 0;
+    }
+    void SetCPSR(u32 cpsr) override {}
+    u32 GetCP15Register(CP15Register reg) override {
+        return 0;
+    }
+    void SetCP15Register(CP15Register reg, u32 value) override {}
+    std::unique_ptr<ThreadContext> NewContext() const override {
+        return std::make_unique<TestThreadContext>();
+    }
+    void SaveContext(const std::unique_ptr<ThreadContext>& ctx) override {}
+    void LoadContext(const std::unique_ptr<ThreadContext>& ctx) override {}
+    void PrepareReschedule() override {}
+
+    int page_table_changes = 0;
+};
+
+constexpr VAddr EntryPoint = 0x00100000;
+
+bool Contains(const std::vector<std::shared_ptr<Thread>>& threads, const Thread* thread) {
+    return std::any_of(threads.begin(), threads.end(),
+                       [thread](const auto& other) { return other.get() == thread; });
+}
+
+} // Anonymous namespace
+
+TEST_CASE("KernelSystem with several cores", "[core][kernel]") {
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    int reschedule_requests = 0;
+    KernelSystem kernel(memory, timing, [&reschedule_requests] { ++reschedule_requests; }, 0, 2);
+
+    auto cpu0 = std::make_shared<TestCPU>();
+    auto cpu1 = std::make_shared<TestCPU>();
+    kernel.SetCPUs({cpu0, cpu1});
+
+    auto process_a = kernel.CreateProcess(kernel.CreateCodeSet("a", 0));
+    auto process_b = kernel.CreateProcess(kernel.CreateCodeSet("b", 1));
+    std::vector<u8> code(Memory::PAGE_SIZE);
+    for (const auto& process : {process_a, process_b}) {
+        REQUIRE(process->vm_manager
+                    .MapBackingMemory(EntryPoint, code.data(), code.size(), MemoryState::Code)
+                    .Code() == RESULT_SUCCESS);
+    }
+
+    const auto create_thread = [&kernel](Process& process, s32 processor_id) {
+        auto thread = kernel.CreateThread("thread", EntryPoint, ThreadPrioUserlandMax, 0,
+                                          processor_id, Memory::HEAP_VADDR_END, process);
+        REQUIRE(thread.Succeeded());
+        return thread.Unwrap();
+    };
+
+    SECTION("threads are created on the core named by their processor ID") {
+        auto app_thread = create_thread(*process_a, ThreadProcessorId0);
+        auto sys_thread = create_thread(*process_a, ThreadProcessorId1);
+        // Core 2 of the New 3DS isn't emulated here, so its threads run on the application core
+        auto core2_thread = create_thread(*process_a, 2);
+
+        REQUIRE(Contains(kernel.GetThreadManager(0).GetThreadList(), app_thread.get()));
+        REQUIRE(Contains(kernel.GetThreadManager(1).GetThreadList(), sys_thread.get()));
+        REQUIRE(Contains(kernel.GetThreadManager(0).GetThreadList(), core2_thread.get()));
+        REQUIRE_FALSE(Contains(kernel.GetThreadManager(0).GetThreadList(), sys_thread.get()));
+        REQUIRE(kernel.GetThreadList().size() == 3);
+
+        // Thread IDs are unique across cores
+        REQUIRE(app_thread->thread_id != sys_thread->thread_id);
+        REQUIRE(sys_thread->thread_id != core2_thread->thread_id);
+        REQUIRE(app_thread->thread_id != core2_thread->thread_id);
+    }
+
+    SECTION("each core schedules its own threads") {
+        auto app_thread = create_thread(*process_a, ThreadProcessorId0);
+        auto sys_thread = create_thread(*process_b, ThreadProcessorId1);
+
+        kernel.GetThreadManager(0).Reschedule();
+        REQUIRE(kernel.GetThreadManager(0).GetCurrentThread() == app_thread.get());
+        REQUIRE_FALSE(kernel.GetThreadManager(0).HaveReadyThreads());
+        REQUIRE(kernel.GetThreadManager(1).HaveReadyThreads());
+
+        kernel.SetRunningCPU(1);
+        kernel.GetThreadManager().Reschedule();
+        REQUIRE(kernel.GetThreadManager(1).GetCurrentThread() == sys_thread.get());
+        REQUIRE(kernel.GetThreadManager(0).GetCurrentThread() == app_thread.get());
+        REQUIRE(kernel.GetCurrentProcess() == process_b);
+        REQUIRE(app_thread->status == ThreadStatus::Running);
+        REQUIRE(sys_thread->status == ThreadStatus::Running);
+    }
+
+    SECTION("threads are resumed on their own core") {
+        auto app_thread = create_thread(*process_a, ThreadProcessorId0);
+        auto sys_thread = create_thread(*process_a, ThreadProcessorId1);
+
+        kernel.SetRunningCPU(1);
+        kernel.GetThreadManager().Reschedule();
+        REQUIRE(kernel.GetThreadManager(1).GetCurrentThread() == sys_thread.get());
+        sys_thread->status = ThreadStatus::WaitSleep;
+        kernel.GetThreadManager().Reschedule();
+        REQUIRE(kernel.GetThreadManager(1).GetCurrentThread() == nullptr);
+        REQUIRE_FALSE(kernel.GetThreadManager(1).IsReschedulePending());
+
+        // Wake the thread up while the application core runs
+        kernel.SetRunningCPU(0);
+        kernel.GetThreadManager().Reschedule();
+        const int previous_requests = reschedule_requests;
+        sys_thread->ResumeFromWait();
+
+        REQUIRE(sys_thread->status == ThreadStatus::Ready);
+        REQUIRE(kernel.GetThreadManager(1).IsReschedulePending());
+        REQUIRE(kernel.GetThreadManager(1).HaveReadyThreads());
+        REQUIRE_FALSE(kernel.GetThreadManager(0).IsReschedulePending());
+        REQUIRE_FALSE(kernel.GetThreadManager(0).HaveReadyThreads());
+        REQUIRE(reschedule_requests > previous_requests);
+        REQUIRE(kernel.GetThreadManager(0).GetCurrentThread() == app_thread.get());
+
+        kernel.SetRunningCPU(1);
+        kernel.GetThreadManager().Reschedule();
+        REQUIRE(kernel.GetThreadManager(1).GetCurrentThread() == sys_thread.get());
+        REQUIRE_FALSE(kernel.GetThreadManager(1).IsReschedulePending());
+    }
+
+    SECTION("switching cores switches to the page table of their process") {
+        kernel.SetCurrentProcess(process_a);
+        kernel.SetCurrentProcessForCPU(process_b, 1);
+        REQUIRE(kernel.GetCurrentProcess() == process_a);
+        REQUIRE(memory.GetCurrentPageTable() == &process_a->vm_manager.page_table);
+
+        const int cpu0_changes = cpu0->page_table_changes;
+        kernel.SetRunningCPU(1);
+        REQUIRE(kernel.GetRunningCoreId() == 1);
+        REQUIRE(kernel.current_cpu == cpu1);
+        REQUIRE(kernel.GetCurrentProcess() == process_b);
+        REQUIRE(memory.GetCurrentPageTable() == &process_b->vm_manager.page_table);
+        REQUIRE(cpu1->page_table_changes == 1);
+
+        // The application core's CPU last ran with this page table, so it isn't notified
+        kernel.SetRunningCPU(0);
+        REQUIRE(kernel.GetCurrentProcess() == process_a);
+        REQUIRE(memory.GetCurrentPageTable() == &process_a->vm_manager.page_table);
+        REQUIRE(cpu0->page_table_changes == cpu0_changes);
+
+        // The system core now executes the same process, but its CPU last ran with another one
+        kernel.SetCurrentProcessForCPU(process_a, 1);
+        kernel.SetRunningCPU(1);
+        REQUIRE(kernel.GetCurrentProcess() == process_a);
+        REQUIRE(cpu1->page_table_changes == 2);
+        kernel.SetRunningCPU(0);
+        REQUIRE(cpu0->page_table_changes == cpu0_changes);
+    }
+}
+
+} // namespace Kernel
@@ -0,0 +1,184 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread_queue_list.h"
+#include "core/hle/kernel/thread.h"
+
+namespace Kernel {
+
+namespace {
+
+struct TestThread : Common::ThreadQueueListNode<TestThread> {
+    unsigned int priority = 0;
+};
+
+using ReadyQueue = Common::ThreadQueueList<TestThread, ThreadPrioLowest + 1>;
+
+} // Anonymous namespace
+
+TEST_CASE("ThreadQueueList", "[core][kernel]") {
+    ReadyQueue queue;
+    std::vector<TestThread> threads(4);
+
+    SECTION("pops by priority, then in FIFO order") {
+        queue.push_back(48, &threads[0]);
+        queue.push_back(24, &threads[1]);
+        queue.push_back(48, &threads[2]);
+        queue.push_front(48, &threads[3]);
+
+        REQUIRE(queue.get_first() == &threads[1]);
+        REQUIRE(queue.pop_first() == &threads[1]);
+        REQUIRE(queue.pop_first() == &threads[3]);
+        REQUIRE(queue.pop_first() == &threads[0]);
+        REQUIRE(queue.pop_first() == &threads[2]);
+        REQUIRE(queue.pop_first() == nullptr);
+        REQUIRE(queue.empty(48));
+    }
+
+    SECTION("pop_first_better only returns strictly better threads") {
+        queue.push_back(30, &threads[0]);
+        REQUIRE(queue.pop_first_better(30) == nullptr);
+        REQUIRE(queue.pop_first_better(31) == &threads[0]);
+        REQUIRE(queue.pop_first_better(ThreadPrioLowest) == nullptr);
+    }
+
+    SECTION("remove unlinks from anywhere in a level") {
+        for (auto& thread : threads)
+            queue.push_back(ThreadPrioLowest, &thread);
+
+        queue.remove(ThreadPrioLowest, &threads[1]);
+        queue.remove(ThreadPrioLowest, &threads[3]);
+        // Removing a thread that isn't queued does nothing
+        queue.remove(ThreadPrioLowest, &threads[3]);
+
+        REQUIRE(queue.contains(&threads[1]) == static_cast<unsigned int>(-1));
+        REQUIRE(queue.contains(&threads[2]) == ThreadPrioLowest);
+        REQUIRE(queue.pop_first() == &threads[0]);
+        REQUIRE(queue.pop_first() == &threads[2]);
+        REQUIRE(queue.pop_first() == nullptr);
+    }
+
+    SECTION("move and rotate") {
+        queue.push_back(40, &threads[0]);
+        queue.push_back(40, &threads[1]);
+        queue.push_back(40, &threads[2]);
+
+        queue.rotate(40);
+        REQUIRE(queue.get_first() == &threads[1]);
+
+        queue.move(&threads[2], 40, ThreadPrioHighest);
+        REQUIRE(queue.pop_first() == &threads[2]);
+        REQUIRE(queue.pop_first() == &threads[1]);
+        REQUIRE(queue.pop_first() == &threads[0]);
+    }
+
+    SECTION("clear") {
+        queue.push_back(1, &threads[0]);
+        queue.push_back(2, &threads[1]);
+        queue.clear();
+        REQUIRE(queue.get_first() == nullptr);
+        REQUIRE(queue.contains(&threads[0]) == static_cast<unsigned int>(-1));
+    }
+}
+
+TEST_CASE("ThreadQueueList matches a per-level FIFO model", "[core][kernel]") {
+    // Simulates a title with many worker threads spread over a few priorities, rescheduling
+    // after each of them runs, with the occasional priority boost from mutex inheritance, and
+    // checks every pick against a plain list of FIFOs.
+    constexpr std::size_t NumThreads = 64;
+    constexpr std::size_t NumReschedules = 10'000;
+
+    ReadyQueue queue;
+    std::vector<std::deque<TestThread*>> model(ThreadPrioLowest + 1);
+    std::vector<TestThread> threads(NumThreads);
+    for (std::size_t i = 0; i < NumThreads; ++i) {
+        threads[i].priority = ThreadPrioUserlandMax + static_cast<unsigned int>(i % 8) * 4;
+        queue.push_back(threads[i].priority, &threads[i]);
+        model[threads[i].priority].push_back(&threads[i]);
+    }
+
+    const auto model_pop_first = [&model]() -> TestThread* {
+        for (auto& level : model) {
+            if (!level.empty()) {
+                TestThread* first = level.front();
+                level.pop_front();
+                return first;
+            }
+        }
+        return nullptr;
+    };
+    const auto model_move = [&model](TestThread* thread, unsigned int from, unsigned int to) {
+        auto& level = model[from];
+        level.erase(std::find(level.begin(), level.end(), thread));
+        model[to].push_back(thread);
+    };
+
+    for (std::size_t i = 0; i < NumReschedules; ++i) {
+        TestThread* running = queue.pop_first();
+        REQUIRE(running == model_pop_first());
+
+        if (i % 16 == 0) {
+            // Boost a ready thread, then let it fall back to its nominal priority
+            TestThread& boosted = threads[i % NumThreads];
+            if (&boosted != running) {
+                queue.move(&boosted, boosted.priority, ThreadPrioUserlandMax - 1);
+                model_move(&boosted, boosted.priority, ThreadPrioUserlandMax - 1);
+                REQUIRE(queue.get_first() == &boosted);
+                REQUIRE(queue.contains(&boosted) == ThreadPrioUserlandMax - 1);
+
+                queue.move(&boosted, ThreadPrioUserlandMax - 1, boosted.priority);
+                model_move(&boosted, ThreadPrioUserlandMax - 1, boosted.priority);
+                REQUIRE(queue.contains(&boosted) == boosted.priority);
+            }
+        }
+
+        queue.push_back(running->priority, running);
+        model[running->priority].push_back(running);
+    }
+
+    for (std::size_t i = 0; i < NumThreads; ++i)
+        REQUIRE(queue.pop_first() == model_pop_first());
+    REQUIRE(queue.get_first() == nullptr);
+}
+
+TEST_CASE("ThreadQueueList scheduling benchmark", "[.benchmark][core][kernel]") {
+    // Same reschedule and boost pattern as above, timed without the model checks.
+    constexpr std::size_t NumThreads = 64;
+    constexpr std::size_t NumReschedules = 10'000'000;
+
+    ReadyQueue queue;
+    std::vector<TestThread> threads(NumThreads);
+    for (std::size_t i = 0; i < NumThreads; ++i) {
+        threads[i].priority = ThreadPrioUserlandMax + static_cast<unsigned int>(i % 8) * 4;
+        queue.push_back(threads[i].priority, &threads[i]);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < NumReschedules; ++i) {
+        TestThread* running = queue.pop_first();
+
+        if (i % 16 == 0) {
+            TestThread& boosted = threads[i % NumThreads];
+            if (&boosted != running) {
+                queue.move(&boosted, boosted.priority, ThreadPrioUserlandMax - 1);
+                queue.move(&boosted, ThreadPrioUserlandMax - 1, boosted.priority);
+            }
+        }
+
+        queue.push_back(running->priority, running);
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    REQUIRE(queue.get_first() != nullptr);
+    WARN("ThreadQueueList: " << elapsed.count() / NumReschedules << " ns per reschedule with "
+                             << NumThreads << " ready threads");
+}
+
+} // namespace Kernel
@@ -0,0 +1,161 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+namespace {
+
+constexpr VAddr EntryPoint = 0x00100000;
+constexpr VAddr DataAddress = 0x10000000;
+
+std::vector<Thread*> ToPointers(const std::vector<std::shared_ptr<Thread>>& threads) {
+    std::vector<Thread*> pointers;
+    for (const auto& thread : threads)
+        pointers.push_back(thread.get());
+    return pointers;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ThreadWaitQueue", "[core][kernel]") {
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    KernelSystem kernel(memory, timing, [] {}, 0);
+    kernel.SetCPUs({std::make_shared<ARM_DynCom>(nullptr, memory, USER32MODE)});
+
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    std::vector<u8> code(Memory::PAGE_SIZE);
+    std::vector<u8> data(Memory::PAGE_SIZE);
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(EntryPoint, code.data(), code.size(), MemoryState::Code)
+                .Code() == RESULT_SUCCESS);
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(DataAddress, data.data(), data.size(), MemoryState::Private)
+                .Code() == RESULT_SUCCESS);
+
+    ThreadManager& thread_manager = kernel.GetThreadManager();
+
+    // Creates a thread and runs it, as only the running thread can start waiting. Threads are
+    // started one at a time so that they start waiting in the order the test asks for.
+    const auto run_new_thread = [&kernel, &process, &thread_manager](u32 priority) {
+        auto thread = kernel.CreateThread("thread", EntryPoint, priority, 0, ThreadProcessorId0,
+                                          Memory::HEAP_VADDR_END, *process);
+        REQUIRE(thread.Succeeded());
+        thread_manager.Reschedule();
+        REQUIRE(thread_manager.GetCurrentThread() == thread->get());
+        return thread.Unwrap();
+    };
+
+    SECTION("wait objects wake up threads by priority, then in the order they started waiting") {
+        auto event = kernel.CreateEvent(ResetType::Sticky);
+        std::vector<Thread*> woken;
+        const auto wait_on_event = [&](u32 priority) {
+            auto thread = run_new_thread(priority);
+            thread->status = ThreadStatus::WaitSynchAny;
+            thread->wait_objects = {event};
+            thread->wakeup_callback = [&woken](ThreadWakeupReason reason,
+                                               std::shared_ptr<Thread> woken_thread,
+                                               std::shared_ptr<WaitObject> object) {
+                REQUIRE(reason == ThreadWakeupReason::Signal);
+                woken.push_back(woken_thread.get());
+            };
+            event->AddWaitingThread(thread);
+            thread_manager.Reschedule();
+            return thread;
+        };
+
+        auto low_first = wait_on_event(40);
+        auto mid_first = wait_on_event(30);
+        auto low_second = wait_on_event(40);
+        auto high = wait_on_event(20);
+        auto mid_second = wait_on_event(30);
+
+        const std::vector<Thread*> expected{high.get(), mid_first.get(), mid_second.get(),
+                                            low_first.get(), low_second.get()};
+        REQUIRE(event->GetHighestPriorityWaitingThread() == high.get());
+        REQUIRE(ToPointers(event->GetWaitingThreads()) == expected);
+
+        SECTION("on signal") {
+            event->Signal();
+            CHECK(woken == expected);
+            CHECK(event->GetWaitingThreads().empty());
+            for (Thread* thread : expected)
+                CHECK(thread->status == ThreadStatus::Ready);
+        }
+
+        SECTION("after SetPriority and BoostPriority") {
+            // A changed thread goes after the threads already waiting at its new priority
+            low_second->SetPriority(30);
+            REQUIRE(ToPointers(event->GetWaitingThreads()) ==
+                    std::vector<Thread*>{high.get(), mid_first.get(), mid_second.get(),
+                                         low_second.get(), low_first.get()});
+
+            mid_second->BoostPriority(10);
+            REQUIRE(event->GetHighestPriorityWaitingThread() == mid_second.get());
+
+            high->SetPriority(50);
+
+            event->Signal();
+            CHECK(woken == std::vector<Thread*>{mid_second.get(), mid_first.get(),
+                                                low_second.get(), low_first.get(), high.get()});
+        }
+    }
+
+    SECTION("address arbiters resume threads by priority and requeue them on priority changes") {
+        auto arbiter = kernel.CreateAddressArbiter();
+        const auto wait_on_address = [&](u32 priority) {
+            auto thread = run_new_thread(priority);
+            // The value at the address is 0, so the thread waits
+            REQUIRE(arbiter->ArbitrateAddress(thread, ArbitrationType::WaitIfLessThan,
+                                              DataAddress, 1, 0) == RESULT_SUCCESS);
+            REQUIRE(thread->status == ThreadStatus::WaitArb);
+            REQUIRE(thread->wait_arbiter == arbiter.get());
+            thread_manager.Reschedule();
+            return thread;
+        };
+        const auto signal_one = [&arbiter] {
+            REQUIRE(arbiter->ArbitrateAddress(nullptr, ArbitrationType::Signal, DataAddress, 1,
+                                              0) == RESULT_SUCCESS);
+        };
+
+        auto first = wait_on_address(30);
+        auto low = wait_on_address(40);
+        auto second = wait_on_address(30);
+        auto last = wait_on_address(35);
+
+        signal_one();
+        CHECK(first->status == ThreadStatus::Ready);
+        CHECK(first->wait_arbiter == nullptr);
+        CHECK(low->status == ThreadStatus::WaitArb);
+        CHECK(second->status == ThreadStatus::WaitArb);
+
+        // The lowest priority thread overtakes the other one once boosted
+        low->BoostPriority(20);
+        signal_one();
+        CHECK(low->status == ThreadStatus::Ready);
+        CHECK(second->status == ThreadStatus::WaitArb);
+
+        second->SetPriority(45);
+        signal_one();
+        CHECK(last->status == ThreadStatus::Ready);
+        CHECK(second->status == ThreadStatus::WaitArb);
+
+        signal_one();
+        CHECK(second->status == ThreadStatus::Ready);
+    }
+}
+
+} // namespace Kernel
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <iterator>
 #include <vector>
 #include <catch2/catch.hpp>
 #include "core/hle/kernel/errors.h"
@@ -137,3 +139,181 @@ TEST_CASE("Memory Basics", "[kernel][memory]") {
         REQUIRE(code == RESULT_SUCCESS);
     }
 }
+
+TEST_CASE("VMManager range updates", "[kernel][memory]") {
+    constexpr u32 NumPages = 16;
+    std::vector<u8> block(NumPages * Memory::PAGE_SIZE);
+    Memory::MemorySystem memory;
+    auto manager = std::make_unique<Kernel::VMManager>(memory);
+
+    auto result = manager->MapBackingMemory(Memory::HEAP_VADDR, block.data(),
+                                            static_cast<u32>(block.size()),
+                                            Kernel::MemoryState::Private);
+    REQUIRE(result.Code() == RESULT_SUCCESS);
+
+    const auto& page_table = manager->page_table;
+    const u32 first_page = Memory::HEAP_VADDR >> Memory::PAGE_BITS;
+    for (u32 i = 0; i < NumPages; ++i) {
+        CHECK(page_table.attributes[first_page + i] == Memory::PageType::Memory);
+        CHECK(page_table.pointers[first_page + i] == block.data() + i * Memory::PAGE_SIZE);
+    }
+    CHECK(page_table.attributes[first_page + NumPages] == Memory::PageType::Unmapped);
+
+    SECTION("reprotecting keeps the pages mapped") {
+        REQUIRE(manager->ReprotectRange(Memory::HEAP_VADDR + Memory::PAGE_SIZE,
+                                        Memory::PAGE_SIZE,
+                                        Kernel::VMAPermission::Read) == RESULT_SUCCESS);
+        CHECK(page_table.pointers[first_page + 1] == block.data() + Memory::PAGE_SIZE);
+
+        // The lookup cache must follow VMAs being split and merged
+        CHECK(manager->FindVMA(Memory::HEAP_VADDR)->second.size == Memory::PAGE_SIZE);
+        CHECK(manager->FindVMA(Memory::HEAP_VADDR + Memory::PAGE_SIZE)->second.permissions ==
+              Kernel::VMAPermission::Read);
+        REQUIRE(manager->ReprotectRange(Memory::HEAP_VADDR + Memory::PAGE_SIZE,
+                                        Memory::PAGE_SIZE,
+                                        Kernel::VMAPermission::ReadWrite) == RESULT_SUCCESS);
+        CHECK(manager->FindVMA(Memory::HEAP_VADDR)->second.size == block.size());
+    }
+
+    SECTION("unmapping a range spanning several VMAs") {
+        REQUIRE(manager->ReprotectRange(Memory::HEAP_VADDR + 4 * Memory::PAGE_SIZE,
+                                        4 * Memory::PAGE_SIZE,
+                                        Kernel::VMAPermission::Read) == RESULT_SUCCESS);
+        REQUIRE(manager->UnmapRange(Memory::HEAP_VADDR + 2 * Memory::PAGE_SIZE,
+                                    8 * Memory::PAGE_SIZE) == RESULT_SUCCESS);
+
+        for (u32 i = 0; i < NumPages; ++i) {
+            const bool unmapped = i >= 2 && i < 10;
+            CHECK((page_table.attributes[first_page + i] == Memory::PageType::Unmapped) ==
+                  unmapped);
+            CHECK((page_table.pointers[first_page + i] == nullptr) == unmapped);
+        }
+        CHECK(manager->FindVMA(Memory::HEAP_VADDR + 5 * Memory::PAGE_SIZE)->second.type ==
+              Kernel::VMAType::Free);
+    }
+}
+
+TEST_CASE("VMManager lookup cache", "[kernel][memory]") {
+    constexpr u32 ChunkSize = 4 * Memory::PAGE_SIZE;
+    std::vector<u8> block(2 * ChunkSize);
+    Memory::MemorySystem memory;
+    auto manager = std::make_unique<Kernel::VMManager>(memory);
+
+    const VAddr first = Memory::HEAP_VADDR;
+    const VAddr second = Memory::HEAP_VADDR + ChunkSize;
+    const VAddr after = Memory::HEAP_VADDR + 2 * ChunkSize;
+
+    // Looks the address up, which caches its VMA, and checks the result against a plain search
+    const auto lookup = [&manager](VAddr address) {
+        const auto vma = manager->FindVMA(address);
+        REQUIRE(vma == std::prev(manager->vma_map.upper_bound(address)));
+        REQUIRE(address - vma->second.base < vma->second.size);
+        return vma;
+    };
+
+    SECTION("after mapping into the cached VMA") {
+        REQUIRE(lookup(second)->second.type == Kernel::VMAType::Free);
+        REQUIRE(manager
+                    ->MapBackingMemory(second, block.data() + ChunkSize, ChunkSize,
+                                       Kernel::MemoryState::Private)
+                    .Code() == RESULT_SUCCESS);
+
+        CHECK(lookup(second)->second.type == Kernel::VMAType::BackingMemory);
+        CHECK(lookup(second)->second.size == ChunkSize);
+        CHECK(lookup(first)->second.type == Kernel::VMAType::Free);
+        CHECK(lookup(after)->second.type == Kernel::VMAType::Free);
+    }
+
+    SECTION("after unmapping the cached VMA") {
+        REQUIRE(manager
+                    ->MapBackingMemory(second, block.data() + ChunkSize, ChunkSize,
+                                       Kernel::MemoryState::Private)
+                    .Code() == RESULT_SUCCESS);
+        REQUIRE(lookup(second)->second.type == Kernel::VMAType::BackingMemory);
+
+        // The unmapped VMA is merged with the free ones around it
+        REQUIRE(manager->UnmapRange(second, ChunkSize) == RESULT_SUCCESS);
+        const auto vma = lookup(second);
+        CHECK(vma->second.type == Kernel::VMAType::Free);
+        CHECK(vma->second.base < first);
+        CHECK(lookup(first) == vma);
+        CHECK(lookup(after) == vma);
+    }
+
+    SECTION("after the cached VMA is merged into another") {
+        REQUIRE(manager->MapBackingMemory(first, block.data(), ChunkSize,
+                                          Kernel::MemoryState::Private)
+                    .Code() == RESULT_SUCCESS);
+        REQUIRE(lookup(first)->second.size == ChunkSize);
+
+        // Mapping the rest of the block right after it extends the first VMA
+        REQUIRE(manager
+                    ->MapBackingMemory(second, block.data() + ChunkSize, ChunkSize,
+                                       Kernel::MemoryState::Private)
+                    .Code() == RESULT_SUCCESS);
+        auto vma = lookup(second);
+        CHECK(vma->second.base == first);
+        CHECK(vma->second.size == 2 * ChunkSize);
+
+        // Reprotecting splits the VMA then merges it back
+        REQUIRE(manager->ReprotectRange(second, ChunkSize, Kernel::VMAPermission::Read) ==
+                RESULT_SUCCESS);
+        CHECK(lookup(second)->second.base == second);
+        CHECK(lookup(first)->second.size == ChunkSize);
+        REQUIRE(manager->ReprotectRange(second, ChunkSize, Kernel::VMAPermission::ReadWrite) ==
+                RESULT_SUCCESS);
+        vma = lookup(second);
+        CHECK(vma->second.base == first);
+        CHECK(vma->second.size == 2 * ChunkSize);
+        CHECK(lookup(first) == vma);
+
+        REQUIRE(manager->UnmapRange(first, 2 * ChunkSize) == RESULT_SUCCESS);
+        CHECK(lookup(second)->second.type == Kernel::VMAType::Free);
+    }
+
+    SECTION("after resetting") {
+        REQUIRE(manager->MapBackingMemory(first, block.data(), ChunkSize,
+                                          Kernel::MemoryState::Private)
+                    .Code() == RESULT_SUCCESS);
+        REQUIRE(lookup(first)->second.type == Kernel::VMAType::BackingMemory);
+
+        manager->Reset();
+        CHECK(lookup(first)->second.type == Kernel::VMAType::Free);
+    }
+}
+
+TEST_CASE("VMManager benchmark", "[.benchmark][kernel][memory]") {
+    // Simulates a title growing and shrinking its heap with svcControlMemory, and changing the
+    // permissions of parts of it, while looking up addresses all over it.
+    constexpr u32 HeapSize = 32 * 1024 * 1024;
+    constexpr u32 ChunkSize = 1024 * 1024;
+    constexpr std::size_t NumIterations = 2'000;
+
+    std::vector<u8> heap(HeapSize);
+    Memory::MemorySystem memory;
+    auto manager = std::make_unique<Kernel::VMManager>(memory);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t lookups = 0;
+    for (std::size_t i = 0; i < NumIterations; ++i) {
+        for (u32 offset = 0; offset < HeapSize; offset += ChunkSize) {
+            auto result = manager->MapBackingMemory(Memory::HEAP_VADDR + offset,
+                                                    heap.data() + offset, ChunkSize,
+                                                    Kernel::MemoryState::Private);
+            REQUIRE(result.Code() == RESULT_SUCCESS);
+        }
+
+        REQUIRE(manager->ReprotectRange(Memory::HEAP_VADDR + ChunkSize, ChunkSize,
+                                        Kernel::VMAPermission::Read) == RESULT_SUCCESS);
+        for (u32 offset = 0; offset < HeapSize; offset += Memory::PAGE_SIZE, ++lookups) {
+            REQUIRE(manager->FindVMA(Memory::HEAP_VADDR + offset) != manager->vma_map.end());
+        }
+
+        REQUIRE(manager->UnmapRange(Memory::HEAP_VADDR, HeapSize) == RESULT_SUCCESS);
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    WARN("VMManager: " << elapsed.count() / NumIterations << " us per heap map, reprotect, "
+                       << lookups / NumIterations << " lookups and unmap");
+}
@@ -0,0 +1,45 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "video_core/regs.h"
+#include "video_core/renderer_opengl/gl_shader_gen.h"
+
+namespace OpenGL {
+
+TEST_CASE("FragmentUberShaderUniforms", "[video_core][renderer_opengl]") {
+    Pica::Regs regs{};
+    regs.lighting.disable.Assign(0);
+    regs.lighting.config0.config.Assign(Pica::LightingRegs::LightingConfig::Config1);
+    regs.lighting.config1.disable_lut_d0.Assign(0);
+    regs.lighting.config1.disable_lut_rr.Assign(0);
+    regs.framebuffer.output_merger.alpha_test.enable.Assign(1);
+    regs.framebuffer.output_merger.alpha_test.func.Assign(
+        Pica::FramebufferRegs::CompareFunc::GreaterThan);
+
+    PicaFSConfig config = PicaFSConfig::BuildFromRegs(regs);
+    REQUIRE(IsFragmentUberShaderCompatible(config));
+
+    const auto uniforms = FragmentUberShaderUniforms::BuildFromConfig(config);
+    REQUIRE(uniforms.alpha_test_func ==
+            static_cast<s32>(Pica::FramebufferRegs::CompareFunc::GreaterThan));
+    REQUIRE(uniforms.lighting_enable);
+    // Configuration 1 has no D0 sampler, but has a red reflection one
+    REQUIRE(uniforms.lighting_luts[0][0] == 0);
+    REQUIRE(uniforms.lighting_luts[4][0] == 1);
+    for (std::size_t i = 0; i < config.state.tev_stages.size(); ++i) {
+        REQUIRE(uniforms.tev_stages[i][0] == config.state.tev_stages[i].sources_raw);
+        REQUIRE(uniforms.tev_stages[i][2] == config.state.tev_stages[i].ops_raw);
+    }
+
+    SECTION("procedural textures and shadow rendering need their own shader") {
+        config.state.proctex.enable = true;
+        REQUIRE_FALSE(IsFragmentUberShaderCompatible(config));
+        config.state.proctex.enable = false;
+        config.state.shadow_rendering = true;
+        REQUIRE_FALSE(IsFragmentUberShaderCompatible(config));
+    }
+}
+
+} // namespace OpenGL
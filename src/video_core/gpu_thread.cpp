@@ -0,0 +1,103 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/gpu_thread.h"
+
+namespace VideoCore {
+
+GPUThread::GPUThread(Frontend::GraphicsContext& context)
+    : context(context), thread(&GPUThread::ThreadLoop, this) {}
+
+GPUThread::~GPUThread() {
+    {
+        std::lock_guard lock{mutex};
+        stop = true;
+    }
+    work_cv.notify_one();
+    thread.join();
+}
+
+u64 GPUThread::Push(std::function<void()> work) {
+    u64 fence;
+    {
+        std::lock_guard lock{mutex};
+        fence = ++last_fence;
+        queue.emplace(fence, std::move(work));
+    }
+    work_cv.notify_one();
+    return fence;
+}
+
+void GPUThread::WaitForFence(u64 fence) {
+    if (IsFenceSignaled(fence)) {
+        return;
+    }
+    std::unique_lock lock{mutex};
+    done_cv.wait(lock, [this, fence] { return IsFenceSignaled(fence); });
+}
+
+void GPUThread::WaitIdle() {
+    u64 fence;
+    {
+        std::lock_guard lock{mutex};
+        fence = last_fence;
+    }
+    WaitForFence(fence);
+}
+
+void GPUThread::Run(const std::function<void()>& work) {
+    if (IsGPUThread()) {
+        work();
+        return;
+    }
+    WaitForFence(Push(work));
+}
+
+void GPUThread::ThreadLoop() {
+    Common::SetCurrentThreadName("GPUThread");
+    MicroProfileOnThreadCreate("GPUThread");
+
+    bool has_context = false;
+    while (true) {
+        std::pair<u64, std::function<void()>> work;
+        {
+            std::unique_lock lock{mutex};
+            work_cv.wait(lock, [this] { return stop || !queue.empty(); });
+            if (queue.empty()) {
+                break;
+            }
+            work = std::move(queue.front());
+            queue.pop();
+        }
+
+        // The context is still current on the thread that created the renderer until the
+        // emulation starts, which is also when the first work gets submitted
+        if (!has_context) {
+            context.MakeCurrent();
+            has_context = true;
+        }
+
+        running_fence = work.first;
+        work.second();
+
+        {
+            std::lock_guard lock{mutex};
+            signaled_fence.store(work.first, std::memory_order_release);
+        }
+        done_cv.notify_all();
+    }
+
+    if (has_context) {
+        context.DoneCurrent();
+    }
+
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
+}
+
+} // namespace VideoCore
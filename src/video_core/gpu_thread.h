@@ -0,0 +1,91 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include "common/common_types.h"
+
+namespace Frontend {
+class GraphicsContext;
+} // namespace Frontend
+
+namespace VideoCore {
+
+/**
+ * Runs the work submitted to the GPU (command lists, memory fills, display transfers and buffer
+ * swaps) on a host thread of its own, in FIFO order, so that it overlaps with the emulation of the
+ * CPU. The thread takes over the graphics context of the renderer before running the first work.
+ */
+class GPUThread {
+public:
+    explicit GPUThread(Frontend::GraphicsContext& context);
+    ~GPUThread();
+
+    GPUThread(const GPUThread&) = delete;
+    GPUThread& operator=(const GPUThread&) = delete;
+
+    /**
+     * Queues some work.
+     * @return Fence that is signaled once the work is done
+     */
+    u64 Push(std::function<void()> work);
+
+    /// Whether the work of a fence is done
+    bool IsFenceSignaled(u64 fence) const {
+        return signaled_fence.load(std::memory_order_acquire) >= fence;
+    }
+
+    /// Waits for the work of a fence, and all the work queued before it, to be done
+    void WaitForFence(u64 fence);
+
+    /// Waits for all the queued work to be done
+    void WaitIdle();
+
+    /**
+     * Runs some work once all the work queued before it is done and waits for it. When called
+     * from the GPU thread itself, e.g. by the work it's running, the work is run right away.
+     */
+    void Run(const std::function<void()>& work);
+
+    /// Whether any work was submitted yet, after which the GPU thread owns the context
+    bool IsStarted() {
+        std::lock_guard lock{mutex};
+        return last_fence != 0;
+    }
+
+    /// Whether the calling thread is the GPU thread
+    bool IsGPUThread() const {
+        return std::this_thread::get_id() == thread.get_id();
+    }
+
+    /// Fence of the work that the GPU thread is running. Must only be called from the GPU thread.
+    u64 GetRunningFence() const {
+        return running_fence;
+    }
+
+private:
+    void ThreadLoop();
+
+    Frontend::GraphicsContext& context;
+
+    std::queue<std::pair<u64, std::function<void()>>> queue;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    u64 last_fence = 0;
+    std::atomic<u64> signaled_fence{0};
+    u64 running_fence = 0;
+    bool stop = false;
+
+    std::thread thread;
+};
+
+} // namespace VideoCore
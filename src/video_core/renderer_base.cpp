@@ -9,6 +9,11 @@
 #include "video_core/swrasterizer/swrasterizer.h"
 #include "video_core/video_core.h"
 
+RendererBase::ScreenConfig RendererBase::ScreenConfig::Read() {
+    return {{GPU::g_regs.framebuffer_config[0], GPU::g_regs.framebuffer_config[1]},
+            {LCD::g_regs.color_fill_top, LCD::g_regs.color_fill_bottom}};
+}
+
 RendererBase::RendererBase(Frontend::EmuWindow& window) : render_window{window} {}
 RendererBase::~RendererBase() = default;
 void RendererBase::UpdateCurrentFramebufferLayout() {
@@ -4,9 +4,12 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include "common/common_types.h"
 #include "core/frontend/emu_window.h"
+#include "core/hw/gpu.h"
+#include "core/hw/lcd.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/video_core.h"
 
@@ -20,6 +23,15 @@ class Backend;
 
 class RendererBase : NonCopyable {
 public:
+    /// Configuration of the screens as of a buffer swap, for the top and the bottom screen
+    struct ScreenConfig {
+        std::array<GPU::Regs::FramebufferConfig, 2> framebuffers;
+        std::array<LCD::Regs::ColorFill, 2> color_fills;
+
+        /// Reads the configuration from the GPU and LCD registers
+        static ScreenConfig Read();
+    };
+
     explicit RendererBase(Frontend::EmuWindow& window);
     virtual ~RendererBase();
 
@@ -29,8 +41,11 @@ public:
     /// Shutdown the renderer
     virtual void ShutDown() = 0;
 
-    /// Finalize rendering the guest frame and draw into the presentation texture
-    virtual void SwapBuffers() = 0;
+    /**
+     * Finalize rendering the guest frame and draw into the presentation texture
+     * @param screens Configuration of the screens, read when the swap was requested
+     */
+    virtual void SwapBuffers(const ScreenConfig& screens) = 0;
 
     /// Draws the latest frame to the window waiting timeout_ms for a frame to arrive (Renderer
     /// specific implementation)
@@ -165,7 +165,8 @@ RasterizerOpenGL::RasterizerOpenGL(Frontend::EmuWindow& window)
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer.GetHandle());
 
     shader_program_manager =
-        std::make_unique<ShaderProgramManager>(GLAD_GL_ARB_separate_shader_objects, is_amd);
+        std::make_unique<ShaderProgramManager>(emu_window, GLAD_GL_ARB_separate_shader_objects,
+                                               is_amd);
 
     glEnable(GL_BLEND);
 
@@ -496,6 +497,8 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(OpenGL_Drawing);
     const auto& regs = Pica::g_state.regs;
 
+    SyncDirtyState();
+
     bool shadow_rendering = regs.framebuffer.output_merger.fragment_operation_mode ==
                             Pica::FramebufferRegs::FragmentOperationMode::Shadow;
 
@@ -863,30 +866,44 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
 void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     const auto& regs = Pica::g_state.regs;
 
+    // Fragment lighting light sources
+    constexpr u32 light_regs_begin = PICA_REG_INDEX(lighting.light[0]);
+    constexpr u32 light_regs_size = sizeof(Pica::LightingRegs::LightSrc) / sizeof(u32);
+    constexpr u32 light_regs_end = PICA_REG_INDEX(lighting.global_ambient);
+    if (id >= light_regs_begin && id < light_regs_end) {
+        const u32 light_index = (id - light_regs_begin) / light_regs_size;
+        if (id - light_index * light_regs_size == PICA_REG_INDEX(lighting.light[0].config)) {
+            shader_dirty = true;
+        } else {
+            MarkDirty(DirtyLight0 + light_index);
+        }
+        return;
+    }
+
     switch (id) {
     // Culling
     case PICA_REG_INDEX(rasterizer.cull_mode):
-        SyncCullMode();
+        MarkDirty(DirtyCullMode);
         break;
 
     // Clipping plane
     case PICA_REG_INDEX(rasterizer.clip_enable):
-        SyncClipEnabled();
+        MarkDirty(DirtyClipEnabled);
         break;
 
     case PICA_REG_INDEX(rasterizer.clip_coef[0]):
     case PICA_REG_INDEX(rasterizer.clip_coef[1]):
     case PICA_REG_INDEX(rasterizer.clip_coef[2]):
     case PICA_REG_INDEX(rasterizer.clip_coef[3]):
-        SyncClipCoef();
+        MarkDirty(DirtyClipCoef);
         break;
 
     // Depth modifiers
     case PICA_REG_INDEX(rasterizer.viewport_depth_range):
-        SyncDepthScale();
+        MarkDirty(DirtyDepthScale);
         break;
     case PICA_REG_INDEX(rasterizer.viewport_depth_near_plane):
-        SyncDepthOffset();
+        MarkDirty(DirtyDepthOffset);
         break;
 
     // Depth buffering
@@ -896,23 +913,23 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
 
     // Blending
     case PICA_REG_INDEX(framebuffer.output_merger.alphablend_enable):
-        SyncBlendEnabled();
+        MarkDirty(DirtyBlendEnabled);
         break;
     case PICA_REG_INDEX(framebuffer.output_merger.alpha_blending):
-        SyncBlendFuncs();
+        MarkDirty(DirtyBlendFuncs);
         break;
     case PICA_REG_INDEX(framebuffer.output_merger.blend_const):
-        SyncBlendColor();
+        MarkDirty(DirtyBlendColor);
         break;
 
     // Shadow texture
     case PICA_REG_INDEX(texturing.shadow):
-        SyncShadowTextureBias();
+        MarkDirty(DirtyShadowTextureBias);
         break;
 
     // Fog state
     case PICA_REG_INDEX(texturing.fog_color):
-        SyncFogColor();
+        MarkDirty(DirtyFogColor);
         break;
     case PICA_REG_INDEX(texturing.fog_lut_data[0]):
     case PICA_REG_INDEX(texturing.fog_lut_data[1]):
@@ -929,14 +946,14 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(texturing.proctex):
     case PICA_REG_INDEX(texturing.proctex_lut):
     case PICA_REG_INDEX(texturing.proctex_lut_offset):
-        SyncProcTexBias();
+        MarkDirty(DirtyProcTexBias);
         shader_dirty = true;
         break;
 
     case PICA_REG_INDEX(texturing.proctex_noise_u):
     case PICA_REG_INDEX(texturing.proctex_noise_v):
     case PICA_REG_INDEX(texturing.proctex_noise_frequency):
-        SyncProcTexNoise();
+        MarkDirty(DirtyProcTexNoise);
         break;
 
     case PICA_REG_INDEX(texturing.proctex_lut_data[0]):
@@ -969,44 +986,44 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
 
     // Alpha test
     case PICA_REG_INDEX(framebuffer.output_merger.alpha_test):
-        SyncAlphaTest();
+        MarkDirty(DirtyAlphaTest);
         shader_dirty = true;
         break;
 
     // Sync GL stencil test + stencil write mask
     // (Pica stencil test function register also contains a stencil write mask)
     case PICA_REG_INDEX(framebuffer.output_merger.stencil_test.raw_func):
-        SyncStencilTest();
-        SyncStencilWriteMask();
+        MarkDirty(DirtyStencilTest);
+        MarkDirty(DirtyStencilWriteMask);
         break;
     case PICA_REG_INDEX(framebuffer.output_merger.stencil_test.raw_op):
     case PICA_REG_INDEX(framebuffer.framebuffer.depth_format):
-        SyncStencilTest();
+        MarkDirty(DirtyStencilTest);
         break;
 
     // Sync GL depth test + depth and color write mask
     // (Pica depth test function register also contains a depth and color write mask)
     case PICA_REG_INDEX(framebuffer.output_merger.depth_test_enable):
-        SyncDepthTest();
-        SyncDepthWriteMask();
-        SyncColorWriteMask();
+        MarkDirty(DirtyDepthTest);
+        MarkDirty(DirtyDepthWriteMask);
+        MarkDirty(DirtyColorWriteMask);
         break;
 
     // Sync GL depth and stencil write mask
     // (This is a dedicated combined depth / stencil write-enable register)
     case PICA_REG_INDEX(framebuffer.framebuffer.allow_depth_stencil_write):
-        SyncDepthWriteMask();
-        SyncStencilWriteMask();
+        MarkDirty(DirtyDepthWriteMask);
+        MarkDirty(DirtyStencilWriteMask);
         break;
 
     // Sync GL color write mask
     // (This is a dedicated color write-enable register)
     case PICA_REG_INDEX(framebuffer.framebuffer.allow_color_write):
-        SyncColorWriteMask();
+        MarkDirty(DirtyColorWriteMask);
         break;
 
     case PICA_REG_INDEX(framebuffer.shadow):
-        SyncShadowBias();
+        MarkDirty(DirtyShadowBias);
         break;
 
     // Scissor test
@@ -1016,7 +1033,7 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
 
     // Logic op
     case PICA_REG_INDEX(framebuffer.output_merger.logic_op):
-        SyncLogicOp();
+        MarkDirty(DirtyLogicOp);
         break;
 
     case PICA_REG_INDEX(texturing.main_config):
@@ -1058,27 +1075,17 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
         shader_dirty = true;
         break;
     case PICA_REG_INDEX(texturing.tev_stage0.const_r):
-        SyncTevConstColor(0, regs.texturing.tev_stage0);
-        break;
     case PICA_REG_INDEX(texturing.tev_stage1.const_r):
-        SyncTevConstColor(1, regs.texturing.tev_stage1);
-        break;
     case PICA_REG_INDEX(texturing.tev_stage2.const_r):
-        SyncTevConstColor(2, regs.texturing.tev_stage2);
-        break;
     case PICA_REG_INDEX(texturing.tev_stage3.const_r):
-        SyncTevConstColor(3, regs.texturing.tev_stage3);
-        break;
     case PICA_REG_INDEX(texturing.tev_stage4.const_r):
-        SyncTevConstColor(4, regs.texturing.tev_stage4);
-        break;
     case PICA_REG_INDEX(texturing.tev_stage5.const_r):
-        SyncTevConstColor(5, regs.texturing.tev_stage5);
+        MarkDirty(DirtyTevConstColor);
         break;
 
     // TEV combiner buffer color
     case PICA_REG_INDEX(texturing.tev_combiner_buffer_color):
-        SyncCombinerColor();
+        MarkDirty(DirtyCombinerColor);
         break;
 
     // Fragment lighting switches
@@ -1092,245 +1099,9 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(lighting.light_enable):
         break;
 
-    // Fragment lighting specular 0 color
-    case PICA_REG_INDEX(lighting.light[0].specular_0):
-        SyncLightSpecular0(0);
-        break;
-    case PICA_REG_INDEX(lighting.light[1].specular_0):
-        SyncLightSpecular0(1);
-        break;
-    case PICA_REG_INDEX(lighting.light[2].specular_0):
-        SyncLightSpecular0(2);
-        break;
-    case PICA_REG_INDEX(lighting.light[3].specular_0):
-        SyncLightSpecular0(3);
-        break;
-    case PICA_REG_INDEX(lighting.light[4].specular_0):
-        SyncLightSpecular0(4);
-        break;
-    case PICA_REG_INDEX(lighting.light[5].specular_0):
-        SyncLightSpecular0(5);
-        break;
-    case PICA_REG_INDEX(lighting.light[6].specular_0):
-        SyncLightSpecular0(6);
-        break;
-    case PICA_REG_INDEX(lighting.light[7].specular_0):
-        SyncLightSpecular0(7);
-        break;
-
-    // Fragment lighting specular 1 color
-    case PICA_REG_INDEX(lighting.light[0].specular_1):
-        SyncLightSpecular1(0);
-        break;
-    case PICA_REG_INDEX(lighting.light[1].specular_1):
-        SyncLightSpecular1(1);
-        break;
-    case PICA_REG_INDEX(lighting.light[2].specular_1):
-        SyncLightSpecular1(2);
-        break;
-    case PICA_REG_INDEX(lighting.light[3].specular_1):
-        SyncLightSpecular1(3);
-        break;
-    case PICA_REG_INDEX(lighting.light[4].specular_1):
-        SyncLightSpecular1(4);
-        break;
-    case PICA_REG_INDEX(lighting.light[5].specular_1):
-        SyncLightSpecular1(5);
-        break;
-    case PICA_REG_INDEX(lighting.light[6].specular_1):
-        SyncLightSpecular1(6);
-        break;
-    case PICA_REG_INDEX(lighting.light[7].specular_1):
-        SyncLightSpecular1(7);
-        break;
-
-    // Fragment lighting diffuse color
-    case PICA_REG_INDEX(lighting.light[0].diffuse):
-        SyncLightDiffuse(0);
-        break;
-    case PICA_REG_INDEX(lighting.light[1].diffuse):
-        SyncLightDiffuse(1);
-        break;
-    case PICA_REG_INDEX(lighting.light[2].diffuse):
-        SyncLightDiffuse(2);
-        break;
-    case PICA_REG_INDEX(lighting.light[3].diffuse):
-        SyncLightDiffuse(3);
-        break;
-    case PICA_REG_INDEX(lighting.light[4].diffuse):
-        SyncLightDiffuse(4);
-        break;
-    case PICA_REG_INDEX(lighting.light[5].diffuse):
-        SyncLightDiffuse(5);
-        break;
-    case PICA_REG_INDEX(lighting.light[6].diffuse):
-        SyncLightDiffuse(6);
-        break;
-    case PICA_REG_INDEX(lighting.light[7].diffuse):
-        SyncLightDiffuse(7);
-        break;
-
-    // Fragment lighting ambient color
-    case PICA_REG_INDEX(lighting.light[0].ambient):
-        SyncLightAmbient(0);
-        break;
-    case PICA_REG_INDEX(lighting.light[1].ambient):
-        SyncLightAmbient(1);
-        break;
-    case PICA_REG_INDEX(lighting.light[2].ambient):
-        SyncLightAmbient(2);
-        break;
-    case PICA_REG_INDEX(lighting.light[3].ambient):
-        SyncLightAmbient(3);
-        break;
-    case PICA_REG_INDEX(lighting.light[4].ambient):
-        SyncLightAmbient(4);
-        break;
-    case PICA_REG_INDEX(lighting.light[5].ambient):
-        SyncLightAmbient(5);
-        break;
-    case PICA_REG_INDEX(lighting.light[6].ambient):
-        SyncLightAmbient(6);
-        break;
-    case PICA_REG_INDEX(lighting.light[7].ambient):
-        SyncLightAmbient(7);
-        break;
-
-    // Fragment lighting position
-    case PICA_REG_INDEX(lighting.light[0].x):
-    case PICA_REG_INDEX(lighting.light[0].z):
-        SyncLightPosition(0);
-        break;
-    case PICA_REG_INDEX(lighting.light[1].x):
-    case PICA_REG_INDEX(lighting.light[1].z):
-        SyncLightPosition(1);
-        break;
-    case PICA_REG_INDEX(lighting.light[2].x):
-    case PICA_REG_INDEX(lighting.light[2].z):
-        SyncLightPosition(2);
-        break;
-    case PICA_REG_INDEX(lighting.light[3].x):
-    case PICA_REG_INDEX(lighting.light[3].z):
-        SyncLightPosition(3);
-        break;
-    case PICA_REG_INDEX(lighting.light[4].x):
-    case PICA_REG_INDEX(lighting.light[4].z):
-        SyncLightPosition(4);
-        break;
-    case PICA_REG_INDEX(lighting.light[5].x):
-    case PICA_REG_INDEX(lighting.light[5].z):
-        SyncLightPosition(5);
-        break;
-    case PICA_REG_INDEX(lighting.light[6].x):
-    case PICA_REG_INDEX(lighting.light[6].z):
-        SyncLightPosition(6);
-        break;
-    case PICA_REG_INDEX(lighting.light[7].x):
-    case PICA_REG_INDEX(lighting.light[7].z):
-        SyncLightPosition(7);
-        break;
-
-    // Fragment spot lighting direction
-    case PICA_REG_INDEX(lighting.light[0].spot_x):
-    case PICA_REG_INDEX(lighting.light[0].spot_z):
-        SyncLightSpotDirection(0);
-        break;
-    case PICA_REG_INDEX(lighting.light[1].spot_x):
-    case PICA_REG_INDEX(lighting.light[1].spot_z):
-        SyncLightSpotDirection(1);
-        break;
-    case PICA_REG_INDEX(lighting.light[2].spot_x):
-    case PICA_REG_INDEX(lighting.light[2].spot_z):
-        SyncLightSpotDirection(2);
-        break;
-    case PICA_REG_INDEX(lighting.light[3].spot_x):
-    case PICA_REG_INDEX(lighting.light[3].spot_z):
-        SyncLightSpotDirection(3);
-        break;
-    case PICA_REG_INDEX(lighting.light[4].spot_x):
-    case PICA_REG_INDEX(lighting.light[4].spot_z):
-        SyncLightSpotDirection(4);
-        break;
-    case PICA_REG_INDEX(lighting.light[5].spot_x):
-    case PICA_REG_INDEX(lighting.light[5].spot_z):
-        SyncLightSpotDirection(5);
-        break;
-    case PICA_REG_INDEX(lighting.light[6].spot_x):
-    case PICA_REG_INDEX(lighting.light[6].spot_z):
-        SyncLightSpotDirection(6);
-        break;
-    case PICA_REG_INDEX(lighting.light[7].spot_x):
-    case PICA_REG_INDEX(lighting.light[7].spot_z):
-        SyncLightSpotDirection(7);
-        break;
-
-    // Fragment lighting light source config
-    case PICA_REG_INDEX(lighting.light[0].config):
-    case PICA_REG_INDEX(lighting.light[1].config):
-    case PICA_REG_INDEX(lighting.light[2].config):
-    case PICA_REG_INDEX(lighting.light[3].config):
-    case PICA_REG_INDEX(lighting.light[4].config):
-    case PICA_REG_INDEX(lighting.light[5].config):
-    case PICA_REG_INDEX(lighting.light[6].config):
-    case PICA_REG_INDEX(lighting.light[7].config):
-        shader_dirty = true;
-        break;
-
-    // Fragment lighting distance attenuation bias
-    case PICA_REG_INDEX(lighting.light[0].dist_atten_bias):
-        SyncLightDistanceAttenuationBias(0);
-        break;
-    case PICA_REG_INDEX(lighting.light[1].dist_atten_bias):
-        SyncLightDistanceAttenuationBias(1);
-        break;
-    case PICA_REG_INDEX(lighting.light[2].dist_atten_bias):
-        SyncLightDistanceAttenuationBias(2);
-        break;
-    case PICA_REG_INDEX(lighting.light[3].dist_atten_bias):
-        SyncLightDistanceAttenuationBias(3);
-        break;
-    case PICA_REG_INDEX(lighting.light[4].dist_atten_bias):
-        SyncLightDistanceAttenuationBias(4);
-        break;
-    case PICA_REG_INDEX(lighting.light[5].dist_atten_bias):
-        SyncLightDistanceAttenuationBias(5);
-        break;
-    case PICA_REG_INDEX(lighting.light[6].dist_atten_bias):
-        SyncLightDistanceAttenuationBias(6);
-        break;
-    case PICA_REG_INDEX(lighting.light[7].dist_atten_bias):
-        SyncLightDistanceAttenuationBias(7);
-        break;
-
-    // Fragment lighting distance attenuation scale
-    case PICA_REG_INDEX(lighting.light[0].dist_atten_scale):
-        SyncLightDistanceAttenuationScale(0);
-        break;
-    case PICA_REG_INDEX(lighting.light[1].dist_atten_scale):
-        SyncLightDistanceAttenuationScale(1);
-        break;
-    case PICA_REG_INDEX(lighting.light[2].dist_atten_scale):
-        SyncLightDistanceAttenuationScale(2);
-        break;
-    case PICA_REG_INDEX(lighting.light[3].dist_atten_scale):
-        SyncLightDistanceAttenuationScale(3);
-        break;
-    case PICA_REG_INDEX(lighting.light[4].dist_atten_scale):
-        SyncLightDistanceAttenuationScale(4);
-        break;
-    case PICA_REG_INDEX(lighting.light[5].dist_atten_scale):
-        SyncLightDistanceAttenuationScale(5);
-        break;
-    case PICA_REG_INDEX(lighting.light[6].dist_atten_scale):
-        SyncLightDistanceAttenuationScale(6);
-        break;
-    case PICA_REG_INDEX(lighting.light[7].dist_atten_scale):
-        SyncLightDistanceAttenuationScale(7);
-        break;
-
     // Fragment lighting global ambient color (emission + ambient * ambient)
     case PICA_REG_INDEX(lighting.global_ambient):
-        SyncGlobalAmbient();
+        MarkDirty(DirtyGlobalAmbient);
         break;
 
     // Fragment lighting lookup tables
@@ -1371,6 +1142,14 @@ void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
+void RasterizerOpenGL::NotifyFrameEnd() {
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    res_cache.EndFrame();
+
+    MICROPROFILE_META_CPU("Redundant State Writes", static_cast<int>(redundant_state_writes));
+    redundant_state_writes = 0;
+}
+
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
     MICROPROFILE_SCOPE(OpenGL_Blits);
 
@@ -1419,6 +1198,10 @@ bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransfe
         return false;
 
     res_cache.InvalidateRegion(dst_params.addr, dst_params.size, dst_surface);
+
+    // The source is usually done being rendered to by now, so if the CPU reads it back, let it
+    // find the data downloaded already
+    res_cache.StartDownload(src_surface);
     return true;
 }
 
@@ -1633,6 +1416,91 @@ void RasterizerOpenGL::SetShader() {
     shader_program_manager->UseFragmentShader(Pica::g_state.regs);
 }
 
+void RasterizerOpenGL::MarkDirty(std::size_t dirty_state_index) {
+    if (dirty_state[dirty_state_index]) {
+        ++redundant_state_writes;
+    } else {
+        dirty_state.set(dirty_state_index);
+    }
+}
+
+void RasterizerOpenGL::SyncDirtyState() {
+    if (dirty_state.none()) {
+        return;
+    }
+
+    const auto is_dirty = [this](std::size_t index) { return dirty_state[index]; };
+
+    // Sync fixed function OpenGL state
+    if (is_dirty(DirtyClipEnabled))
+        SyncClipEnabled();
+    if (is_dirty(DirtyCullMode))
+        SyncCullMode();
+    if (is_dirty(DirtyBlendEnabled))
+        SyncBlendEnabled();
+    if (is_dirty(DirtyBlendFuncs))
+        SyncBlendFuncs();
+    if (is_dirty(DirtyBlendColor))
+        SyncBlendColor();
+    if (is_dirty(DirtyLogicOp))
+        SyncLogicOp();
+    if (is_dirty(DirtyStencilTest))
+        SyncStencilTest();
+    if (is_dirty(DirtyDepthTest))
+        SyncDepthTest();
+    if (is_dirty(DirtyColorWriteMask))
+        SyncColorWriteMask();
+    if (is_dirty(DirtyStencilWriteMask))
+        SyncStencilWriteMask();
+    if (is_dirty(DirtyDepthWriteMask))
+        SyncDepthWriteMask();
+
+    // Sync uniforms
+    if (is_dirty(DirtyClipCoef))
+        SyncClipCoef();
+    if (is_dirty(DirtyDepthScale))
+        SyncDepthScale();
+    if (is_dirty(DirtyDepthOffset))
+        SyncDepthOffset();
+    if (is_dirty(DirtyAlphaTest))
+        SyncAlphaTest();
+    if (is_dirty(DirtyCombinerColor))
+        SyncCombinerColor();
+    if (is_dirty(DirtyTevConstColor)) {
+        const auto& tev_stages = Pica::g_state.regs.texturing.GetTevStages();
+        for (std::size_t index = 0; index < tev_stages.size(); ++index)
+            SyncTevConstColor(index, tev_stages[index]);
+    }
+
+    if (is_dirty(DirtyGlobalAmbient))
+        SyncGlobalAmbient();
+    for (unsigned light_index = 0; light_index < 8; light_index++) {
+        if (!is_dirty(DirtyLight0 + light_index))
+            continue;
+        SyncLightSpecular0(light_index);
+        SyncLightSpecular1(light_index);
+        SyncLightDiffuse(light_index);
+        SyncLightAmbient(light_index);
+        SyncLightPosition(light_index);
+        SyncLightSpotDirection(light_index);
+        SyncLightDistanceAttenuationBias(light_index);
+        SyncLightDistanceAttenuationScale(light_index);
+    }
+
+    if (is_dirty(DirtyFogColor))
+        SyncFogColor();
+    if (is_dirty(DirtyProcTexNoise))
+        SyncProcTexNoise();
+    if (is_dirty(DirtyProcTexBias))
+        SyncProcTexBias();
+    if (is_dirty(DirtyShadowBias))
+        SyncShadowBias();
+    if (is_dirty(DirtyShadowTextureBias))
+        SyncShadowTextureBias();
+
+    dirty_state.reset();
+}
+
 void RasterizerOpenGL::SyncClipEnabled() {
     state.clip_distance[1] = Pica::g_state.regs.rasterizer.clip_enable != 0;
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <cstddef>
 #include <cstring>
 #include <memory>
@@ -53,6 +54,7 @@ public:
     void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override;
     void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    void NotifyFrameEnd() override;
     bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) override;
@@ -131,6 +133,41 @@ private:
         GLvec3 view;
     };
 
+    /// Groups of state synced from the PICA registers, deferred until the next draw
+    enum DirtyState : std::size_t {
+        DirtyClipEnabled,
+        DirtyClipCoef,
+        DirtyCullMode,
+        DirtyDepthScale,
+        DirtyDepthOffset,
+        DirtyBlendEnabled,
+        DirtyBlendFuncs,
+        DirtyBlendColor,
+        DirtyFogColor,
+        DirtyProcTexNoise,
+        DirtyProcTexBias,
+        DirtyAlphaTest,
+        DirtyLogicOp,
+        DirtyColorWriteMask,
+        DirtyStencilWriteMask,
+        DirtyDepthWriteMask,
+        DirtyStencilTest,
+        DirtyDepthTest,
+        DirtyCombinerColor,
+        DirtyTevConstColor, ///< Constant colors of all the TEV stages
+        DirtyGlobalAmbient,
+        DirtyLight0, ///< Colors, position, direction and attenuation of light 0, then 1 to 7
+        DirtyShadowBias = DirtyLight0 + 8,
+        DirtyShadowTextureBias,
+        NumDirtyStates,
+    };
+
+    /// Marks a group of state to be synced at the next draw
+    void MarkDirty(std::size_t dirty_state_index);
+
+    /// Syncs the state marked dirty since the last draw
+    void SyncDirtyState();
+
     /// Syncs entire status to match PICA registers
     void SyncEntireState();
 
@@ -274,6 +311,10 @@ private:
 
     bool shader_dirty;
 
+    std::bitset<NumDirtyStates> dirty_state;
+    /// Writes to state already marked dirty in this frame, each of which used to be synced
+    u64 redundant_state_writes = 0;
+
     struct {
         UniformData data;
         std::array<bool, Pica::LightingRegs::NumLightingSampler> lighting_lut_dirty;
@@ -670,6 +670,8 @@ void RasterizerCacheOpenGL::CopySurface(const Surface& src_surface, const Surfac
 
     ASSERT(src_surface != dst_surface);
 
+    dst_surface->TextureChanged();
+
     // This is only called when CanCopy is true, no need to run checks here
     if (src_surface->type == SurfaceType::Fill) {
         // FillSurface needs a 4 bytes buffer
@@ -896,6 +898,8 @@ void CachedSurface::UploadGLTexture(const Common::Rectangle<u32>& rect, GLuint r
 
     ASSERT(gl_buffer_size == width * height * GetGLBytesPerPixel(pixel_format));
 
+    TextureChanged();
+
     // Read custom texture
     Core::CustomTexCache& custom_tex_cache = Core::System::GetInstance().CustomTexCache();
     std::string dump_path; // Has to be declared here for logging later
@@ -1003,6 +1007,125 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint
         gl_buffer.reset(new u8[gl_buffer_size]);
     }
 
+    ReadGLTexture(rect, read_fb_handle, draw_fb_handle, gl_buffer.get());
+}
+
+MICROPROFILE_DEFINE(OpenGL_TextureDLStart, "OpenGL", "Texture Download Start",
+                    MP_RGB(128, 192, 64));
+void CachedSurface::StartDownload(SurfaceInterval interval, GLuint read_fb_handle,
+                                  GLuint draw_fb_handle) {
+    if (type == SurfaceType::Fill) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_TextureDLStart);
+
+    DiscardDownload();
+
+    if (download_buffer.handle == 0) {
+        const GLsizeiptr size = width * height * GetGLBytesPerPixel(pixel_format);
+        download_buffer.Create();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, download_buffer.handle);
+        if (GLAD_GL_ARB_buffer_storage) {
+            const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_PACK_BUFFER, size, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+            download_buffer_ptr =
+                static_cast<u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, flags));
+        } else {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        }
+    } else {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, download_buffer.handle);
+    }
+
+    // Download the outer rectangle of the region, which is laid out in the buffer like gl_buffer
+    const SurfaceParams params = FromInterval(interval);
+    ReadGLTexture(GetSubRect(params), read_fb_handle, draw_fb_handle, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    download_fence.Create();
+    download_interval = params.GetInterval();
+}
+
+MICROPROFILE_DEFINE(OpenGL_TextureDLWait, "OpenGL", "Texture Download Wait",
+                    MP_RGB(128, 192, 64));
+bool CachedSurface::FinishDownload(SurfaceInterval interval) {
+    if (!boost::icl::contains(download_interval, interval)) {
+        return false;
+    }
+    if (download_fence.handle == nullptr) {
+        // Already moved to gl_buffer by an earlier flush
+        return true;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_TextureDLWait);
+
+    glClientWaitSync(download_fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    download_fence.Release();
+
+    if (gl_buffer == nullptr) {
+        gl_buffer_size = width * height * GetGLBytesPerPixel(pixel_format);
+        gl_buffer.reset(new u8[gl_buffer_size]);
+    }
+
+    const u32 bytes_per_pixel = GetGLBytesPerPixel(pixel_format);
+    const auto rect = GetSubRect(FromInterval(download_interval));
+    const u8* src_buffer = download_buffer_ptr;
+    if (src_buffer == nullptr) {
+        const std::size_t end = ((rect.top - 1) * stride + rect.right) * bytes_per_pixel;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, download_buffer.handle);
+        src_buffer = static_cast<const u8*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, end, GL_MAP_READ_BIT));
+    }
+
+    // Only copy the rectangle, the rest of the rows may hold newer data in gl_buffer
+    const std::size_t row_size = rect.GetWidth() * bytes_per_pixel;
+    for (u32 y = rect.bottom; y < rect.top; ++y) {
+        const std::size_t offset = (y * stride + rect.left) * bytes_per_pixel;
+        std::memcpy(&gl_buffer[offset], src_buffer + offset, row_size);
+    }
+
+    if (download_buffer_ptr == nullptr) {
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    return true;
+}
+
+void CachedSurface::DiscardDownload() {
+    download_fence.Release();
+    download_interval = {};
+}
+
+void CachedSurface::TextureChanged() {
+    DiscardDownload();
+    loaded_interval = {};
+}
+
+MICROPROFILE_DEFINE(OpenGL_SurfaceHash, "OpenGL", "Surface Hash", MP_RGB(128, 192, 64));
+u64 CachedSurface::HashMemory(PAddr start, PAddr end) const {
+    const u8* const texture_src_data = VideoCore::g_memory->GetPhysicalPointer(addr);
+    if (texture_src_data == nullptr) {
+        return 0;
+    }
+
+    // Same as LoadGLBuffer()
+    if (start < Memory::VRAM_VADDR_END && end > Memory::VRAM_VADDR_END) {
+        end = Memory::VRAM_VADDR_END;
+    }
+
+    if (start < Memory::VRAM_VADDR && end > Memory::VRAM_VADDR) {
+        start = Memory::VRAM_VADDR;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_SurfaceHash);
+
+    ASSERT(start >= addr && end <= this->end);
+    return Common::ComputeHash64(texture_src_data + (start - addr), end - start);
+}
+
+void CachedSurface::ReadGLTexture(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
+                                  GLuint draw_fb_handle, u8* dst_buffer) {
     OpenGLState state = OpenGLState::GetCurState();
     OpenGLState prev_state = state;
     SCOPE_EXIT({ prev_state.Apply(); });
@@ -1012,8 +1135,11 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint
     // Ensure no bad interactions with GL_PACK_ALIGNMENT
     ASSERT(stride * GetGLBytesPerPixel(pixel_format) % 4 == 0);
     glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(stride));
-    std::size_t buffer_offset =
+    const std::size_t buffer_offset =
         (rect.bottom * stride + rect.left) * GetGLBytesPerPixel(pixel_format);
+    // An offset into the pixel pack buffer if there's no destination buffer
+    void* const pixels = dst_buffer != nullptr ? static_cast<void*>(dst_buffer + buffer_offset)
+                                               : reinterpret_cast<void*>(buffer_offset);
 
     // If not 1x scale, blit scaled texture to a new 1x texture and use that to flush
     if (res_scale != 1) {
@@ -1035,7 +1161,7 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint
         state.Apply();
 
         glActiveTexture(GL_TEXTURE0);
-        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, &gl_buffer[buffer_offset]);
+        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, pixels);
     } else {
         state.ResetTexture(texture.handle);
         state.draw.read_framebuffer = read_fb_handle;
@@ -1058,7 +1184,7 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint
         }
         glReadPixels(static_cast<GLint>(rect.left), static_cast<GLint>(rect.bottom),
                      static_cast<GLsizei>(rect.GetWidth()), static_cast<GLsizei>(rect.GetHeight()),
-                     tuple.format, tuple.type, &gl_buffer[buffer_offset]);
+                     tuple.format, tuple.type, pixels);
     }
 
     glPixelStorei(GL_PACK_ROW_LENGTH, 0);
@@ -1227,6 +1353,13 @@ RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
     while (!surface_cache.empty()) {
         UnregisterSurface(*surface_cache.begin()->second.begin());
     }
+
+    if (skipped_uploads != 0) {
+        LOG_INFO(Render_OpenGL, "Skipped {} uploads of unchanged surface data ({} KiB)",
+                 skipped_uploads, skipped_upload_bytes / 1024);
+    }
+    LOG_INFO(Render_OpenGL, "Surfaces used {} MiB at most, {} were evicted and {} re-created",
+             peak_resident_bytes >> 20, num_evictions, num_recreations);
 }
 
 MICROPROFILE_DEFINE(OpenGL_BlitSurface, "OpenGL", "BlitSurface", MP_RGB(128, 192, 64));
@@ -1240,6 +1373,7 @@ bool RasterizerCacheOpenGL::BlitSurfaces(const Surface& src_surface,
         return false;
 
     dst_surface->InvalidateAllWatcher();
+    dst_surface->TextureChanged();
 
     return BlitTextures(src_surface->texture.handle, src_rect, dst_surface->texture.handle,
                         dst_rect, src_surface->type, read_framebuffer.handle,
@@ -1349,6 +1483,7 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
         ValidateSurface(surface, params.addr, params.size);
     }
 
+    surface->last_used_frame = frame_count;
     return surface;
 }
 
@@ -1429,6 +1564,7 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetSurfaceSubRect(const SurfaceParams&
         ValidateSurface(surface, aligned_params.addr, aligned_params.size);
     }
 
+    surface->last_used_frame = frame_count;
     return std::make_tuple(surface, surface->GetScaledSubRect(params));
 }
 
@@ -1791,6 +1927,7 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetTexCopySurface(const SurfaceParams&
         }
 
         rect = match_surface->GetScaledSubRect(match_subrect);
+        match_surface->last_used_frame = frame_count;
     }
 
     return std::make_tuple(match_surface, rect);
@@ -1863,6 +2000,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
                     reinterpret_surface->GetScaledSubRect(convert_params);
                 const Common::Rectangle<u32> dest_rect = surface->GetScaledSubRect(convert_params);
 
+                surface->TextureChanged();
                 ConvertD24S8toABGR(reinterpret_surface->texture.handle, src_rect,
                                    surface->texture.handle, dest_rect);
 
@@ -1884,11 +2022,23 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
             }
         }
 
-        // Load data from 3DS memory
+        // Load data from 3DS memory, unless it's the same as the last time, as the CPU often
+        // rewrites a texture with the same data
         FlushRegion(params.addr, params.size);
-        surface->LoadGLBuffer(params.addr, params.end);
-        surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
-                                 draw_framebuffer.handle);
+        const u64 hash = surface->HashMemory(params.addr, params.end);
+        if (hash != 0 && surface->loaded_interval == params.GetInterval() &&
+            surface->loaded_hash == hash) {
+            MICROPROFILE_META_CPU("Uploads Skipped", 1);
+            MICROPROFILE_META_CPU("Upload Bytes Skipped", static_cast<int>(params.size));
+            ++skipped_uploads;
+            skipped_upload_bytes += params.size;
+        } else {
+            surface->LoadGLBuffer(params.addr, params.end);
+            surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
+                                     draw_framebuffer.handle);
+            surface->loaded_interval = params.GetInterval();
+            surface->loaded_hash = hash;
+        }
         surface->invalid_regions.erase(params.GetInterval());
     }
 }
@@ -1914,9 +2064,13 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surf
         ASSERT(surface->IsRegionValid(interval));
 
         if (surface->type != SurfaceType::Fill) {
-            const SurfaceParams params = surface->FromInterval(interval);
-            surface->DownloadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
-                                       draw_framebuffer.handle);
+            // Only wait for the download if it was started ahead of time
+            if (!surface->FinishDownload(interval)) {
+                const SurfaceParams params = surface->FromInterval(interval);
+                surface->DownloadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
+                                           draw_framebuffer.handle);
+            }
+            surface->read_back_frame = frame_count;
         }
         surface->FlushGLBuffer(boost::icl::first(interval), boost::icl::last_next(interval));
         flushed_intervals += interval;
@@ -1929,6 +2083,103 @@ void RasterizerCacheOpenGL::FlushAll() {
     FlushRegion(0, 0xFFFFFFFF);
 }
 
+void RasterizerCacheOpenGL::StartDownload(const Surface& surface) {
+    // Surfaces that weren't read back in the last few frames likely won't be anytime soon
+    constexpr u64 ReadBackFrames = 4;
+    if (surface->read_back_frame == 0 || frame_count - surface->read_back_frame > ReadBackFrames) {
+        return;
+    }
+
+    SurfaceInterval dirty_interval;
+    for (const auto& pair : RangeFromInterval(dirty_regions, surface->GetInterval())) {
+        if (pair.second == surface) {
+            dirty_interval = boost::icl::is_empty(dirty_interval)
+                                 ? pair.first
+                                 : boost::icl::hull(dirty_interval, pair.first);
+        }
+    }
+    if (boost::icl::is_empty(dirty_interval) ||
+        boost::icl::contains(surface->download_interval, dirty_interval)) {
+        return;
+    }
+
+    surface->StartDownload(dirty_interval, read_framebuffer.handle, draw_framebuffer.handle);
+}
+
+void RasterizerCacheOpenGL::StartDownloads() {
+    SurfaceSet surfaces;
+    for (const auto& pair : dirty_regions) {
+        if (pair.second->type != SurfaceType::Fill) {
+            surfaces.insert(pair.second);
+        }
+    }
+    for (const auto& surface : surfaces) {
+        StartDownload(surface);
+    }
+}
+
+/// Identifies a surface across its re-creations
+static std::size_t GetSurfaceKey(const SurfaceParams& params) {
+    std::size_t hash = 0;
+    boost::hash_combine(hash, params.addr);
+    boost::hash_combine(hash, params.end);
+    boost::hash_combine(hash, params.width);
+    boost::hash_combine(hash, params.stride);
+    boost::hash_combine(hash, params.res_scale);
+    boost::hash_combine(hash, params.is_tiled);
+    boost::hash_combine(hash, static_cast<u32>(params.pixel_format));
+    return hash;
+}
+
+void RasterizerCacheOpenGL::EvictSurfaces() {
+    const u64 budget = static_cast<u64>(Settings::values.texture_memory_budget) << 20;
+    if (budget == 0 || resident_bytes <= budget) {
+        return;
+    }
+
+    // Surfaces used in this frame or the last one may still be bound, and are needed anyway
+    SurfaceSet unused_surfaces;
+    for (const auto& pair : surface_cache) {
+        for (const auto& surface : pair.second) {
+            if (surface->type != SurfaceType::Fill && surface->last_used_frame + 1 < frame_count) {
+                unused_surfaces.insert(surface);
+            }
+        }
+    }
+    std::vector<Surface> candidates(unused_surfaces.begin(), unused_surfaces.end());
+    std::sort(candidates.begin(), candidates.end(), [](const Surface& lhs, const Surface& rhs) {
+        return lhs->last_used_frame < rhs->last_used_frame;
+    });
+
+    // The keys are only kept for statistics, so don't let them pile up
+    constexpr std::size_t MaxEvictedSurfaceKeys = 4096;
+    if (evicted_surfaces.size() > MaxEvictedSurfaceKeys) {
+        evicted_surfaces.clear();
+    }
+
+    const u64 evictions_before = num_evictions;
+    for (const auto& surface : candidates) {
+        if (resident_bytes <= budget) {
+            break;
+        }
+        FlushRegion(surface->addr, surface->size, surface);
+        surface->UnlinkAllWatcher();
+        UnregisterSurface(surface);
+        evicted_surfaces.insert(GetSurfaceKey(*surface));
+        ++num_evictions;
+    }
+
+    LOG_DEBUG(Render_OpenGL, "Evicted {} surfaces, {} MiB are left",
+              num_evictions - evictions_before, resident_bytes >> 20);
+}
+
+void RasterizerCacheOpenGL::EndFrame() {
+    StartDownloads();
+    EvictSurfaces();
+    MICROPROFILE_META_CPU("Surface MiB", static_cast<int>(resident_bytes >> 20));
+    ++frame_count;
+}
+
 void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface& region_owner) {
     if (size == 0) {
         return;
@@ -1942,6 +2193,7 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
         // Surfaces can't have a gap
         ASSERT(region_owner->width == region_owner->stride);
         region_owner->invalid_regions.erase(invalid_interval);
+        region_owner->TextureChanged();
     }
 
     for (auto& pair : RangeFromInterval(surface_cache, invalid_interval)) {
@@ -2014,8 +2266,16 @@ void RasterizerCacheOpenGL::RegisterSurface(const Surface& surface) {
         return;
     }
     surface->registered = true;
+    surface->last_used_frame = frame_count;
     surface_cache.add({surface->GetInterval(), SurfaceSet{surface}});
     UpdatePagesCachedCount(surface->addr, surface->size, 1);
+
+    resident_bytes += surface->GetMemorySize();
+    peak_resident_bytes = std::max(peak_resident_bytes, resident_bytes);
+    if (surface->type != SurfaceType::Fill && !evicted_surfaces.empty() &&
+        evicted_surfaces.erase(GetSurfaceKey(*surface)) != 0) {
+        ++num_recreations;
+    }
 }
 
 void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
@@ -2025,6 +2285,7 @@ void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
     surface->registered = false;
     UpdatePagesCachedCount(surface->addr, surface->size, -1);
     surface_cache.subtract({surface->GetInterval(), SurfaceSet{surface}});
+    resident_bytes -= surface->GetMemorySize();
 }
 
 void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
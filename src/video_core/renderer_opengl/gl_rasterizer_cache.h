@@ -19,6 +19,7 @@
 #pragma GCC diagnostic pop
 #endif
 #include <unordered_map>
+#include <unordered_set>
 #include <boost/functional/hash.hpp>
 #include <glad/glad.h>
 #include "common/assert.h"
@@ -392,6 +393,49 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     void DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
                            GLuint draw_fb_handle);
 
+    /// Starts downloading a region of the texture into download_buffer, without waiting for it
+    void StartDownload(SurfaceInterval interval, GLuint read_fb_handle, GLuint draw_fb_handle);
+
+    /**
+     * Waits for the download started before to complete and moves its data to gl_buffer
+     * @return Whether the download covered the region, otherwise gl_buffer is left as is
+     */
+    bool FinishDownload(SurfaceInterval interval);
+
+    /// Drops the download started before, as the texture is about to change
+    void DiscardDownload();
+
+    /// Drops everything relying on the contents of the texture, as they're about to change
+    void TextureChanged();
+
+    /// Hashes the 3DS memory of a region of the surface, returns 0 if it isn't backed by memory
+    u64 HashMemory(PAddr start, PAddr end) const;
+
+    /// Region of the texture last loaded from 3DS memory, and the hash of that memory, as long as
+    /// the texture wasn't changed otherwise since
+    SurfaceInterval loaded_interval;
+    u64 loaded_hash = 0;
+
+    /// Frame in which the CPU last read back the surface, 0 if it never did
+    u64 read_back_frame = 0;
+
+    /// Frame in which the surface was last used
+    u64 last_used_frame = 0;
+
+    /// Approximate size of the texture in host GPU memory
+    u64 GetMemorySize() const {
+        return type == SurfaceType::Fill ? 0
+                                         : static_cast<u64>(GetScaledWidth()) * GetScaledHeight() *
+                                               GetGLBytesPerPixel(pixel_format);
+    }
+
+    // Pixel pack buffer the texture is downloaded to ahead of the CPU reading it back
+    OGLBuffer download_buffer;
+    u8* download_buffer_ptr = nullptr; ///< Persistent mapping of download_buffer, if supported
+    OGLSync download_fence;            ///< Signaled once the download is in download_buffer
+    /// Region downloaded, either in flight or already moved to gl_buffer
+    SurfaceInterval download_interval;
+
     std::shared_ptr<SurfaceWatcher> CreateWatcher() {
         auto watcher = std::make_shared<SurfaceWatcher>(weak_from_this());
         watchers.push_front(watcher);
@@ -417,6 +461,10 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     }
 
 private:
+    /// Reads a region of the texture to dst_buffer, or the bound pixel pack buffer if null
+    void ReadGLTexture(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
+                       GLuint draw_fb_handle, u8* dst_buffer);
+
     std::list<std::weak_ptr<SurfaceWatcher>> watchers;
 };
 
@@ -482,6 +530,15 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    /**
+     * Starts downloading the dirty regions of a surface if the CPU read it back recently, so that
+     * flushing them later only waits for the download instead of stalling the GPU
+     */
+    void StartDownload(const Surface& surface);
+
+    /// Does the work due at the end of each frame
+    void EndFrame();
+
 private:
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
@@ -500,11 +557,33 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Starts downloading the surfaces likely to be read back
+    void StartDownloads();
+
+    /// Flushes and removes the least recently used surfaces until they fit in the memory budget
+    void EvictSurfaces();
+
     SurfaceCache surface_cache;
     PageMap cached_pages;
     SurfaceMap dirty_regions;
     SurfaceSet remove_surfaces;
 
+    /// Number of frames ended so far plus 1, which CachedSurface::read_back_frame refers to
+    u64 frame_count = 1;
+
+    /// Loads from 3DS memory skipped as the memory held the data already in the texture
+    u64 skipped_uploads = 0;
+    u64 skipped_upload_bytes = 0;
+
+    /// Memory used by the textures of the registered surfaces
+    u64 resident_bytes = 0;
+    u64 peak_resident_bytes = 0;
+    u64 num_evictions = 0;
+    /// Number of evicted surfaces that had to be created again
+    u64 num_recreations = 0;
+    /// Keys of the surfaces evicted, to tell when they're created again
+    std::unordered_set<std::size_t> evicted_surfaces;
+
     OGLFramebuffer read_framebuffer;
     OGLFramebuffer draw_framebuffer;
 
@@ -166,6 +166,25 @@ void OGLBuffer::Release() {
     handle = 0;
 }
 
+void OGLSync::Create() {
+    if (handle != nullptr) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_ResourceCreation);
+    handle = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void OGLSync::Release() {
+    if (handle == nullptr) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
+    glDeleteSync(handle);
+    handle = nullptr;
+}
+
 void OGLVertexArray::Create() {
     if (handle != 0) {
         return;
@@ -0,0 +1,109 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_shader_compiler.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
+
+namespace OpenGL {
+
+std::unique_ptr<ShaderCompiler> ShaderCompiler::Create(Frontend::EmuWindow& emu_window,
+                                                       std::size_t num_workers) {
+    std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts;
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        auto context = emu_window.CreateSharedContext();
+        if (context == nullptr) {
+            break;
+        }
+        contexts.push_back(std::move(context));
+    }
+    // Some frontends make a new context current on the thread that creates it
+    emu_window.MakeCurrent();
+
+    if (contexts.empty()) {
+        return nullptr;
+    }
+    return std::unique_ptr<ShaderCompiler>(new ShaderCompiler(emu_window, std::move(contexts)));
+}
+
+ShaderCompiler::ShaderCompiler(Frontend::EmuWindow& emu_window,
+                               std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts)
+    : emu_window(emu_window), contexts(std::move(contexts)) {
+    threads.reserve(this->contexts.size());
+    for (auto& context : this->contexts) {
+        threads.emplace_back(&ShaderCompiler::WorkerThread, this, std::ref(*context));
+    }
+}
+
+ShaderCompiler::~ShaderCompiler() {
+    {
+        std::lock_guard lock{mutex};
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    contexts.clear();
+    // Destroying a context can leave the calling thread without one
+    emu_window.MakeCurrent();
+}
+
+ShaderCompiler::Program ShaderCompiler::Build(const std::string& source, GLenum type) {
+    const auto start = std::chrono::steady_clock::now();
+
+    OGLShader shader;
+    shader.Create(source.c_str(), type);
+    const GLuint handle = LoadProgram(true, {shader.handle});
+    // Other contexts are only guaranteed to see the program once it's complete
+    glFinish();
+
+    const auto time = std::chrono::steady_clock::now() - start;
+    const auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+    return {handle, static_cast<u64>(time_us)};
+}
+
+std::future<ShaderCompiler::Program> ShaderCompiler::BuildProgram(std::string source,
+                                                                 GLenum type) {
+    return Submit([source = std::move(source), type] { return Build(source, type); });
+}
+
+void ShaderCompiler::Enqueue(std::function<void()>&& task) {
+    {
+        std::lock_guard lock{mutex};
+        tasks.push(std::move(task));
+    }
+    cv.notify_one();
+}
+
+void ShaderCompiler::WorkerThread(Frontend::GraphicsContext& context) {
+    Common::SetCurrentThreadName("ShaderCompiler");
+    MicroProfileOnThreadCreate("ShaderCompiler");
+    context.MakeCurrent();
+
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{mutex};
+            cv.wait(lock, [this] { return stop || !tasks.empty(); });
+            if (tasks.empty()) {
+                break;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+
+    context.DoneCurrent();
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
+}
+
+} // namespace OpenGL
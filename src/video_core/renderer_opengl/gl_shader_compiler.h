@@ -0,0 +1,89 @@
+// Copyright 2019 Citra Valentin Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+
+namespace Frontend {
+class EmuWindow;
+class GraphicsContext;
+} // namespace Frontend
+
+namespace OpenGL {
+
+/**
+ * Builds shader programs in the background, on worker threads that each have a graphics context
+ * shared with the one of the renderer. The workers only deal with raw handles, as OpenGLState
+ * tracks the context of the renderer and must not be touched by them.
+ */
+class ShaderCompiler {
+public:
+    /// A program built by a worker, owned by whoever gets it from the future
+    struct Program {
+        GLuint handle;
+        u64 build_time_us;
+    };
+
+    /**
+     * Creates the workers, must be called with the context of the renderer current.
+     * @return nullptr if the frontend can't create shared contexts
+     */
+    static std::unique_ptr<ShaderCompiler> Create(Frontend::EmuWindow& emu_window,
+                                                  std::size_t num_workers);
+
+    ~ShaderCompiler();
+
+    ShaderCompiler(const ShaderCompiler&) = delete;
+    ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+    /// Builds a separable program out of the source of a single shader stage on the calling thread
+    static Program Build(const std::string& source, GLenum type);
+
+    /// Queues building a separable program out of the source of a single shader stage
+    std::future<Program> BuildProgram(std::string source, GLenum type);
+
+    /// Queues a task to run on a worker, with its context current
+    template <typename F>
+    std::future<std::invoke_result_t<F>> Submit(F&& f) {
+        using Result = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        std::future<Result> future = task->get_future();
+        Enqueue([task] { (*task)(); });
+        return future;
+    }
+
+    std::size_t NumWorkers() const {
+        return threads.size();
+    }
+
+private:
+    ShaderCompiler(Frontend::EmuWindow& emu_window,
+                   std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts);
+
+    void Enqueue(std::function<void()>&& task);
+    void WorkerThread(Frontend::GraphicsContext& context);
+
+    Frontend::EmuWindow& emu_window;
+    std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts;
+    std::vector<std::thread> threads;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop = false;
+};
+
+} // namespace OpenGL
@@ -1230,9 +1230,12 @@ float ProcTexNoiseCoef(vec2 x) {
     }
 }
 
-std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader) {
-    const auto& state = config.state;
-
+/**
+ * Writes the declarations and helper functions shared by all the fragment shaders
+ * @param config Configuration the shader is generated for, nullptr for the ubershader, which reads
+ *               the configuration from uniforms instead
+ */
+static std::string GetFragmentShaderPreamble(const PicaFSConfig* config, bool separable_shader) {
     std::string out = R"(#version 330 core
 
 #extension GL_ARB_shader_image_load_store : enable
@@ -1268,6 +1271,9 @@ layout(r32ui) uniform uimage2D shadow_buffer;
 )";
 
     out += UniformBlockDef;
+    if (config == nullptr) {
+        out += "uniform bool shadow_texture_orthographic;\n";
+    }
 
     out += R"(
 // Rotate the vector v by the quaternion q
@@ -1346,7 +1352,9 @@ float mix2(vec4 s, vec2 a) {
 
 vec4 shadowTexture(vec2 uv, float w) {
 )";
-    if (!config.state.shadow_texture_orthographic) {
+    if (config == nullptr) {
+        out += "if (!shadow_texture_orthographic) uv /= w;";
+    } else if (!config->state.shadow_texture_orthographic) {
         out += "uv /= w;";
     }
     out += "uint z = uint(max(0, int(min(abs(w), 1.0) * 0xFFFFFF) - shadow_texture_bias));";
@@ -1459,6 +1467,14 @@ vec4 shadowTextureCube(vec2 uv, float w) {
 #endif
 )";
 
+    return out;
+}
+
+std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader) {
+    const auto& state = config.state;
+
+    std::string out = GetFragmentShaderPreamble(&config, separable_shader);
+
     if (config.state.proctex.enable)
         AppendProcTexSampler(out, config);
 
@@ -1574,6 +1590,699 @@ do {
     return out;
 }
 
+namespace {
+// Flags of FragmentUberShaderUniforms::lighting_lights, one set per light
+enum UberShaderLightFlags : u32 {
+    UberLightDirectional = 1 << 0,
+    UberLightTwoSidedDiffuse = 1 << 1,
+    UberLightDistAtten = 1 << 2,
+    UberLightSpotAtten = 1 << 3,
+    UberLightGeometricFactor0 = 1 << 4,
+    UberLightGeometricFactor1 = 1 << 5,
+    UberLightShadow = 1 << 6,
+};
+
+// Flags of FragmentUberShaderUniforms::lighting_config
+enum UberShaderLightingFlags : u32 {
+    UberLightingBumpRenorm = 1 << 0,
+    UberLightingClampHighlights = 1 << 1,
+    UberLightingPrimaryAlpha = 1 << 2,
+    UberLightingSecondaryAlpha = 1 << 3,
+    UberLightingShadow = 1 << 4,
+    UberLightingShadowPrimary = 1 << 5,
+    UberLightingShadowSecondary = 1 << 6,
+    UberLightingShadowInvert = 1 << 7,
+    UberLightingShadowAlpha = 1 << 8,
+    UberLightingConfig7 = 1 << 9,
+};
+
+// Indices of FragmentUberShaderUniforms::lighting_luts
+enum UberShaderLightingLut : std::size_t {
+    UberLutD0,
+    UberLutD1,
+    UberLutSP,
+    UberLutFR,
+    UberLutRR,
+    UberLutRG,
+    UberLutRB,
+};
+} // Anonymous namespace
+
+bool IsFragmentUberShaderCompatible(const PicaFSConfig& config) {
+    const auto& state = config.state;
+    // Procedural textures, gas fog and shadow map rendering aren't interpreted by the ubershader,
+    // these configurations always wait for their own shader to be built
+    return !state.proctex.enable && state.fog_mode != TexturingRegs::FogMode::Gas &&
+           !state.shadow_rendering;
+}
+
+FragmentUberShaderUniforms FragmentUberShaderUniforms::BuildFromConfig(const PicaFSConfig& config) {
+    const auto& state = config.state;
+    const auto& lighting = state.lighting;
+    FragmentUberShaderUniforms uniforms{};
+
+    for (std::size_t i = 0; i < state.tev_stages.size(); ++i) {
+        const auto& stage = state.tev_stages[i];
+        uniforms.tev_stages[i] = {stage.sources_raw, stage.modifiers_raw, stage.ops_raw,
+                                  stage.scales_raw};
+    }
+    uniforms.tev_combiner_buffer_input = state.combiner_buffer_input;
+    uniforms.alpha_test_func = static_cast<s32>(state.alpha_test_func);
+    uniforms.scissor_test_mode = static_cast<s32>(state.scissor_test_mode);
+    uniforms.texture0_type = static_cast<s32>(state.texture0_type);
+    uniforms.texture2_use_coord1 = state.texture2_use_coord1;
+    uniforms.w_buffering = state.depthmap_enable == RasterizerRegs::DepthBuffering::WBuffering;
+    uniforms.fog_enable = state.fog_mode == TexturingRegs::FogMode::Fog;
+    uniforms.fog_flip = state.fog_flip;
+    uniforms.shadow_texture_orthographic = state.shadow_texture_orthographic;
+
+    uniforms.lighting_enable = lighting.enable;
+    if (!lighting.enable) {
+        return uniforms;
+    }
+
+    // The samplers unsupported by the lighting configuration are folded into the enable flags
+    const auto supported = [&lighting](LightingRegs::LightingSampler sampler) {
+        return LightingRegs::IsLightingSamplerSupported(lighting.config, sampler);
+    };
+
+    uniforms.lighting_src_num = static_cast<s32>(lighting.src_num);
+    for (unsigned i = 0; i < lighting.src_num; ++i) {
+        const auto& light = lighting.light[i];
+        u32 flags = 0;
+        if (light.directional)
+            flags |= UberLightDirectional;
+        if (light.two_sided_diffuse)
+            flags |= UberLightTwoSidedDiffuse;
+        if (light.dist_atten_enable)
+            flags |= UberLightDistAtten;
+        if (light.spot_atten_enable &&
+            supported(LightingRegs::LightingSampler::SpotlightAttenuation))
+            flags |= UberLightSpotAtten;
+        if (light.geometric_factor_0)
+            flags |= UberLightGeometricFactor0;
+        if (light.geometric_factor_1)
+            flags |= UberLightGeometricFactor1;
+        if (light.shadow_enable)
+            flags |= UberLightShadow;
+        uniforms.lighting_lights[i] = {light.num, flags};
+    }
+
+    u32 flags = 0;
+    if (lighting.bump_renorm)
+        flags |= UberLightingBumpRenorm;
+    if (lighting.clamp_highlights)
+        flags |= UberLightingClampHighlights;
+    if (lighting.enable_primary_alpha)
+        flags |= UberLightingPrimaryAlpha;
+    if (lighting.enable_secondary_alpha)
+        flags |= UberLightingSecondaryAlpha;
+    if (lighting.enable_shadow)
+        flags |= UberLightingShadow;
+    if (lighting.shadow_primary)
+        flags |= UberLightingShadowPrimary;
+    if (lighting.shadow_secondary)
+        flags |= UberLightingShadowSecondary;
+    if (lighting.shadow_invert)
+        flags |= UberLightingShadowInvert;
+    if (lighting.shadow_alpha)
+        flags |= UberLightingShadowAlpha;
+    if (lighting.config == LightingRegs::LightingConfig::Config7)
+        flags |= UberLightingConfig7;
+    uniforms.lighting_config = {static_cast<u32>(lighting.bump_mode), lighting.bump_selector,
+                                flags, lighting.shadow_selector};
+
+    const auto set_lut = [&uniforms](UberShaderLightingLut index, const auto& lut, bool enable) {
+        uniforms.lighting_luts[index] = {enable, lut.abs_input, static_cast<s32>(lut.type)};
+        uniforms.lighting_lut_scales[index] = lut.scale;
+    };
+    set_lut(UberLutD0, lighting.lut_d0,
+            lighting.lut_d0.enable && supported(LightingRegs::LightingSampler::Distribution0));
+    set_lut(UberLutD1, lighting.lut_d1,
+            lighting.lut_d1.enable && supported(LightingRegs::LightingSampler::Distribution1));
+    // Spot attenuation is enabled per light
+    set_lut(UberLutSP, lighting.lut_sp, true);
+    set_lut(UberLutFR, lighting.lut_fr,
+            lighting.lut_fr.enable && supported(LightingRegs::LightingSampler::Fresnel));
+    set_lut(UberLutRR, lighting.lut_rr,
+            lighting.lut_rr.enable && supported(LightingRegs::LightingSampler::ReflectRed));
+    set_lut(UberLutRG, lighting.lut_rg,
+            lighting.lut_rg.enable && supported(LightingRegs::LightingSampler::ReflectGreen));
+    set_lut(UberLutRB, lighting.lut_rb,
+            lighting.lut_rb.enable && supported(LightingRegs::LightingSampler::ReflectBlue));
+
+    return uniforms;
+}
+
+std::string GenerateFragmentUberShader(bool separable_shader) {
+    std::string out = GetFragmentShaderPreamble(nullptr, separable_shader);
+
+    const auto define = [&out](const char* name, u32 value) {
+        out += "#define " + std::string(name) + ' ' + std::to_string(value) + "u\n";
+    };
+    define("LIGHT_DIRECTIONAL", UberLightDirectional);
+    define("LIGHT_TWO_SIDED_DIFFUSE", UberLightTwoSidedDiffuse);
+    define("LIGHT_DIST_ATTEN", UberLightDistAtten);
+    define("LIGHT_SPOT_ATTEN", UberLightSpotAtten);
+    define("LIGHT_GEOMETRIC_FACTOR_0", UberLightGeometricFactor0);
+    define("LIGHT_GEOMETRIC_FACTOR_1", UberLightGeometricFactor1);
+    define("LIGHT_SHADOW", UberLightShadow);
+    define("LIGHTING_BUMP_RENORM", UberLightingBumpRenorm);
+    define("LIGHTING_CLAMP_HIGHLIGHTS", UberLightingClampHighlights);
+    define("LIGHTING_PRIMARY_ALPHA", UberLightingPrimaryAlpha);
+    define("LIGHTING_SECONDARY_ALPHA", UberLightingSecondaryAlpha);
+    define("LIGHTING_SHADOW", UberLightingShadow);
+    define("LIGHTING_SHADOW_PRIMARY", UberLightingShadowPrimary);
+    define("LIGHTING_SHADOW_SECONDARY", UberLightingShadowSecondary);
+    define("LIGHTING_SHADOW_INVERT", UberLightingShadowInvert);
+    define("LIGHTING_SHADOW_ALPHA", UberLightingShadowAlpha);
+    define("LIGHTING_CONFIG7", UberLightingConfig7);
+
+    out += "#define LUT_D0 " + std::to_string(UberLutD0) + "\n";
+    out += "#define LUT_D1 " + std::to_string(UberLutD1) + "\n";
+    out += "#define LUT_SP " + std::to_string(UberLutSP) + "\n";
+    out += "#define LUT_FR " + std::to_string(UberLutFR) + "\n";
+    out += "#define LUT_RR " + std::to_string(UberLutRR) + "\n";
+    out += "#define LUT_RG " + std::to_string(UberLutRG) + "\n";
+    out += "#define LUT_RB " + std::to_string(UberLutRB) + "\n";
+
+    const auto sampler = [&out](const char* name, LightingRegs::LightingSampler value) {
+        out += "#define " + std::string(name) + ' ' +
+               std::to_string(static_cast<unsigned>(value)) + "\n";
+    };
+    sampler("SAMPLER_D0", LightingRegs::LightingSampler::Distribution0);
+    sampler("SAMPLER_D1", LightingRegs::LightingSampler::Distribution1);
+    sampler("SAMPLER_FR", LightingRegs::LightingSampler::Fresnel);
+    sampler("SAMPLER_RB", LightingRegs::LightingSampler::ReflectBlue);
+    sampler("SAMPLER_RG", LightingRegs::LightingSampler::ReflectGreen);
+    sampler("SAMPLER_RR", LightingRegs::LightingSampler::ReflectRed);
+    sampler("SAMPLER_SP", LightingRegs::SpotlightAttenuationSampler(0));
+    sampler("SAMPLER_DA", LightingRegs::DistanceAttenuationSampler(0));
+
+    out += R"(
+#define NUM_LIGHTING_LUTS 7
+
+uniform uvec4 tev_stages[NUM_TEV_STAGES];
+uniform uint tev_combiner_buffer_input;
+uniform int alpha_test_func;
+uniform int scissor_test_mode;
+uniform int texture0_type;
+uniform bool texture2_use_coord1;
+uniform bool w_buffering;
+uniform bool fog_enable;
+uniform bool fog_flip;
+
+uniform bool lighting_enable;
+uniform int lighting_src_num;
+uniform uvec2 lighting_lights[NUM_LIGHTS];
+uniform uvec4 lighting_config;
+uniform ivec3 lighting_luts[NUM_LIGHTING_LUTS];
+uniform float lighting_lut_scales[NUM_LIGHTING_LUTS];
+
+vec4 rounded_primary_color;
+vec4 primary_fragment_color;
+vec4 secondary_fragment_color;
+vec4 texture_color[4];
+vec4 combiner_buffer;
+vec4 last_tex_env_out;
+
+vec3 normal;
+vec3 tangent;
+vec3 light_vector;
+vec3 spot_dir;
+vec3 half_vector;
+
+vec4 SampleTexture0() {
+    switch (texture0_type) {
+    case 0: // Texture2D
+        return textureLod(tex0, texcoord0, getLod(texcoord0 * vec2(textureSize(tex0, 0))));
+    case 1: // TextureCube
+        return texture(tex_cube, vec3(texcoord0, texcoord0_w));
+    case 2: // Shadow2D
+        return shadowTexture(texcoord0, texcoord0_w);
+    case 3: // Projection2D
+        return textureProj(tex0, vec3(texcoord0, texcoord0_w));
+    case 4: // ShadowCube
+        return shadowTextureCube(texcoord0, texcoord0_w);
+    default:
+        return vec4(0.0);
+    }
+}
+
+float LightingLutValue(int lut, int lut_sampler, uint light_flags) {
+    float index;
+    switch (lighting_luts[lut].z) {
+    case 0: // NH
+        index = dot(normal, normalize(half_vector));
+        break;
+    case 1: // VH
+        index = dot(normalize(view), normalize(half_vector));
+        break;
+    case 2: // NV
+        index = dot(normal, normalize(view));
+        break;
+    case 3: // LN
+        index = dot(light_vector, normal);
+        break;
+    case 4: // SP
+        index = dot(light_vector, spot_dir);
+        break;
+    case 5: // CP, only available with configuration 7
+        if ((lighting_config.z & LIGHTING_CONFIG7) != 0u) {
+            index = dot(normalize(half_vector) - normal * dot(normal, normalize(half_vector)),
+                        tangent);
+        } else {
+            index = 0.0;
+        }
+        break;
+    default:
+        index = 0.0;
+        break;
+    }
+
+    float value;
+    if (lighting_luts[lut].y != 0) {
+        index = (light_flags & LIGHT_TWO_SIDED_DIFFUSE) != 0u ? abs(index) : max(index, 0.0);
+        value = LookupLightingLUTUnsigned(lut_sampler, index);
+    } else {
+        value = LookupLightingLUTSigned(lut_sampler, index);
+    }
+    return lighting_lut_scales[lut] * value;
+}
+
+bool LightingLutEnabled(int lut) {
+    return lighting_luts[lut].x != 0;
+}
+
+void ComputeLighting() {
+    uint flags = lighting_config.z;
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    float clamp_highlights = 1.0;
+    float geo_factor = 1.0;
+
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    vec3 surface_tangent = vec3(1.0, 0.0, 0.0);
+    if (lighting_config.x == 1u) { // NormalMap
+        surface_normal = 2.0 * texture_color[lighting_config.y].rgb - 1.0;
+        if ((flags & LIGHTING_BUMP_RENORM) != 0u) {
+            surface_normal.z = sqrt(max(1.0 - (surface_normal.x * surface_normal.x +
+                                               surface_normal.y * surface_normal.y), 0.0));
+        }
+    } else if (lighting_config.x == 2u) { // TangentMap
+        surface_tangent = 2.0 * texture_color[lighting_config.y].rgb - 1.0;
+    }
+
+    vec4 normalized_normquat = normalize(normquat);
+    normal = quaternion_rotate(normalized_normquat, surface_normal);
+    tangent = quaternion_rotate(normalized_normquat, surface_tangent);
+
+    vec4 shadow = vec4(1.0);
+    if ((flags & LIGHTING_SHADOW) != 0u) {
+        shadow = texture_color[lighting_config.w];
+        if ((flags & LIGHTING_SHADOW_INVERT) != 0u) {
+            shadow = vec4(1.0) - shadow;
+        }
+    }
+
+    for (int i = 0; i < lighting_src_num; ++i) {
+        int num = int(lighting_lights[i].x);
+        uint light_flags = lighting_lights[i].y;
+
+        if ((light_flags & LIGHT_DIRECTIONAL) != 0u) {
+            light_vector = normalize(light_src[num].position);
+        } else {
+            light_vector = normalize(light_src[num].position + view);
+        }
+        spot_dir = light_src[num].spot_direction;
+        half_vector = normalize(view) + light_vector;
+
+        float dot_product = dot(light_vector, normal);
+        dot_product = (light_flags & LIGHT_TWO_SIDED_DIFFUSE) != 0u ? abs(dot_product)
+                                                                    : max(dot_product, 0.0);
+        if ((flags & LIGHTING_CLAMP_HIGHLIGHTS) != 0u) {
+            clamp_highlights = sign(dot_product);
+        }
+
+        float spot_atten = 1.0;
+        if ((light_flags & LIGHT_SPOT_ATTEN) != 0u) {
+            spot_atten = LightingLutValue(LUT_SP, SAMPLER_SP + num, light_flags);
+        }
+
+        float dist_atten = 1.0;
+        if ((light_flags & LIGHT_DIST_ATTEN) != 0u) {
+            float index = clamp(light_src[num].dist_atten_scale *
+                                length(-view - light_src[num].position) +
+                                light_src[num].dist_atten_bias, 0.0, 1.0);
+            dist_atten = LookupLightingLUTUnsigned(SAMPLER_DA + num, index);
+        }
+
+        if ((light_flags & (LIGHT_GEOMETRIC_FACTOR_0 | LIGHT_GEOMETRIC_FACTOR_1)) != 0u) {
+            geo_factor = dot(half_vector, half_vector);
+            geo_factor = geo_factor == 0.0 ? 0.0 : min(dot_product / geo_factor, 1.0);
+        }
+
+        float d0_lut_value = 1.0;
+        if (LightingLutEnabled(LUT_D0)) {
+            d0_lut_value = LightingLutValue(LUT_D0, SAMPLER_D0, light_flags);
+        }
+        vec3 specular_0 = d0_lut_value * light_src[num].specular_0;
+        if ((light_flags & LIGHT_GEOMETRIC_FACTOR_0) != 0u) {
+            specular_0 *= geo_factor;
+        }
+
+        vec3 refl_value;
+        refl_value.r = LightingLutEnabled(LUT_RR)
+                           ? LightingLutValue(LUT_RR, SAMPLER_RR, light_flags) : 1.0;
+        refl_value.g = LightingLutEnabled(LUT_RG)
+                           ? LightingLutValue(LUT_RG, SAMPLER_RG, light_flags) : refl_value.r;
+        refl_value.b = LightingLutEnabled(LUT_RB)
+                           ? LightingLutValue(LUT_RB, SAMPLER_RB, light_flags) : refl_value.r;
+
+        float d1_lut_value = 1.0;
+        if (LightingLutEnabled(LUT_D1)) {
+            d1_lut_value = LightingLutValue(LUT_D1, SAMPLER_D1, light_flags);
+        }
+        vec3 specular_1 = d1_lut_value * refl_value * light_src[num].specular_1;
+        if ((light_flags & LIGHT_GEOMETRIC_FACTOR_1) != 0u) {
+            specular_1 *= geo_factor;
+        }
+
+        // Only the last entry in the light slots applies the Fresnel factor
+        if (i == lighting_src_num - 1 && LightingLutEnabled(LUT_FR)) {
+            float value = LightingLutValue(LUT_FR, SAMPLER_FR, light_flags);
+            if ((flags & LIGHTING_PRIMARY_ALPHA) != 0u) {
+                diffuse_sum.a = value;
+            }
+            if ((flags & LIGHTING_SECONDARY_ALPHA) != 0u) {
+                specular_sum.a = value;
+            }
+        }
+
+        bool light_shadow = (light_flags & LIGHT_SHADOW) != 0u;
+        vec3 shadow_primary =
+            light_shadow && (flags & LIGHTING_SHADOW_PRIMARY) != 0u ? shadow.rgb : vec3(1.0);
+        vec3 shadow_secondary =
+            light_shadow && (flags & LIGHTING_SHADOW_SECONDARY) != 0u ? shadow.rgb : vec3(1.0);
+
+        diffuse_sum.rgb += ((light_src[num].diffuse * dot_product) + light_src[num].ambient) *
+                           dist_atten * spot_atten * shadow_primary;
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_highlights * dist_atten *
+                            spot_atten * shadow_secondary;
+    }
+
+    if ((flags & LIGHTING_SHADOW_ALPHA) != 0u) {
+        if ((flags & LIGHTING_PRIMARY_ALPHA) != 0u) {
+            diffuse_sum.a *= shadow.a;
+        }
+        if ((flags & LIGHTING_SECONDARY_ALPHA) != 0u) {
+            specular_sum.a *= shadow.a;
+        }
+    }
+
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+vec4 TevSource(uint source, int stage) {
+    switch (source) {
+    case 0u: // PrimaryColor
+        return rounded_primary_color;
+    case 1u: // PrimaryFragmentColor
+        return primary_fragment_color;
+    case 2u: // SecondaryFragmentColor
+        return secondary_fragment_color;
+    case 3u: // Texture0
+    case 4u: // Texture1
+    case 5u: // Texture2
+    case 6u: // Texture3
+        return texture_color[source - 3u];
+    case 13u: // PreviousBuffer
+        return combiner_buffer;
+    case 14u: // Constant
+        return const_color[stage];
+    case 15u: // Previous
+        return last_tex_env_out;
+    default:
+        return vec4(0.0);
+    }
+}
+
+vec3 TevColorModifier(uint modifier, uint source, int stage) {
+    vec4 value = TevSource(source, stage);
+    vec3 result;
+    // The lowest bit selects the one-minus variant of the modifiers
+    switch (modifier >> 1) {
+    case 0u:
+        result = value.rgb;
+        break;
+    case 1u:
+        result = value.aaa;
+        break;
+    case 2u:
+        result = value.rrr;
+        break;
+    case 4u:
+        result = value.ggg;
+        break;
+    case 6u:
+        result = value.bbb;
+        break;
+    default:
+        return vec3(0.0);
+    }
+    return (modifier & 1u) != 0u ? vec3(1.0) - result : result;
+}
+
+float TevAlphaModifier(uint modifier, uint source, int stage) {
+    vec4 value = TevSource(source, stage);
+    float result;
+    switch (modifier >> 1) {
+    case 0u:
+        result = value.a;
+        break;
+    case 1u:
+        result = value.r;
+        break;
+    case 2u:
+        result = value.g;
+        break;
+    default:
+        result = value.b;
+        break;
+    }
+    return (modifier & 1u) != 0u ? 1.0 - result : result;
+}
+
+vec3 TevColorCombiner(uint op, vec3 a, vec3 b, vec3 c) {
+    vec3 result;
+    switch (op) {
+    case 0u: // Replace
+        result = a;
+        break;
+    case 1u: // Modulate
+        result = a * b;
+        break;
+    case 2u: // Add
+        result = a + b;
+        break;
+    case 3u: // AddSigned
+        result = a + b - vec3(0.5);
+        break;
+    case 4u: // Lerp
+        result = a * c + b * (vec3(1.0) - c);
+        break;
+    case 5u: // Subtract
+        result = a - b;
+        break;
+    case 6u: // Dot3_RGB
+    case 7u: // Dot3_RGBA
+        result = vec3(dot(a - vec3(0.5), b - vec3(0.5)) * 4.0);
+        break;
+    case 8u: // MultiplyThenAdd
+        result = a * b + c;
+        break;
+    case 9u: // AddThenMultiply
+        result = min(a + b, vec3(1.0)) * c;
+        break;
+    default:
+        result = vec3(0.0);
+        break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float TevAlphaCombiner(uint op, float a, float b, float c) {
+    float result;
+    switch (op) {
+    case 0u: // Replace
+        result = a;
+        break;
+    case 1u: // Modulate
+        result = a * b;
+        break;
+    case 2u: // Add
+        result = a + b;
+        break;
+    case 3u: // AddSigned
+        result = a + b - 0.5;
+        break;
+    case 4u: // Lerp
+        result = a * c + b * (1.0 - c);
+        break;
+    case 5u: // Subtract
+        result = a - b;
+        break;
+    case 8u: // MultiplyThenAdd
+        result = a * b + c;
+        break;
+    case 9u: // AddThenMultiply
+        result = min(a + b, 1.0) * c;
+        break;
+    default:
+        result = 0.0;
+        break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+float TevMultiplier(uint scale) {
+    return scale < 3u ? float(1u << scale) : 1.0;
+}
+
+void RunTevStage(int index) {
+    uint sources = tev_stages[index].x;
+    uint modifiers = tev_stages[index].y;
+    uint color_op = tev_stages[index].z & 0xFu;
+    uint alpha_op = (tev_stages[index].z >> 16) & 0xFu;
+    float color_multiplier = TevMultiplier(tev_stages[index].w & 3u);
+    float alpha_multiplier = TevMultiplier((tev_stages[index].w >> 16) & 3u);
+
+    // Stages that just pass the previous output through don't change it
+    if (color_op == 0u && alpha_op == 0u && (sources & 0xF000Fu) == 0xF000Fu &&
+        (modifiers & 0x700Fu) == 0u && color_multiplier == 1.0 && alpha_multiplier == 1.0) {
+        return;
+    }
+
+    // Round the output of each TEV stage to maintain the PICA's 8 bits of precision
+    vec3 color_output = byteround(TevColorCombiner(color_op,
+        TevColorModifier(modifiers & 0xFu, sources & 0xFu, index),
+        TevColorModifier((modifiers >> 4) & 0xFu, (sources >> 4) & 0xFu, index),
+        TevColorModifier((modifiers >> 8) & 0xFu, (sources >> 8) & 0xFu, index)));
+
+    float alpha_output;
+    if (color_op == 7u) {
+        // result of Dot3_RGBA operation is also placed to the alpha component
+        alpha_output = color_output[0];
+    } else {
+        alpha_output = byteround(TevAlphaCombiner(alpha_op,
+            TevAlphaModifier((modifiers >> 12) & 7u, (sources >> 16) & 0xFu, index),
+            TevAlphaModifier((modifiers >> 16) & 7u, (sources >> 20) & 0xFu, index),
+            TevAlphaModifier((modifiers >> 20) & 7u, (sources >> 24) & 0xFu, index)));
+    }
+
+    last_tex_env_out = vec4(clamp(color_output * color_multiplier, vec3(0.0), vec3(1.0)),
+                            clamp(alpha_output * alpha_multiplier, 0.0, 1.0));
+}
+
+bool AlphaTestFails() {
+    int alpha = int(last_tex_env_out.a * 255.0);
+    switch (alpha_test_func) {
+    case 0: // Never
+        return true;
+    case 2: // Equal
+        return alpha != alphatest_ref;
+    case 3: // NotEqual
+        return alpha == alphatest_ref;
+    case 4: // LessThan
+        return alpha >= alphatest_ref;
+    case 5: // LessThanOrEqual
+        return alpha > alphatest_ref;
+    case 6: // GreaterThan
+        return alpha <= alphatest_ref;
+    case 7: // GreaterThanOrEqual
+        return alpha < alphatest_ref;
+    default:
+        return false;
+    }
+}
+
+void main() {
+    rounded_primary_color = byteround(primary_color);
+    primary_fragment_color = vec4(0.0);
+    secondary_fragment_color = vec4(0.0);
+
+    if (alpha_test_func == 0) {
+        discard;
+    }
+
+    // Include mode keeps only the pixels inside the scissor box
+    if (scissor_test_mode == 3 &&
+        !(gl_FragCoord.x >= scissor_x1 && gl_FragCoord.y >= scissor_y1 &&
+          gl_FragCoord.x < scissor_x2 && gl_FragCoord.y < scissor_y2)) {
+        discard;
+    }
+
+    float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (w_buffering) {
+        depth /= gl_FragCoord.w;
+    }
+
+    texture_color[0] = SampleTexture0();
+    texture_color[1] = textureLod(tex1, texcoord1, getLod(texcoord1 * vec2(textureSize(tex1, 0))));
+    if (texture2_use_coord1) {
+        texture_color[2] =
+            textureLod(tex2, texcoord1, getLod(texcoord1 * vec2(textureSize(tex2, 0))));
+    } else {
+        texture_color[2] =
+            textureLod(tex2, texcoord2, getLod(texcoord2 * vec2(textureSize(tex2, 0))));
+    }
+    texture_color[3] = vec4(0.0);
+
+    if (lighting_enable) {
+        ComputeLighting();
+    }
+
+    combiner_buffer = vec4(0.0);
+    vec4 next_combiner_buffer = tev_combiner_buffer_color;
+    last_tex_env_out = vec4(0.0);
+    for (int i = 0; i < NUM_TEV_STAGES; ++i) {
+        RunTevStage(i);
+        combiner_buffer = next_combiner_buffer;
+        if (i < 4) {
+            if ((tev_combiner_buffer_input & (1u << i)) != 0u) {
+                next_combiner_buffer.rgb = last_tex_env_out.rgb;
+            }
+            if ((tev_combiner_buffer_input & (0x10u << i)) != 0u) {
+                next_combiner_buffer.a = last_tex_env_out.a;
+            }
+        }
+    }
+
+    if (AlphaTestFails()) {
+        discard;
+    }
+
+    if (fog_enable) {
+        float fog_index = fog_flip ? (1.0 - depth) * 128.0 : depth * 128.0;
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        vec2 fog_lut_entry = texelFetch(texture_buffer_lut_rg, int(fog_i) + fog_lut_offset).rg;
+        float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+        last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+    }
+
+    gl_FragDepth = depth;
+    // Round the final fragment color to maintain the PICA's 8 bits of precision
+    color = byteround(last_tex_env_out);
+}
+)";
+
+    return out;
+}
+
 std::string GenerateTrivialVertexShader(bool separable_shader) {
     std::string out = "#version 330 core\n";
     if (separable_shader) {
@@ -226,6 +226,46 @@ std::string GenerateFixedGeometryShader(const PicaFixedGSConfig& config, bool se
  */
 std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader);
 
+/**
+ * The state of a PicaFSConfig, packed into the uniforms of the same names that the fragment
+ * ubershader reads it from
+ */
+struct FragmentUberShaderUniforms {
+    /// Packs the given configuration, which must be compatible with the ubershader
+    static FragmentUberShaderUniforms BuildFromConfig(const PicaFSConfig& config);
+
+    std::array<std::array<u32, 4>, 6> tev_stages; ///< Sources, modifiers, operations and scales
+    u32 tev_combiner_buffer_input;
+    s32 alpha_test_func;
+    s32 scissor_test_mode;
+    s32 texture0_type;
+    s32 texture2_use_coord1;
+    s32 w_buffering;
+    s32 fog_enable;
+    s32 fog_flip;
+    s32 shadow_texture_orthographic;
+
+    s32 lighting_enable;
+    s32 lighting_src_num;
+    std::array<std::array<u32, 2>, 8> lighting_lights; ///< Light number and flags of each slot
+    std::array<u32, 4> lighting_config; ///< Bump mode, bump selector, flags and shadow selector
+    std::array<std::array<s32, 3>, 7> lighting_luts; ///< Enable, absolute input and input
+    std::array<float, 7> lighting_lut_scales;
+};
+
+/// Whether the fragment ubershader can emulate the given configuration
+bool IsFragmentUberShaderCompatible(const PicaFSConfig& config);
+
+/**
+ * Generates the GLSL fragment "ubershader", which emulates every configuration accepted by
+ * IsFragmentUberShaderCompatible by reading it from uniforms (see FragmentUberShaderUniforms)
+ * instead of having it baked in. It stands in for the specialized shader of a configuration while
+ * that one is being compiled.
+ * @param separable_shader generates shader that can be used for separate shader object
+ * @returns String of the shader source code
+ */
+std::string GenerateFragmentUberShader(bool separable_shader);
+
 } // namespace OpenGL
 
 namespace std {
@@ -3,11 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
+#include <future>
+#include <set>
 #include <thread>
 #include <unordered_map>
 #include <boost/functional/hash.hpp>
 #include <boost/variant.hpp>
+#include "common/thread_pool.h"
 #include "core/core.h"
+#include "core/settings.h"
+#include "video_core/renderer_opengl/gl_shader_compiler.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 
@@ -24,28 +30,37 @@ static u64 GetUniqueIdentifier(const Pica::Regs& regs, const ProgramCode& code)
     return hash;
 }
 
-static OGLProgram GeneratePrecompiledProgram(const ShaderDiskCacheDump& dump,
-                                             const std::set<GLenum>& supported_formats) {
+/// Loads a program binary, returning 0 on failure. Safe to call on a shared context.
+static GLuint GeneratePrecompiledProgram(const ShaderDiskCacheDump& dump,
+                                         const std::set<GLenum>& supported_formats) {
 
     if (supported_formats.find(dump.binary_format) == supported_formats.end()) {
         LOG_INFO(Render_OpenGL, "Precompiled cache entry with unsupported format - removing");
-        return {};
+        return 0;
     }
 
-    auto shader = OGLProgram();
-    shader.handle = glCreateProgram();
-    glProgramParameteri(shader.handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
-    glProgramBinary(shader.handle, dump.binary_format, dump.binary.data(),
+    const GLuint handle = glCreateProgram();
+    glProgramParameteri(handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramBinary(handle, dump.binary_format, dump.binary.data(),
                     static_cast<GLsizei>(dump.binary.size()));
 
     GLint link_status{};
-    glGetProgramiv(shader.handle, GL_LINK_STATUS, &link_status);
+    glGetProgramiv(handle, GL_LINK_STATUS, &link_status);
     if (link_status == GL_FALSE) {
         LOG_INFO(Render_OpenGL, "Precompiled cache rejected by the driver - removing");
-        return {};
+        glDeleteProgram(handle);
+        return 0;
     }
 
-    return shader;
+    return handle;
+}
+
+static GLuint GetProgramHandle(GLuint handle) {
+    return handle;
+}
+
+static GLuint GetProgramHandle(const ShaderCompiler::Program& program) {
+    return program.handle;
 }
 
 static std::set<GLenum> GetSupportedFormats() {
@@ -235,6 +250,10 @@ public:
         shaders.emplace(key, std::move(stage));
     }
 
+    bool Has(const KeyConfigType& key) const {
+        return shaders.find(key) != shaders.end();
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage> shaders;
@@ -289,6 +308,19 @@ public:
         shader_map[key] = &cached_shader;
     }
 
+    /**
+     * Maps a key to the cached program built out of the given code, if there's one
+     * @return Whether the program was cached
+     */
+    bool Alias(const KeyConfigType& key, const std::string& decomp) {
+        const auto iter = shader_cache.find(decomp);
+        if (iter == shader_cache.end()) {
+            return false;
+        }
+        shader_map[key] = &iter->second;
+        return true;
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage*> shader_map;
@@ -303,15 +335,203 @@ using FixedGeometryShaders =
 
 using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER>;
 
+/// The fragment ubershader, which draws in place of the fragment shaders still being built
+class FragmentUberShader {
+public:
+    FragmentUberShader() : program(true) {
+        program.Create(GenerateFragmentUberShader(true).c_str(), GL_FRAGMENT_SHADER);
+        const GLuint handle = program.GetHandle();
+        locations.tev_stages = glGetUniformLocation(handle, "tev_stages");
+        locations.tev_combiner_buffer_input =
+            glGetUniformLocation(handle, "tev_combiner_buffer_input");
+        locations.alpha_test_func = glGetUniformLocation(handle, "alpha_test_func");
+        locations.scissor_test_mode = glGetUniformLocation(handle, "scissor_test_mode");
+        locations.texture0_type = glGetUniformLocation(handle, "texture0_type");
+        locations.texture2_use_coord1 = glGetUniformLocation(handle, "texture2_use_coord1");
+        locations.w_buffering = glGetUniformLocation(handle, "w_buffering");
+        locations.fog_enable = glGetUniformLocation(handle, "fog_enable");
+        locations.fog_flip = glGetUniformLocation(handle, "fog_flip");
+        locations.shadow_texture_orthographic =
+            glGetUniformLocation(handle, "shadow_texture_orthographic");
+        locations.lighting_enable = glGetUniformLocation(handle, "lighting_enable");
+        locations.lighting_src_num = glGetUniformLocation(handle, "lighting_src_num");
+        locations.lighting_lights = glGetUniformLocation(handle, "lighting_lights");
+        locations.lighting_config = glGetUniformLocation(handle, "lighting_config");
+        locations.lighting_luts = glGetUniformLocation(handle, "lighting_luts");
+        locations.lighting_lut_scales = glGetUniformLocation(handle, "lighting_lut_scales");
+    }
+
+    GLuint GetHandle() const {
+        return program.GetHandle();
+    }
+
+    /// Makes the ubershader emulate the given configuration
+    void Configure(const PicaFSConfig& config) {
+        if (configured && *configured == config) {
+            return;
+        }
+        configured = config;
+
+        const auto uniforms = FragmentUberShaderUniforms::BuildFromConfig(config);
+        const GLuint handle = program.GetHandle();
+        glProgramUniform4uiv(handle, locations.tev_stages,
+                             static_cast<GLsizei>(uniforms.tev_stages.size()),
+                             uniforms.tev_stages[0].data());
+        glProgramUniform1ui(handle, locations.tev_combiner_buffer_input,
+                            uniforms.tev_combiner_buffer_input);
+        glProgramUniform1i(handle, locations.alpha_test_func, uniforms.alpha_test_func);
+        glProgramUniform1i(handle, locations.scissor_test_mode, uniforms.scissor_test_mode);
+        glProgramUniform1i(handle, locations.texture0_type, uniforms.texture0_type);
+        glProgramUniform1i(handle, locations.texture2_use_coord1, uniforms.texture2_use_coord1);
+        glProgramUniform1i(handle, locations.w_buffering, uniforms.w_buffering);
+        glProgramUniform1i(handle, locations.fog_enable, uniforms.fog_enable);
+        glProgramUniform1i(handle, locations.fog_flip, uniforms.fog_flip);
+        glProgramUniform1i(handle, locations.shadow_texture_orthographic,
+                           uniforms.shadow_texture_orthographic);
+        glProgramUniform1i(handle, locations.lighting_enable, uniforms.lighting_enable);
+        glProgramUniform1i(handle, locations.lighting_src_num, uniforms.lighting_src_num);
+        glProgramUniform2uiv(handle, locations.lighting_lights,
+                             static_cast<GLsizei>(uniforms.lighting_lights.size()),
+                             uniforms.lighting_lights[0].data());
+        glProgramUniform4uiv(handle, locations.lighting_config, 1,
+                             uniforms.lighting_config.data());
+        glProgramUniform3iv(handle, locations.lighting_luts,
+                            static_cast<GLsizei>(uniforms.lighting_luts.size()),
+                            uniforms.lighting_luts[0].data());
+        glProgramUniform1fv(handle, locations.lighting_lut_scales,
+                            static_cast<GLsizei>(uniforms.lighting_lut_scales.size()),
+                            uniforms.lighting_lut_scales.data());
+    }
+
+private:
+    OGLShaderStage program;
+    std::optional<PicaFSConfig> configured;
+
+    struct {
+        GLint tev_stages;
+        GLint tev_combiner_buffer_input;
+        GLint alpha_test_func;
+        GLint scissor_test_mode;
+        GLint texture0_type;
+        GLint texture2_use_coord1;
+        GLint w_buffering;
+        GLint fog_enable;
+        GLint fog_flip;
+        GLint shadow_texture_orthographic;
+        GLint lighting_enable;
+        GLint lighting_src_num;
+        GLint lighting_lights;
+        GLint lighting_config;
+        GLint lighting_luts;
+        GLint lighting_lut_scales;
+    } locations;
+};
+
+/// Build times of the shader programs created during the session, summarized on shutdown
+struct ShaderBuildStats {
+    u64 num_programs = 0;
+    u64 num_background_programs = 0;
+    u64 total_time_us = 0;
+    u64 max_time_us = 0;
+    u64 uber_shader_draws = 0;
+
+    void Add(ProgramType type, u64 time_us, bool background) {
+        static constexpr std::array<const char*, 3> type_names{"vertex", "geometry", "fragment"};
+        LOG_DEBUG(Render_OpenGL, "Built {} shader program in {} us{}",
+                  type_names[static_cast<std::size_t>(type)], time_us,
+                  background ? " in the background" : "");
+        ++num_programs;
+        if (background) {
+            ++num_background_programs;
+        }
+        total_time_us += time_us;
+        max_time_us = std::max(max_time_us, time_us);
+    }
+
+    void AddSince(ProgramType type, std::chrono::steady_clock::time_point start) {
+        const auto time = std::chrono::steady_clock::now() - start;
+        Add(type,
+            static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(time).count()),
+            false);
+    }
+
+    void Log() const {
+        if (num_programs == 0) {
+            return;
+        }
+        LOG_INFO(Render_OpenGL,
+                 "Built {} shader programs ({} in the background) in {} ms, {} us on average, "
+                 "{} us at most; {} draws used the ubershader",
+                 num_programs, num_background_programs, total_time_us / 1000,
+                 total_time_us / num_programs, max_time_us, uber_shader_draws);
+    }
+};
+
 class ShaderProgramManager::Impl {
 public:
-    explicit Impl(bool separable, bool is_amd)
+    explicit Impl(Frontend::EmuWindow& emu_window, bool separable, bool is_amd)
         : is_amd(is_amd), separable(separable), programmable_vertex_shaders(separable),
           trivial_vertex_shader(separable), fixed_geometry_shaders(separable),
           fragment_shaders(separable), disk_cache(separable) {
         if (separable) {
             pipeline.Create();
+
+            // The programs built in the background are linked on their own, which requires
+            // separable programs. The contexts of the workers can only be created now, so they're
+            // also created for loading the disk cache.
+            if (Settings::values.async_shader_compilation ||
+                Settings::values.use_disk_shader_cache) {
+                const std::size_t num_workers =
+                    std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+                compiler = ShaderCompiler::Create(emu_window, num_workers);
+                if (!compiler) {
+                    LOG_WARNING(Render_OpenGL, "Shared contexts are unsupported, shaders will be "
+                                               "compiled synchronously");
+                } else if (Settings::values.async_shader_compilation) {
+                    uber_shader.emplace();
+                }
+            }
+        }
+    }
+
+    ~Impl() {
+        // Let the workers finish, then delete the programs that were never used
+        compiler.reset();
+        for (auto& [config, program] : pending_fragment_shaders) {
+            OGLProgram unused;
+            unused.handle = program.get().handle;
+        }
+        stats.Log();
+    }
+
+    /**
+     * Moves a fragment shader built in the background to the cache, if it's done.
+     * @return Whether the shader is in the cache now
+     */
+    bool InjectBuiltFragmentShader(const PicaFSConfig& config) {
+        const auto iter = pending_fragment_shaders.find(config);
+        auto& future = iter->second;
+        if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        const ShaderCompiler::Program built = future.get();
+        OGLProgram program;
+        program.handle = built.handle;
+        // The decompiled code is only needed to deduplicate the vertex shaders
+        fragment_shaders.Inject(config, {}, std::move(program));
+        pending_fragment_shaders.erase(iter);
+        stats.Add(ProgramType::FS, built.build_time_us, true);
+        return true;
+    }
+
+    /// Runs some GL work on a worker of the compiler, or on the calling thread without one
+    template <typename F>
+    auto RunGLTask(F&& f) -> std::future<decltype(f())> {
+        if (compiler) {
+            return compiler->Submit(std::forward<F>(f));
         }
+        return std::async(std::launch::deferred, std::forward<F>(f));
     }
 
     struct ShaderTuple {
@@ -349,26 +569,37 @@ public:
 
     FragmentShaders fragment_shaders;
 
+    std::unique_ptr<ShaderCompiler> compiler;
+    std::optional<FragmentUberShader> uber_shader;
+    std::unordered_map<PicaFSConfig, std::future<ShaderCompiler::Program>>
+        pending_fragment_shaders;
+    /// Configuration drawn with the ubershader until its own shader is built
+    std::optional<PicaFSConfig> uber_shader_config;
+    ShaderBuildStats stats;
+
     bool separable;
     std::unordered_map<ShaderTuple, OGLProgram, ShaderTuple::Hash> program_cache;
     OGLPipeline pipeline;
     ShaderDiskCache disk_cache;
 };
 
-ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
-    : impl(std::make_unique<Impl>(separable, is_amd)) {}
+ShaderProgramManager::ShaderProgramManager(Frontend::EmuWindow& emu_window, bool separable,
+                                           bool is_amd)
+    : impl(std::make_unique<Impl>(emu_window, separable, is_amd)) {}
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
 bool ShaderProgramManager::UseProgrammableVertexShader(const Pica::Regs& regs,
                                                        Pica::Shader::ShaderSetup& setup) {
     PicaVSConfig config{regs.vs, setup};
+    const auto start = std::chrono::steady_clock::now();
     auto [handle, result] = impl->programmable_vertex_shaders.Get(config, setup);
     if (handle == 0)
         return false;
     impl->current.vs = handle;
     // Save VS to the disk cache if its a new shader
     if (result) {
+        impl->stats.AddSince(ProgramType::VS, start);
         auto& disk_cache = impl->disk_cache;
         ProgramCode program_code{setup.program_code.begin(), setup.program_code.end()};
         program_code.insert(program_code.end(), setup.swizzle_data.begin(),
@@ -386,8 +617,12 @@ void ShaderProgramManager::UseTrivialVertexShader() {
 
 void ShaderProgramManager::UseFixedGeometryShader(const Pica::Regs& regs) {
     PicaFixedGSConfig gs_config(regs);
-    auto [handle, _] = impl->fixed_geometry_shaders.Get(gs_config);
+    const auto start = std::chrono::steady_clock::now();
+    auto [handle, result] = impl->fixed_geometry_shaders.Get(gs_config);
     impl->current.gs = handle;
+    if (result) {
+        impl->stats.AddSince(ProgramType::GS, start);
+    }
 }
 
 void ShaderProgramManager::UseTrivialGeometryShader() {
@@ -396,19 +631,54 @@ void ShaderProgramManager::UseTrivialGeometryShader() {
 
 void ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
     PicaFSConfig config = PicaFSConfig::BuildFromRegs(regs);
-    auto [handle, result] = impl->fragment_shaders.Get(config);
-    impl->current.fs = handle;
-    // Save FS to the disk cache if its a new shader
-    if (result) {
+    impl->uber_shader_config.reset();
+
+    const auto save_to_disk_cache = [this, &regs](const ShaderDecompiler::ProgramResult& code) {
         auto& disk_cache = impl->disk_cache;
         u64 unique_identifier = GetUniqueIdentifier(regs, {});
         ShaderDiskCacheRaw raw{unique_identifier, ProgramType::FS, regs, {}};
         disk_cache.SaveRaw(raw);
-        disk_cache.SaveDecompiled(unique_identifier, *result);
+        disk_cache.SaveDecompiled(unique_identifier, code);
+    };
+
+    // Build new shaders in the background and draw with the ubershader in the meantime
+    if (impl->uber_shader && !impl->fragment_shaders.Has(config) &&
+        IsFragmentUberShaderCompatible(config)) {
+        auto [iter, new_shader] = impl->pending_fragment_shaders.try_emplace(config);
+        if (new_shader) {
+            std::string code = GenerateFragmentShader(config, true);
+            save_to_disk_cache(code);
+            iter->second = impl->compiler->BuildProgram(std::move(code), GL_FRAGMENT_SHADER);
+        }
+        if (!impl->InjectBuiltFragmentShader(config)) {
+            impl->uber_shader->Configure(config);
+            impl->current.fs = impl->uber_shader->GetHandle();
+            impl->uber_shader_config = config;
+            return;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto [handle, result] = impl->fragment_shaders.Get(config);
+    impl->current.fs = handle;
+    // Save FS to the disk cache if its a new shader
+    if (result) {
+        impl->stats.AddSince(ProgramType::FS, start);
+        save_to_disk_cache(*result);
     }
 }
 
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
+    // Switch to the shader being built as soon as it's done
+    if (impl->uber_shader_config) {
+        if (impl->InjectBuiltFragmentShader(*impl->uber_shader_config)) {
+            impl->current.fs = std::get<0>(impl->fragment_shaders.Get(*impl->uber_shader_config));
+            impl->uber_shader_config.reset();
+        } else {
+            ++impl->stats.uber_shader_draws;
+        }
+    }
+
     if (impl->separable) {
         if (impl->is_amd) {
             // Without this reseting, AMD sometimes freezes when one stage is changed but not
@@ -457,153 +727,231 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
         return;
     }
 
-    std::set<GLenum> supported_formats = GetSupportedFormats();
+    const auto start = std::chrono::steady_clock::now();
+    const std::set<GLenum> supported_formats = GetSupportedFormats();
+
+    // Hashing and decompiling run on a thread pool, while loading, compiling and linking programs
+    // run on the workers of the shader compiler. Only this thread touches the shader caches, in
+    // the order of the entries. Declared after everything its tasks refer to, so that they're done
+    // before any of it is destroyed.
+    Common::ThreadPool pool{0, "ShaderDecompiler"};
+
+    // Frees the programs the workers were asked for but won't be used
+    const auto discard_programs = [](auto& futures, std::size_t begin) {
+        for (std::size_t i = begin; i < futures.size(); ++i) {
+            auto& future = futures[i];
+            if (future.valid() &&
+                future.wait_for(std::chrono::seconds(0)) != std::future_status::deferred) {
+                glDeleteProgram(GetProgramHandle(future.get()));
+            }
+        }
+    };
 
     // Track if precompiled cache was altered during loading to know if we have to serialize the
     // virtual precompiled cache file back to the hard drive
     bool precompiled_cache_altered = false;
 
-    std::mutex mutex;
-    std::size_t built_shaders = 0; // It doesn't have be atomic since it's used behind a mutex
-    std::atomic_bool compilation_failed = false;
     if (callback) {
         callback(VideoCore::LoadCallbackStage::Decompile, 0, raws.size());
     }
-    std::vector<std::size_t> load_raws_index;
-    // Loads both decompiled and precompiled shaders from the cache. If either one is missing for
-    const auto LoadPrecompiledWorker =
-        [&](std::size_t begin, std::size_t end, const std::vector<ShaderDiskCacheRaw>& raws,
-            const ShaderDecompiledMap& decompiled, const ShaderDumpsMap& dumps) {
-            for (std::size_t i = 0; i < end; ++i) {
-                if (stop_loading || compilation_failed) {
-                    return;
-                }
-                const auto& raw{raws[i]};
-                const u64 unique_identifier{raw.GetUniqueIdentifier()};
-
-                const u64 calculated_hash =
-                    GetUniqueIdentifier(raw.GetRawShaderConfig(), raw.GetProgramCode());
-                if (unique_identifier != calculated_hash) {
-                    LOG_ERROR(Render_OpenGL,
-                              "Invalid hash in entry={:016x} (obtained hash={:016x}) - removing "
-                              "shader cache",
-                              raw.GetUniqueIdentifier(), calculated_hash);
-                    disk_cache.InvalidateAll();
-                    return;
-                }
 
-                const auto dump{dumps.find(unique_identifier)};
-                const auto decomp{decompiled.find(unique_identifier)};
-                OGLProgram shader;
-
-                if (dump != dumps.end() && decomp != decompiled.end()) {
-                    // If the shader is dumped, attempt to load it
-                    shader = GeneratePrecompiledProgram(dump->second, supported_formats);
-                    if (shader.handle == 0) {
-                        // If any shader failed, stop trying to compile, delete the cache, and start
-                        // loading from raws
-                        compilation_failed = true;
-                        return;
-                    }
-                    // we have both the binary shader and the decompiled, so inject it into the
-                    // cache
-                    if (raw.GetProgramType() == ProgramType::VS) {
-                        auto [conf, setup] = BuildVSConfigFromRaw(raw);
-                        std::scoped_lock lock(mutex);
-                        impl->programmable_vertex_shaders.Inject(conf, decomp->second.code,
-                                                                 std::move(shader));
-                    } else if (raw.GetProgramType() == ProgramType::FS) {
-                        PicaFSConfig conf = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
-                        std::scoped_lock lock(mutex);
-                        impl->fragment_shaders.Inject(conf, decomp->second.code, std::move(shader));
-                    } else {
-                        // Unsupported shader type got stored somehow so nuke the cache
-
-                        LOG_CRITICAL(Frontend, "failed to load raw programtype {}",
-                                     static_cast<u32>(raw.GetProgramType()));
-                        compilation_failed = true;
-                        return;
-                    }
-                } else {
-                    // Since precompiled didn't have the dump, we'll load them in the next phase
-                    std::scoped_lock lock(mutex);
-                    load_raws_index.push_back(i);
-                }
-                if (callback) {
-                    callback(VideoCore::LoadCallbackStage::Decompile, i, raws.size());
-                }
+    // Start loading the entries that have both a precompiled program and decompiled code, and
+    // check the hashes of all of them meanwhile
+    std::vector<std::future<GLuint>> precompiled(raws.size());
+    std::vector<std::future<bool>> hash_checks(raws.size());
+    for (std::size_t i = 0; i < raws.size(); ++i) {
+        const auto& raw = raws[i];
+        hash_checks[i] = pool.Submit([&raw] {
+            return raw.GetUniqueIdentifier() ==
+                   GetUniqueIdentifier(raw.GetRawShaderConfig(), raw.GetProgramCode());
+        });
+
+        const u64 unique_identifier = raw.GetUniqueIdentifier();
+        const auto dump = dumps.find(unique_identifier);
+        if (dump != dumps.end() && decompiled.find(unique_identifier) != decompiled.end()) {
+            precompiled[i] = impl->RunGLTask([&dump = dump->second, &supported_formats] {
+                const GLuint handle = GeneratePrecompiledProgram(dump, supported_formats);
+                glFinish();
+                return handle;
+            });
+        }
+    }
+
+    std::vector<std::size_t> raws_to_build;
+    std::vector<std::pair<u64, GLuint>> loaded_programs;
+    bool precompiled_rejected = false;
+    for (std::size_t i = 0; i < raws.size(); ++i) {
+        const auto& raw = raws[i];
+        const u64 unique_identifier = raw.GetUniqueIdentifier();
+        if (stop_loading || !hash_checks[i].get()) {
+            if (!stop_loading) {
+                LOG_ERROR(Render_OpenGL,
+                          "Invalid hash in entry={:016x} - removing shader cache",
+                          unique_identifier);
+                disk_cache.InvalidateAll();
             }
-        };
+            discard_programs(precompiled, i);
+            return;
+        }
 
-    LoadPrecompiledWorker(0, raws.size(), raws, decompiled, dumps);
+        if (!precompiled[i].valid()) {
+            // Since precompiled didn't have the dump, we'll load them in the next phase
+            raws_to_build.push_back(i);
+            continue;
+        }
 
-    if (compilation_failed) {
-        // Invalidate the precompiled cache if a shader dumped shader was rejected
+        OGLProgram shader;
+        shader.handle = precompiled[i].get();
+        if (shader.handle == 0) {
+            // If any shader failed, drop the precompiled cache, and build the rest from the raws
+            precompiled_rejected = true;
+        }
+        if (precompiled_rejected) {
+            raws_to_build.push_back(i);
+            continue;
+        }
+
+        // we have both the binary shader and the decompiled, so inject it into the cache
+        const auto& code = decompiled.at(unique_identifier).code;
+        const GLuint handle = shader.handle;
+        if (raw.GetProgramType() == ProgramType::VS) {
+            auto [conf, setup] = BuildVSConfigFromRaw(raw);
+            impl->programmable_vertex_shaders.Inject(conf, code, std::move(shader));
+        } else if (raw.GetProgramType() == ProgramType::FS) {
+            PicaFSConfig conf = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
+            impl->fragment_shaders.Inject(conf, code, std::move(shader));
+        } else {
+            // Unsupported shader type got stored somehow so nuke the cache
+            LOG_CRITICAL(Frontend, "failed to load raw programtype {}",
+                         static_cast<u32>(raw.GetProgramType()));
+            precompiled_rejected = true;
+            raws_to_build.push_back(i);
+            continue;
+        }
+        loaded_programs.emplace_back(unique_identifier, handle);
+
+        if (callback) {
+            callback(VideoCore::LoadCallbackStage::Decompile, i, raws.size());
+        }
+    }
+
+    if (precompiled_rejected) {
+        // Invalidate the precompiled cache if a shader dumped shader was rejected, keeping the
+        // programs that were loaded fine
         disk_cache.InvalidatePrecompiled();
+        for (const auto& [unique_identifier, handle] : loaded_programs) {
+            disk_cache.SaveDecompiled(unique_identifier, decompiled.at(unique_identifier).code);
+            disk_cache.SaveDump(unique_identifier, handle);
+        }
         dumps.clear();
         precompiled_cache_altered = true;
     }
 
     if (callback) {
-        callback(VideoCore::LoadCallbackStage::Build, 0, raws.size());
+        callback(VideoCore::LoadCallbackStage::Build, 0, raws_to_build.size());
     }
 
-    compilation_failed = false;
-
-    const auto LoadTransferable = [&](std::size_t begin, std::size_t end,
-                                      const std::vector<ShaderDiskCacheRaw>& raws) {
-        for (std::size_t i = 0; i < end; ++i) {
-            if (stop_loading || compilation_failed) {
-                return;
-            }
-            const auto& raw{raws[i]};
-            const u64 unique_identifier{raw.GetUniqueIdentifier()};
-
-            GLuint handle{0};
-            std::optional<ShaderDecompiler::ProgramResult> result;
-            // Otherwise decompile and build the shader at boot and save the result to the
-            // precompiled file
+    // Decompile the remaining entries
+    std::vector<std::future<std::optional<std::string>>> codes(raws_to_build.size());
+    for (std::size_t i = 0; i < raws_to_build.size(); ++i) {
+        codes[i] = pool.Submit([&raw = raws[raws_to_build[i]]]() -> std::optional<std::string> {
             if (raw.GetProgramType() == ProgramType::VS) {
-                // TODO: This isn't the ideal place to lock, since we really only want to
-                // lock access to the shared cache
                 auto [conf, setup] = BuildVSConfigFromRaw(raw);
-                std::scoped_lock lock(mutex);
-                auto [h, r] = impl->programmable_vertex_shaders.Get(conf, setup);
-                handle = h;
-                result = r;
-            } else if (raw.GetProgramType() == ProgramType::FS) {
-                PicaFSConfig conf = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
-                std::scoped_lock lock(mutex);
-                auto [h, r] = impl->fragment_shaders.Get(conf);
-                handle = h;
-                result = r;
-            } else {
-                // Unsupported shader type got stored somehow so nuke the cache
-                LOG_ERROR(Frontend, "failed to load raw programtype {}",
-                          static_cast<u32>(raw.GetProgramType()));
-                compilation_failed = true;
-                return;
+                return GenerateVertexShader(setup, conf, true);
             }
-            if (handle == 0) {
-                LOG_ERROR(Frontend, "compilation from raw failed {:x} {:x}",
-                          raw.GetProgramCode().at(0), raw.GetProgramCode().at(1));
+            if (raw.GetProgramType() == ProgramType::FS) {
+                const PicaFSConfig conf = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
+                return GenerateFragmentShader(conf, true);
+            }
+            return std::nullopt;
+        });
+    }
+
+    // Build them, skipping the ones already cached, or built for another entry, with the same
+    // vertex shader code or fragment shader configuration
+    struct BuildJob {
+        std::string code;
+        std::size_t first_job; ///< Job building the same program, the job itself if it builds it
+    };
+    std::vector<BuildJob> jobs(raws_to_build.size());
+    std::vector<std::future<ShaderCompiler::Program>> programs(raws_to_build.size());
+    std::unordered_map<std::string, std::size_t> vs_jobs;
+    std::unordered_map<PicaFSConfig, std::size_t> fs_jobs;
+    bool compilation_failed = false;
+    for (std::size_t i = 0; i < raws_to_build.size(); ++i) {
+        const auto& raw = raws[raws_to_build[i]];
+        auto code = codes[i].get();
+        if (stop_loading || !code) {
+            if (!stop_loading) {
+                LOG_ERROR(Frontend, "failed to decompile raw programtype {} {:x} {:x}",
+                          static_cast<u32>(raw.GetProgramType()), raw.GetProgramCode().at(0),
+                          raw.GetProgramCode().at(1));
                 compilation_failed = true;
-                return;
             }
-            // If this is a new shader, add it the precompiled cache
-            if (result) {
-                disk_cache.SaveDecompiled(unique_identifier, *result);
-                disk_cache.SaveDump(unique_identifier, handle);
-                precompiled_cache_altered = true;
+            discard_programs(programs, 0);
+            programs.clear();
+            break;
+        }
+
+        auto& job = jobs[i];
+        job.code = std::move(*code);
+        job.first_job = i;
+        GLenum type = GL_VERTEX_SHADER;
+        if (raw.GetProgramType() == ProgramType::VS) {
+            auto [conf, setup] = BuildVSConfigFromRaw(raw);
+            if (impl->programmable_vertex_shaders.Alias(conf, job.code)) {
+                continue;
             }
+            job.first_job = vs_jobs.try_emplace(job.code, i).first->second;
+        } else {
+            const PicaFSConfig conf = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
+            if (impl->fragment_shaders.Has(conf)) {
+                continue;
+            }
+            job.first_job = fs_jobs.try_emplace(conf, i).first->second;
+            type = GL_FRAGMENT_SHADER;
+        }
+        if (job.first_job == i) {
+            programs[i] = impl->RunGLTask(
+                [&code = job.code, type] { return ShaderCompiler::Build(code, type); });
+        }
+    }
+
+    // Add the built programs to the caches, and the precompiled cache
+    std::size_t num_built = 0;
+    for (std::size_t i = 0; i < programs.size(); ++i) {
+        const auto& raw = raws[raws_to_build[i]];
+        const auto& job = jobs[i];
+        if (stop_loading) {
+            discard_programs(programs, i);
+            break;
+        }
 
-            if (callback) {
-                callback(VideoCore::LoadCallbackStage::Build, i, raws.size());
+        if (programs[i].valid()) {
+            OGLProgram program;
+            program.handle = programs[i].get().handle;
+            const GLuint handle = program.handle;
+            if (raw.GetProgramType() == ProgramType::VS) {
+                auto [conf, setup] = BuildVSConfigFromRaw(raw);
+                impl->programmable_vertex_shaders.Inject(conf, job.code, std::move(program));
+            } else {
+                const PicaFSConfig conf = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
+                impl->fragment_shaders.Inject(conf, job.code, std::move(program));
             }
+            // If this is a new shader, add it the precompiled cache
+            disk_cache.SaveDecompiled(raw.GetUniqueIdentifier(), job.code);
+            disk_cache.SaveDump(raw.GetUniqueIdentifier(), handle);
+            precompiled_cache_altered = true;
+            ++num_built;
+        } else if (job.first_job != i && raw.GetProgramType() == ProgramType::VS) {
+            auto [conf, setup] = BuildVSConfigFromRaw(raw);
+            impl->programmable_vertex_shaders.Alias(conf, job.code);
         }
-    };
 
-    LoadTransferable(0, raws.size(), raws);
+        if (callback) {
+            callback(VideoCore::LoadCallbackStage::Build, i, raws_to_build.size());
+        }
+    }
 
     if (compilation_failed) {
         disk_cache.InvalidateAll();
@@ -612,6 +960,14 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
     if (precompiled_cache_altered) {
         disk_cache.SaveVirtualPrecompiledFile();
     }
+
+    const auto time = std::chrono::steady_clock::now() - start;
+    LOG_INFO(Render_OpenGL,
+             "Loaded {} precompiled and built {} shader programs from the disk cache in {} ms "
+             "using {} threads",
+             loaded_programs.size(), num_built,
+             std::chrono::duration_cast<std::chrono::milliseconds>(time).count(),
+             impl->compiler ? impl->compiler->NumWorkers() : 1);
 }
 
 } // namespace OpenGL
@@ -17,6 +17,10 @@ namespace Core {
 class System;
 }
 
+namespace Frontend {
+class EmuWindow;
+}
+
 namespace OpenGL {
 
 class ShaderDiskCacheOpenGL;
@@ -101,7 +105,7 @@ static_assert(sizeof(VSUniformData) < 16384,
 /// A class that manage different shader stages and configures them with given config data.
 class ShaderProgramManager {
 public:
-    ShaderProgramManager(bool separable, bool is_amd);
+    ShaderProgramManager(Frontend::EmuWindow& emu_window, bool separable, bool is_amd);
     ~ShaderProgramManager();
 
     void LoadDiskCache(const std::atomic_bool& stop_loading,
@@ -54,7 +54,7 @@ public:
     void ShutDown() override;
 
     /// Finalizes rendering the guest frame
-    void SwapBuffers() override;
+    void SwapBuffers(const ScreenConfig& screens) override;
 
     /// Draws the latest frame from texture mailbox to the currently bound draw framebuffer in this
     /// context
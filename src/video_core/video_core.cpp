@@ -4,7 +4,9 @@
 
 #include <memory>
 #include "common/logging/log.h"
+#include "core/memory.h"
 #include "core/settings.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
@@ -16,6 +18,7 @@
 namespace VideoCore {
 
 std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+std::unique_ptr<GPUThread> g_gpu_thread;
 
 std::atomic<bool> g_hw_renderer_enabled;
 std::atomic<bool> g_shader_jit_enabled;
@@ -45,6 +48,9 @@ ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory)
         LOG_ERROR(Render, "initialization failed !");
     } else {
         LOG_DEBUG(Render, "initialized OK");
+        if (Settings::values.use_asynchronous_gpu_emulation) {
+            g_gpu_thread = std::make_unique<GPUThread>(emu_window);
+        }
     }
 
     return result;
@@ -52,6 +58,16 @@ ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory)
 
 /// Shutdown the video core
 void Shutdown() {
+    if (g_gpu_thread) {
+        // Once it started, the GPU thread owns the context that the renderer's objects belong to
+        if (g_gpu_thread->IsStarted()) {
+            g_gpu_thread->Run([] { g_renderer.reset(); });
+        }
+        g_gpu_thread.reset();
+        // Unmark the pages that the rasterizer cache released while being destroyed
+        g_memory->ApplyDeferredRasterizerMarks();
+    }
+
     Pica::Shutdown();
 
     g_renderer.reset();
@@ -59,6 +75,23 @@ void Shutdown() {
     LOG_DEBUG(Render, "shutdown OK");
 }
 
+void RunSync(const std::function<void()>& work) {
+    if (g_gpu_thread) {
+        g_gpu_thread->Run(work);
+        // The caller may access the memory that the work flushed right after
+        if (!g_gpu_thread->IsGPUThread()) {
+            g_memory->ApplyDeferredRasterizerMarks();
+        }
+    } else {
+        work();
+    }
+}
+
+void LoadDiskResources(const std::atomic_bool& stop_loading,
+                       const DiskResourceLoadCallback& callback) {
+    RunSync([&] { g_renderer->Rasterizer()->LoadDiskResources(stop_loading, callback); });
+}
+
 void RequestScreenshot(void* data, std::function<void()> callback,
                        const Layout::FramebufferLayout& layout) {
     if (g_renderer_screenshot_requested) {
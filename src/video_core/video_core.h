@@ -5,8 +5,10 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include "core/frontend/emu_window.h"
+#include "video_core/rasterizer_interface.h"
 
 namespace Frontend {
 class EmuWindow;
@@ -23,7 +25,11 @@ class MemorySystem;
 
 namespace VideoCore {
 
+class GPUThread;
+
 extern std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+/// Thread running the GPU work, only when asynchronous GPU emulation is enabled
+extern std::unique_ptr<GPUThread> g_gpu_thread;
 
 // TODO: Wrap these in a user settings struct along with any other graphics settings (often set from
 // qt ui)
@@ -55,6 +61,17 @@ ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory)
 /// Shutdown the video core
 void Shutdown();
 
+/**
+ * Runs some work that uses the renderer, on the GPU thread when it's enabled, once the GPU work
+ * submitted before it is done. Returns once the work is done and the pages it flushed or cached
+ * are marked.
+ */
+void RunSync(const std::function<void()>& work);
+
+/// Loads the disk resources of the rasterizer, on the GPU thread when it's enabled
+void LoadDiskResources(const std::atomic_bool& stop_loading,
+                       const DiskResourceLoadCallback& callback);
+
 /// Request a screenshot of the next frame
 void RequestScreenshot(void* data, std::function<void()> callback,
                        const Layout::FramebufferLayout& layout);